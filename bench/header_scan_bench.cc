@@ -0,0 +1,120 @@
+// Microbenchmark for request header scanning.
+//
+// Compares the original framing/parsing path (find the blank line, then
+// copy the request out line by line) with RequestParser + Request using
+// each header_scan implementation the CPU supports. Inputs are realistic
+// browser request headers padded to 600-2000 bytes.
+//
+//   ./bin/header_scan_bench [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "header_scan.h"
+#include "request.h"
+#include "request_parser.h"
+
+namespace {
+
+std::string MakeRequest(std::size_t target_size) {
+    std::string req =
+        "GET /static/images/products/2024/thumbnail-large.webp?v=20240512 HTTP/1.1\r\n"
+        "Host: www.example.com\r\n"
+        "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 "
+        "(KHTML, like Gecko) Chrome/124.0.0.0 Safari/537.36\r\n"
+        "Accept: image/avif,image/webp,image/apng,image/svg+xml,image/*,*/*;q=0.8\r\n"
+        "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+        "Accept-Language: en-US,en;q=0.9,de;q=0.8\r\n"
+        "Referer: https://www.example.com/catalog/category/shoes?page=3&sort=price\r\n"
+        "Sec-Fetch-Dest: image\r\n"
+        "Sec-Fetch-Mode: no-cors\r\n"
+        "Sec-Fetch-Site: same-origin\r\n"
+        "Connection: keep-alive\r\n";
+    // Cookies are what usually pushes real headers past a kilobyte
+    std::string cookie = "Cookie: ";
+    std::size_t n = 0;
+    while (req.size() + cookie.size() + 4 < target_size) {
+        cookie += "tracking_id_" + std::to_string(n++) + "=a8f3c2e1b9d74f6a; ";
+    }
+    req += cookie.substr(0, target_size > req.size() + 4 ? target_size - req.size() - 4 : 0);
+    req += "\r\n\r\n";
+    return req;
+}
+
+// The pre-RequestParser path: blank line search plus substr-per-line parse
+std::size_t LegacyParse(const std::string& text) {
+    std::size_t header_end = text.find("\r\n\r\n");
+    if (header_end == std::string::npos) return 0;
+
+    std::map<std::string, std::string> headers;
+    std::string req = text;
+    std::string line;
+    auto get_line = [&]() {
+        auto eol = req.find("\n");
+        line = req.substr(0, eol);
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        req = req.substr(eol + 1);
+    };
+    get_line();
+    while (req != "\r\n" && req != "\n" && !req.empty()) {
+        get_line();
+        if (line.empty()) break;
+        auto split = line.find(":");
+        if (split == std::string::npos) return 0;
+        headers[line.substr(0, split)] = line.substr(std::min(split + 2, line.size()));
+    }
+    return headers.size();
+}
+
+std::size_t ParserParse(const std::string& text) {
+    RequestParser parser;
+    if (parser.Parse(text) != RequestParser::COMPLETE) return 0;
+    Request request(std::string_view(text), parser.layout());
+    return request.get_header("Host").size();
+}
+
+template <typename Fn>
+double NanosPerRequest(const std::vector<std::string>& inputs, int iterations, Fn fn) {
+    std::size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        for (const std::string& input : inputs) sink += fn(input);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    if (sink == 0) std::printf("(unexpected empty result)\n");
+    return std::chrono::duration<double, std::nano>(elapsed).count() /
+           (static_cast<double>(iterations) * inputs.size());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 20000;
+    const std::size_t sizes[] = {600, 1000, 1500, 2000};
+
+    std::printf("%-8s %12s", "bytes", "legacy");
+    std::vector<header_scan::Impl> impls;
+    for (header_scan::Impl impl : {header_scan::IMPL_SCALAR, header_scan::IMPL_SSE2,
+                                   header_scan::IMPL_AVX2}) {
+        if (!header_scan::IsSupported(impl)) continue;
+        impls.push_back(impl);
+        std::printf(" %12s", header_scan::ImplName(impl));
+    }
+    std::printf("   (ns/request)\n");
+
+    for (std::size_t size : sizes) {
+        std::vector<std::string> inputs = {MakeRequest(size)};
+        std::printf("%-8zu %12.1f", inputs[0].size(), NanosPerRequest(inputs, iterations, LegacyParse));
+        for (header_scan::Impl impl : impls) {
+            header_scan::ForceImpl(impl);
+            std::printf(" %12.1f", NanosPerRequest(inputs, iterations, ParserParse));
+        }
+        std::printf("\n");
+    }
+    return 0;
+}
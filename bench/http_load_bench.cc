@@ -0,0 +1,93 @@
+// Load generator for a running webserver.
+//
+// Opens the given number of keep-alive connections, each on its own thread, and
+// sends GET path back to back on each for the given number of seconds,
+// reading every response in full. Prints requests per second, to compare
+// worker_threads, worker_cpu_affinity and reuseport settings.
+//
+//   ./bin/http_load_bench port path [connections] [seconds]
+
+#include <atomic>
+#include <boost/asio.hpp>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using boost::asio::ip::tcp;
+
+namespace {
+
+// Sends requests on one connection until stop is set. Returns the number of
+// complete responses.
+long RunConnection(unsigned short port, const std::string& path, const std::atomic<bool>& stop) {
+    boost::asio::io_service io;
+    tcp::socket socket(io);
+    boost::system::error_code ec;
+    socket.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), port), ec);
+    if (ec) return 0;
+    socket.set_option(tcp::no_delay(true), ec);
+
+    std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    boost::asio::streambuf buf;
+    long responses = 0;
+    while (!stop) {
+        boost::asio::write(socket, boost::asio::buffer(request), ec);
+        if (ec) break;
+        std::size_t header_length = boost::asio::read_until(socket, buf, "\r\n\r\n", ec);
+        if (ec) break;
+        std::string head(boost::asio::buffers_begin(buf.data()),
+                         boost::asio::buffers_begin(buf.data()) + header_length);
+        std::size_t content_length = 0;
+        auto pos = head.find("Content-Length: ");
+        if (pos != std::string::npos) content_length = std::stoul(head.substr(pos + 16));
+        std::size_t total = header_length + content_length;
+        if (buf.size() < total) {
+            boost::asio::read(socket, buf, boost::asio::transfer_exactly(total - buf.size()), ec);
+            if (ec) break;
+        }
+        buf.consume(total);
+        ++responses;
+        // The server closes after keepalive_requests; carry on with a new one
+        if (head.find("Connection: close") != std::string::npos) {
+            socket.close(ec);
+            socket.connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), port), ec);
+            if (ec) break;
+            buf.consume(buf.size());
+        }
+    }
+    return responses;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::fprintf(stderr, "Usage: http_load_bench port path [connections] [seconds]\n");
+        return 1;
+    }
+    unsigned short port = static_cast<unsigned short>(std::atoi(argv[1]));
+    std::string path = argv[2];
+    int connections = argc > 3 ? std::atoi(argv[3]) : 32;
+    int seconds = argc > 4 ? std::atoi(argv[4]) : 10;
+
+    std::atomic<bool> stop{false};
+    std::vector<long> counts(connections, 0);
+    std::vector<std::thread> threads;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < connections; ++i) {
+        threads.emplace_back([&, i] { counts[i] = RunConnection(port, path, stop); });
+    }
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    stop = true;
+    for (auto& thread : threads) thread.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    long total = 0;
+    for (long count : counts) total += count;
+    std::printf("%d connections, %.1f s: %ld requests, %.0f requests/s\n", connections, elapsed,
+                total, total / elapsed);
+    return 0;
+}
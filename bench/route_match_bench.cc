@@ -0,0 +1,95 @@
+// Microbenchmark for route matching.
+//
+// Compares the original Router lookup (sanitized copy of the URL, then a
+// linear rfind over every prefix) with RouteTrie for configs of 10, 100
+// and 1000 locations.
+//
+//   ./bin/route_match_bench [iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "route_trie.h"
+
+namespace {
+
+std::string SanitizePath(const std::string& path) {
+    std::string s = path;
+    if (s.empty() || s[0] != '/') s.insert(s.begin(), '/');
+    if (s.size() > 1 && s.back() == '/') s.pop_back();
+    return s;
+}
+
+// The pre-trie lookup, returns the index of the longest matching prefix
+std::size_t LinearMatch(const std::vector<std::string>& prefixes, const std::string& url) {
+    const std::string path = SanitizePath(url);
+    std::size_t best = 0;
+    std::size_t best_len = 0;
+    for (std::size_t i = 0; i < prefixes.size(); ++i) {
+        if (path.rfind(prefixes[i], 0) == 0 && prefixes[i].size() > best_len) {
+            best = i;
+            best_len = prefixes[i].size();
+        }
+    }
+    return best;
+}
+
+// Realistic-looking locations: a few top level areas with many services
+std::vector<std::string> MakePrefixes(std::size_t count) {
+    static const char* areas[] = {"api", "static", "docs", "admin", "media"};
+    std::vector<std::string> prefixes = {"/"};
+    for (std::size_t i = 1; i < count; ++i) {
+        prefixes.push_back("/" + std::string(areas[i % 5]) + "/service" + std::to_string(i));
+    }
+    return prefixes;
+}
+
+template <typename Fn>
+double NanosPerLookup(const std::vector<std::string>& urls, int iterations, Fn fn) {
+    std::size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        for (const std::string& url : urls) sink += fn(url);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    if (sink == 0) std::printf("(unexpected result)\n");
+    return std::chrono::duration<double, std::nano>(elapsed).count() /
+           (static_cast<double>(iterations) * urls.size());
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 2000;
+
+    std::printf("%-8s %12s %12s   (ns/lookup)\n", "routes", "linear", "trie");
+    for (std::size_t count : {10, 100, 1000}) {
+        std::vector<std::string> prefixes = MakePrefixes(count);
+        RouteTrie trie;
+        for (std::size_t i = 0; i < prefixes.size(); ++i) trie.Insert(prefixes[i], i);
+
+        // Mostly hits below a route, some misses that fall back to "/"
+        std::mt19937 rng(7);
+        std::vector<std::string> urls;
+        for (int i = 0; i < 256; ++i) {
+            if (i % 8 == 0) urls.push_back("/unknown/page" + std::to_string(i) + ".html");
+            else urls.push_back(prefixes[1 + rng() % (count - 1)] + "/items/42?fields=name");
+        }
+
+        std::printf("%-8zu %12.1f %12.1f\n", count,
+                    NanosPerLookup(urls, iterations,
+                                   [&](const std::string& url) {
+                                       return LinearMatch(prefixes, url) + 1;
+                                   }),
+                    NanosPerLookup(urls, iterations, [&](const std::string& url) {
+                        std::size_t value = 0;
+                        trie.Match(url, value);
+                        return value + 1;
+                    }));
+    }
+    return 0;
+}
@@ -0,0 +1,80 @@
+// Microbenchmark for handler instantiation in Router.
+//
+// Serves a small file through StaticHandler and a request through
+// EchoHandler with each HandlerRegistry::Sharing mode. PER_REQUEST is the
+// original behaviour: Init (and for StaticHandler its canonicalization
+// syscalls) runs on every request.
+//
+//   ./bin/router_bench [iterations]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "echo_handler.h"
+#include "handler_registry.h"
+#include "request.h"
+#include "router.h"
+#include "static_handler.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+Router::Factory FactoryFor(const std::string& name) {
+    return [name](const std::string& loc,
+                  const std::unordered_map<std::string, std::string>& params) {
+        return HandlerRegistry::CreateHandler(name, loc, params);
+    };
+}
+
+double NanosPerRequest(const std::string& handler, const std::string& url,
+                       const std::unordered_map<std::string, std::string>& params,
+                       HandlerRegistry::Sharing sharing, int iterations) {
+    Router router;
+    router.add_route("/", FactoryFor(handler), params, sharing);
+    Request request("GET " + url + " HTTP/1.1\r\nHost: localhost\r\n\r\n");
+
+    std::size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        sink += router.handle_request(request).get_status_code();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    if (sink != 200u * iterations) std::printf("(unexpected status)\n");
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 50000;
+
+    fs::path root = fs::temp_directory_path() / "router_bench";
+    fs::create_directories(root);
+    std::ofstream(root / "index.html") << "<html><body>hello</body></html>";
+    std::unordered_map<std::string, std::string> static_params = {{"root", root.string()}};
+
+    const struct {
+        HandlerRegistry::Sharing sharing;
+        const char* name;
+    } modes[] = {
+        {HandlerRegistry::PER_REQUEST, "per_request"},
+        {HandlerRegistry::PER_THREAD, "per_thread"},
+        {HandlerRegistry::SHARED, "shared"},
+    };
+
+    std::printf("%-14s %14s %14s   (ns/request)\n", "sharing", "StaticHandler", "EchoHandler");
+    for (const auto& mode : modes) {
+        std::printf("%-14s %14.1f %14.1f\n", mode.name,
+                    NanosPerRequest(StaticHandler::kName, "/index.html", static_params,
+                                    mode.sharing, iterations),
+                    NanosPerRequest(EchoHandler::kName, "/echo", {}, mode.sharing, iterations));
+    }
+
+    fs::remove_all(root);
+    return 0;
+}
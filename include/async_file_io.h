@@ -0,0 +1,43 @@
+#ifndef ASYNC_FILE_IO_H
+#define ASYNC_FILE_IO_H
+
+#include <boost/asio.hpp>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include "file_body.h"
+
+// File reads that never block the threads running an io_service. Requests
+// go to io_uring when the kernel allows it, otherwise to a small pool of
+// threads doing ordinary blocking calls; either way the callback is posted
+// back to the io_service. Thread-safe.
+class AsyncFileIO {
+  public:
+    enum Backend {
+      BACKEND_URING = 0,
+      BACKEND_THREADS = 1
+    };
+
+    // Bytes read, 0 at end of file
+    using ReadCallback = std::function<void(const boost::system::error_code&, std::size_t)>;
+
+    // io_uring backed, with a ring of uring_entries submissions, if
+    // allow_uring and the kernel supports it, otherwise by a pool of that
+    // many threads. Completions run on io_service.
+    static std::unique_ptr<AsyncFileIO> Create(boost::asio::io_service& io_service,
+                                               bool allow_uring = true,
+                                               std::size_t threads = 4,
+                                               unsigned uring_entries = 256);
+
+    virtual ~AsyncFileIO() = default;
+
+    // Reads up to length bytes of file starting at offset into buffer,
+    // which must stay valid until callback runs
+    virtual void Read(std::shared_ptr<const FileBody> file, std::size_t offset, char* buffer,
+                      std::size_t length, ReadCallback callback) = 0;
+
+    virtual Backend backend() const = 0;
+};
+
+#endif  // ASYNC_FILE_IO_H
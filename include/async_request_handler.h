@@ -0,0 +1,27 @@
+#ifndef ASYNC_REQUEST_HANDLER_H
+#define ASYNC_REQUEST_HANDLER_H
+
+#include <boost/asio.hpp>
+#include <functional>
+#include "request_handler.h"
+
+// A handler that finishes requests later, after a timer, a file read or an
+// upstream reply, without holding a thread while it waits. Register it as
+// HandlerRegistry::ASYNC so the session drives async_handle_request.
+class AsyncRequestHandler : public RequestHandler {
+  public:
+    using Callback = std::function<void(Response)>;
+
+    // Starts handling request, waiting on io (timers, sockets) rather than
+    // blocking. done must be called exactly once with the response, from a
+    // thread running io or from within this call. request stays valid
+    // until done is called.
+    virtual void async_handle_request(const Request& request, boost::asio::io_service& io,
+                                      Callback done) = 0;
+
+    // Drives async_handle_request on a private io_service until it's done,
+    // blocking the calling thread, for callers without an io_service
+    Response handle_request(const Request& request) override;
+};
+
+#endif  // ASYNC_REQUEST_HANDLER_H
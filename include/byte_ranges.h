@@ -0,0 +1,46 @@
+#ifndef BYTE_RANGES_H
+#define BYTE_RANGES_H
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Range request parsing (RFC 7233) for file-backed responses
+namespace byte_ranges {
+
+    // Most ranges honoured in one request. Larger sets are ignored and the
+    // whole file is sent, so a request can't ask for the same bytes
+    // over and over.
+    constexpr std::size_t kMaxRanges = 16;
+
+    // A satisfiable range, clamped to the file
+    struct Range {
+      std::size_t first = 0;
+      std::size_t length = 0;
+    };
+
+    enum Result {
+      // No usable Range header (absent, malformed or another unit): send
+      // the whole file
+      RANGE_NONE = 0,
+      // At least one range overlaps the file: send 206
+      RANGE_SATISFIABLE = 1,
+      // Every range starts past the end of the file: send 416
+      RANGE_UNSATISFIABLE = 2
+    };
+
+    // Parses a Range header value ("bytes=0-99,200-,-50") against a file of
+    // size bytes. Satisfiable ranges are appended to out in request order.
+    Result Parse(std::string_view header, std::size_t size, std::vector<Range>& out);
+
+    // Content-Range value for range of a file of size bytes
+    // ("bytes 0-99/1000")
+    std::string ContentRange(const Range& range, std::size_t size);
+
+    // Content-Range value of a 416 for a file of size bytes ("bytes */1000")
+    std::string UnsatisfiedRange(std::size_t size);
+
+}  // namespace byte_ranges
+
+#endif  // BYTE_RANGES_H
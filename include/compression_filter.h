@@ -0,0 +1,69 @@
+#ifndef COMPRESSION_FILTER_H
+#define COMPRESSION_FILTER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "content_encoding.h"
+#include "response_filter.h"
+
+// Compresses string bodies of compressible MIME types with gzip or deflate
+// when the client accepts it. Responses carrying a strong ETag describe a
+// fixed body, so their compressed form is cached (keyed by ETag) and later
+// hits skip compression; their ETag is sent weak, as the bytes differ.
+// A 304 gets the same Vary and weak ETag as its 200, so handlers give it
+// the Content-Type the 200 would have had (a 304 doesn't send it).
+class CompressionFilter : public ResponseFilter {
+  public:
+    // Counters since construction
+    struct Stats {
+      std::uint64_t compressed = 0;
+      std::uint64_t cache_hits = 0;
+      std::size_t cache_bytes = 0;
+    };
+
+    // Builds the filter a location's params ask for, nullptr if they don't:
+    //  - params["compress_level"] 1-9 enables compression (0 disables)
+    //  - params["compress_min_length"] (optional) smallest body compressed,
+    //    256 bytes by default
+    // Throws std::runtime_error on invalid values.
+    static std::unique_ptr<CompressionFilter> FromParams(
+        const std::string& location,
+        const std::unordered_map<std::string, std::string>& params);
+
+    CompressionFilter(int level, std::size_t min_length,
+                      std::size_t cache_capacity = 4 * 1024 * 1024);
+
+    void Apply(const Request& request, Response& response) const override;
+
+    // True for text/*, JSON, JavaScript, XML and SVG, ignoring parameters
+    static bool IsCompressible(const std::string& content_type);
+
+    Stats GetStats() const;
+
+  private:
+    // The compressed body cached under key, nullptr if there is none
+    std::shared_ptr<const std::string> CacheLookup(const std::string& key) const;
+
+    // Caches body under key, evicting least recently used entries
+    void CacheInsert(const std::string& key, std::shared_ptr<const std::string> body) const;
+
+    int level_;
+    std::size_t min_length_;
+    std::size_t cache_capacity_;
+
+    mutable std::mutex mutex_;
+    // Most recently used at the front
+    mutable std::list<std::pair<std::string, std::shared_ptr<const std::string>>> lru_;
+    mutable std::unordered_map<std::string, decltype(lru_)::iterator> index_;
+    mutable std::size_t cache_bytes_ = 0;
+    mutable std::atomic<std::uint64_t> compressed_{0};
+    mutable std::atomic<std::uint64_t> cache_hits_{0};
+};
+
+#endif  // COMPRESSION_FILTER_H
@@ -38,6 +38,73 @@ class NginxConfig {
   // number in the provided port_out out-param. Returns false if the config
   // has no/invalid port number directive.
   bool ExtractPort(unsigned short& port_out);
+
+  // Returns true if the config has a top-level "<name> ...;" directive, so
+  // a directive that is present but invalid can be told from a missing one
+  bool HasDirective(const std::string& name) const;
+
+  // Extracts the "keepalive_timeout <seconds>;" directive, the number of
+  // seconds an idle persistent connection is kept open. Returns false if the
+  // directive is missing or invalid.
+  bool ExtractKeepaliveTimeout(unsigned int& seconds_out);
+
+  // Extracts the "keepalive_requests <num>;" directive, the maximum number
+  // of requests served over one connection. Returns false if the directive
+  // is missing or invalid.
+  bool ExtractKeepaliveRequests(unsigned int& requests_out);
+
+  // Extracts the "open_file_cache <num>;" directive, the most open files
+  // kept for static content. Returns false if the directive is missing or
+  // invalid.
+  bool ExtractOpenFileCache(unsigned int& entries_out);
+
+  // Extracts the "open_file_cache_inactive <seconds>;" directive, how long
+  // an unused file stays open. Returns false if the directive is missing or
+  // invalid.
+  bool ExtractOpenFileCacheInactive(unsigned int& seconds_out);
+
+  // Extracts the "open_file_cache_valid <seconds>;" directive, how long a
+  // cached file is trusted before it is stat'ed again. Returns false if the
+  // directive is missing or invalid.
+  bool ExtractOpenFileCacheValid(unsigned int& seconds_out);
+
+  // Extracts the "aio on|threads|off;" directive, how streamed file bodies
+  // are read. Returns false if the directive is missing or invalid.
+  bool ExtractAio(std::string& mode_out);
+
+  // Extracts the "aio_threads <num>;" directive, the size of the thread
+  // pool used when io_uring is unavailable. Returns false if the directive
+  // is missing or invalid.
+  bool ExtractAioThreads(unsigned int& threads_out);
+
+  // Extracts the "handler_threads <num>;" directive, the size of the pool
+  // running blocking handlers; 0 runs them on the io_service threads.
+  // Returns false if the directive is missing or invalid.
+  bool ExtractHandlerThreads(unsigned int& threads_out);
+
+  // Extracts the "reuseport on|off;" directive, whether every io_service
+  // thread gets its own SO_REUSEPORT listener. Returns false if the
+  // directive is missing or invalid.
+  bool ExtractReusePort(bool& on_out);
+
+  // Extracts the "session_pool <num>;" directive, how many idle sessions
+  // each io_service keeps for reuse; 0 disables pooling. Returns false if
+  // the directive is missing or invalid.
+  bool ExtractSessionPool(unsigned int& sessions_out);
+
+  // Extracts the "worker_threads <num>|auto;" directive, the number of
+  // io_service threads. auto gives 0, leaving the choice to the caller.
+  // Returns false if the directive is missing or invalid.
+  bool ExtractWorkerThreads(unsigned int& threads_out);
+
+  // Extracts the "worker_cpu_affinity auto|<mask> ...;" directive: {"auto"},
+  // or one bitmask of 0s and 1s per worker thread. Returns false if the
+  // directive is missing or a mask is invalid.
+  bool ExtractWorkerCpuAffinity(std::vector<std::string>& masks_out);
+
+ private:
+  // Looks up a top-level "<name> <unsigned int>;" directive.
+  bool ExtractUnsigned(const std::string& name, unsigned int& value_out);
 };
 
 // The driver that parses a config file and generates an NginxConfig.
@@ -0,0 +1,48 @@
+#ifndef CONTENT_ENCODING_H
+#define CONTENT_ENCODING_H
+
+#include <string>
+#include <string_view>
+
+// Content-coding negotiation (RFC 7231 section 5.3.4) and compression for
+// compressed representations of responses
+namespace content_encoding {
+
+    enum Coding {
+      IDENTITY = 0,
+      GZIP = 1,
+      BROTLI = 2,
+      ZSTD = 3,
+      DEFLATE = 4,
+      NUM_CODINGS = 5
+    };
+
+    // Bit of coding in a set of codings
+    constexpr unsigned Bit(Coding coding) { return 1u << coding; }
+
+    // Set of compressed codings (never IDENTITY) the client accepts, parsed
+    // from an Accept-Encoding value. "q=0" excludes a coding and "*" covers
+    // every coding not listed explicitly. Doesn't allocate.
+    unsigned Accepted(std::string_view accept_encoding);
+
+    // The coding to send out of those both accepted and available, in
+    // server preference order (br, zstd, gzip, deflate), or IDENTITY if none
+    Coding Choose(unsigned accepted, unsigned available);
+
+    // Content-Encoding token of coding ("br"), "" for IDENTITY
+    const char* Name(Coding coding);
+
+    // File name suffix of a precompressed sibling (".br"), "" for IDENTITY
+    // and DEFLATE, which has no precompressed form
+    const char* Suffix(Coding coding);
+
+    // True if Compress supports coding (GZIP and DEFLATE, via zlib)
+    bool CanCompress(Coding coding);
+
+    // data compressed with coding at level (1-9). Throws
+    // std::runtime_error if coding isn't supported or zlib fails.
+    std::string Compress(std::string_view data, Coding coding, int level);
+
+}  // namespace content_encoding
+
+#endif  // CONTENT_ENCODING_H
@@ -44,7 +44,7 @@ private:
   int entity_id_;
 
   // helpers
-  bool is_valid_json(const std::string& body) const;
+  bool is_valid_json(std::string_view body) const;
   std::string parse_for_entity(const std::string& url_path) const;
   std::string parse_for_id(const std::string& url_path) const;
   int generate_unique_id(const std::string& entity_type) const;
@@ -62,6 +62,8 @@ private:
 inline bool _crud_api_handler_registered =
     HandlerRegistry::RegisterHandler(
         CrudApiHandler::kName,
-        CrudApiHandler::Init);
+        CrudApiHandler::Init,
+        HandlerRegistry::PER_THREAD,
+        HandlerRegistry::BLOCKING);
 
 #endif  // CRUD_API_HANDLER
\ No newline at end of file
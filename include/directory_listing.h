@@ -0,0 +1,63 @@
+#ifndef DIRECTORY_LISTING_H
+#define DIRECTORY_LISTING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "file_body.h"
+
+// Autoindex pages for StaticHandler: the HTML listing of a directory is
+// built once and kept until the directory's mtime (or inode) changes,
+// which happens whenever an entry is added, removed or renamed. A hit
+// costs the caller's stat() of the directory and no readdir, however large
+// the directory. Sizes and dates shown are those of when the listing was
+// built. Thread-safe.
+class DirectoryListingCache {
+  public:
+    // Counters since construction
+    struct Stats {
+      std::uint64_t hits = 0;
+      std::uint64_t misses = 0;
+      std::size_t entries = 0;
+    };
+
+    explicit DirectoryListingCache(std::size_t max_entries = 1024, std::size_t shards = 16);
+
+    // Listing of directory dir, whose metadata is current, titled with
+    // the URL it is served at. nullptr if dir can't be read.
+    std::shared_ptr<const std::string> Get(const std::string& dir, const FileStat& current,
+                                           const std::string& url);
+
+    Stats GetStats() const;
+
+    // Builds the listing of dir: subdirectories first, then files, each
+    // sorted by name, skipping hidden entries. Throws
+    // std::filesystem::filesystem_error if dir can't be read.
+    static std::string Render(const std::string& dir, const std::string& url);
+
+  private:
+    struct Entry {
+      FileStat stat;
+      std::string url;
+      std::shared_ptr<const std::string> html;
+    };
+
+    struct Shard {
+      std::mutex mutex;
+      std::unordered_map<std::string, Entry> index;
+    };
+
+    Shard& ShardFor(const std::string& dir);
+
+    std::size_t shard_entries_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+};
+
+#endif  // DIRECTORY_LISTING_H
@@ -0,0 +1,52 @@
+#ifndef DIRECTORY_WATCHER_H
+#define DIRECTORY_WATCHER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+// Watches a directory tree with inotify(7) from a background thread so
+// caches derived from it (e.g. PathResolver) can tell when to drop their
+// contents by comparing a counter, without a syscall per lookup.
+class DirectoryWatcher {
+  public:
+    // Watches root and every directory below it, following new ones as
+    // they appear. Symlinks are noted but not followed.
+    explicit DirectoryWatcher(const std::string& root);
+    ~DirectoryWatcher();
+    DirectoryWatcher(const DirectoryWatcher&) = delete;
+    DirectoryWatcher& operator=(const DirectoryWatcher&) = delete;
+
+    // False if the tree couldn't be watched or events were lost (inotify
+    // unavailable, watch limit reached, queue overflow). Nothing derived
+    // from the tree may be cached then.
+    bool healthy() const;
+
+    // Incremented after every change under the root
+    std::uint64_t generation() const;
+
+    // True while no symlink has been seen anywhere under the root
+    bool symlink_free() const;
+
+  private:
+    // Adds watches for dir and the directories below it
+    void AddTree(const std::string& dir);
+
+    // Reads and applies events until the destructor wakes it
+    void Run();
+
+    int inotify_fd_ = -1;
+    // Written by the destructor to stop Run
+    int wake_fd_ = -1;
+    // Watch descriptor to the directory it watches, only touched by the
+    // constructor and then the watcher thread
+    std::unordered_map<int, std::string> dirs_;
+    std::atomic<bool> healthy_{false};
+    std::atomic<bool> symlink_free_{true};
+    std::atomic<std::uint64_t> generation_{0};
+    std::thread thread_;
+};
+
+#endif  // DIRECTORY_WATCHER_H
@@ -26,6 +26,7 @@ private:
 // Auto-register with the registry at static init time
 inline bool _echo_registered =
     HandlerRegistry::RegisterHandler(EchoHandler::kName,
-                                     EchoHandler::Init);
+                                     EchoHandler::Init,
+                                     HandlerRegistry::SHARED);
 
 #endif  // ECHO_HANDLER_H
@@ -0,0 +1,35 @@
+#ifndef EMBEDDED_ASSETS_H
+#define EMBEDDED_ASSETS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// A file compiled into the binary by tools/embed_assets. Everything points
+// into read-only data, so the pages are shared by every process running
+// the binary and never touch the filesystem.
+struct EmbeddedAsset {
+  // Path relative to the embedded directory, e.g. "/css/app.css"
+  std::string_view path;
+  // "HTTP/1.1 200 OK" status line and Content-Type, Content-Length, ETag
+  // and Last-Modified headers, each ending in CRLF
+  std::string_view head;
+  std::string_view body;
+  std::string_view content_type;
+  // Strong ETag from a hash of the body, including the quotes
+  std::string_view etag;
+  std::int64_t last_modified;
+};
+
+// The assets of a generated table, sorted by path
+struct EmbeddedAssetTable {
+  const EmbeddedAsset* assets;
+  std::size_t count;
+};
+
+// The directory named by the EMBED_STATIC_DIR CMake option, or no assets
+// if it is unset. Defined by the generated source linked into the
+// webserver binary (src/embedded_assets_none.cc when nothing is embedded).
+EmbeddedAssetTable EmbeddedAssets();
+
+#endif  // EMBEDDED_ASSETS_H
@@ -0,0 +1,51 @@
+#ifndef EMBEDDED_STATIC_HANDLER_H
+#define EMBEDDED_STATIC_HANDLER_H
+
+#include "request_handler.h"
+#include "handler_registry.h"
+#include "embedded_assets.h"
+#include "perfect_hash.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+// Serves the assets compiled into the binary (see tools/embed_assets.cc)
+// with their prebuilt headers. Requests never touch the filesystem, and
+// the assets change only with the binary.
+class EmbeddedStaticHandler : public RequestHandler {
+public:
+  // The key that must appear in your config
+  static constexpr char kName[] = "EmbeddedStaticHandler";
+
+  // Called by the registry to produce a configured instance serving
+  // EmbeddedAssets() below location. Takes no params. Throws
+  // std::runtime_error if the binary was built without EMBED_STATIC_DIR.
+  static RequestHandler* Init(
+      const std::string& location,
+      const std::unordered_map<std::string, std::string>& params);
+
+  // Serves the files of assets at url_prefix + their path
+  EmbeddedStaticHandler(std::string url_prefix, EmbeddedAssetTable assets);
+
+  Response handle_request(const Request& request) override;
+
+  // Number of assets served
+  std::size_t size() const;
+
+private:
+  // The mount point (prefix) we were configured with, without a trailing
+  // slash
+  std::string prefix_;
+  EmbeddedAssetTable assets_;
+  // Asset paths; also owns prebuilt responses, which point into static data
+  std::shared_ptr<const PerfectHash> index_;
+};
+
+// one-time registration at load time:
+inline bool _embedded_static_handler_registered =
+    HandlerRegistry::RegisterHandler(
+        EmbeddedStaticHandler::kName,
+        EmbeddedStaticHandler::Init,
+        HandlerRegistry::SHARED);
+
+#endif  // EMBEDDED_STATIC_HANDLER_H
@@ -0,0 +1,59 @@
+#ifndef FILE_BODY_H
+#define FILE_BODY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// The parts of stat(2) used to tell whether a file changed
+struct FileStat {
+  std::size_t size = 0;
+  std::int64_t mtime_ns = 0;
+  std::uint64_t inode = 0;
+  std::uint64_t device = 0;
+  bool regular = false;
+
+  // Fills out from stat(2) of path. Returns false if it can't be stat'ed.
+  static bool Load(const std::string& path, FileStat& out);
+
+  // True if both describe the same version of the same file
+  bool SameFile(const FileStat& other) const;
+};
+
+// An open, read-only file used as a response body. The session writes the
+// response headers and then hands the descriptor to sendfile(2), so the
+// bytes go from the page cache to the socket without being copied into
+// the process.
+class FileBody {
+  public:
+    // Opens path for reading. Returns nullptr if it doesn't exist, can't be
+    // read or isn't a regular file.
+    static std::shared_ptr<FileBody> Open(const std::string& path);
+
+    ~FileBody();
+    FileBody(const FileBody&) = delete;
+    FileBody& operator=(const FileBody&) = delete;
+
+    // Descriptor to stream from. Reads must use explicit offsets (pread,
+    // sendfile with an offset) so one FileBody can be shared.
+    int fd() const;
+
+    // Size of the file when it was opened
+    std::size_t size() const;
+
+    // Metadata of the file when it was opened
+    const FileStat& stat() const;
+
+    // Copies up to length bytes starting at offset. Only for callers that
+    // need the bytes in memory, such as Response::to_string().
+    std::string Read(std::size_t offset, std::size_t length) const;
+
+  private:
+    FileBody(int fd, const FileStat& stat);
+
+    int fd_;
+    FileStat stat_;
+};
+
+#endif  // FILE_BODY_H
@@ -2,10 +2,12 @@
 #define FILESYSTEM_H
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <filesystem>
 #include <fstream>
 #include <memory>
+#include "file_body.h"
 
 namespace fs = std::filesystem;
 
@@ -29,6 +31,26 @@ public:
     // File operations
     virtual std::string read_file(const fs::path& path) const = 0;
     virtual bool write_file(const fs::path& path, const std::string& content) const = 0;
+
+    // Writes content without requiring the caller to own it as a std::string.
+    // Defaults to copying; implementations that can write straight from the
+    // view override it.
+    virtual bool write_file(const fs::path& path, std::string_view content) const {
+        return write_file(path, std::string(content));
+    }
+
+    // Opens a regular file for streaming or positional reads, nullptr if
+    // it isn't one or can't be read. Implementations may hand out a cached
+    // descriptor shared with other callers.
+    virtual std::shared_ptr<const FileBody> open_file(const fs::path& path) const {
+        return FileBody::Open(path.string());
+    }
+
+    // Metadata of the regular file at path. Returns false if it isn't one
+    // or can't be stat'ed.
+    virtual bool stat_file(const fs::path& path, FileStat& out) const {
+        return FileStat::Load(path.string(), out) && out.regular;
+    }
 };
 
 #endif
\ No newline at end of file
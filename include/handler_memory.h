@@ -0,0 +1,97 @@
+#ifndef HANDLER_MEMORY_H
+#define HANDLER_MEMORY_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Room for the completion handler of one operation a session keeps in
+// flight (its read, or its gathered write), so starting the operation
+// doesn't allocate. A handler that doesn't fit, or a second one while the
+// block is taken, comes from the heap instead. Only used from the
+// session's own handlers, so it needs no locking.
+class HandlerMemory {
+  public:
+    HandlerMemory() = default;
+    HandlerMemory(const HandlerMemory&) = delete;
+    HandlerMemory& operator=(const HandlerMemory&) = delete;
+
+    void* Allocate(std::size_t size) {
+      if (!in_use_ && size <= sizeof(storage_)) {
+        in_use_ = true;
+        return &storage_;
+      }
+      return ::operator new(size);
+    }
+
+    void Deallocate(void* pointer) {
+      if (pointer == &storage_) {
+        in_use_ = false;
+        return;
+      }
+      ::operator delete(pointer);
+    }
+
+  private:
+    typename std::aligned_storage<1024>::type storage_;
+    bool in_use_ = false;
+};
+
+// Allocator drawing from a HandlerMemory, which Asio finds through a
+// handler's get_allocator()
+template <typename T>
+class HandlerAllocator {
+  public:
+    using value_type = T;
+
+    explicit HandlerAllocator(HandlerMemory& memory) : memory_(&memory) {}
+
+    template <typename U>
+    HandlerAllocator(const HandlerAllocator<U>& other) noexcept : memory_(other.memory_) {}
+
+    T* allocate(std::size_t n) const {
+      return static_cast<T*>(memory_->Allocate(sizeof(T) * n));
+    }
+
+    void deallocate(T* pointer, std::size_t) const { memory_->Deallocate(pointer); }
+
+    bool operator==(const HandlerAllocator& other) const noexcept {
+      return memory_ == other.memory_;
+    }
+    bool operator!=(const HandlerAllocator& other) const noexcept {
+      return memory_ != other.memory_;
+    }
+
+  private:
+    template <typename> friend class HandlerAllocator;
+    HandlerMemory* memory_;
+};
+
+// A completion handler whose operation is allocated from a HandlerMemory
+template <typename Handler>
+class MemoryHandler {
+  public:
+    using allocator_type = HandlerAllocator<Handler>;
+
+    MemoryHandler(HandlerMemory& memory, Handler handler)
+      : memory_(memory), handler_(std::move(handler)) {}
+
+    allocator_type get_allocator() const noexcept { return allocator_type(memory_); }
+
+    template <typename... Args>
+    void operator()(Args&&... args) { handler_(std::forward<Args>(args)...); }
+
+  private:
+    HandlerMemory& memory_;
+    Handler handler_;
+};
+
+template <typename Handler>
+MemoryHandler<typename std::decay<Handler>::type> MakeMemoryHandler(HandlerMemory& memory,
+                                                                    Handler&& handler) {
+  return MemoryHandler<typename std::decay<Handler>::type>(memory,
+                                                           std::forward<Handler>(handler));
+}
+
+#endif  // HANDLER_MEMORY_H
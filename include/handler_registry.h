@@ -14,20 +14,51 @@ public:
         std::function<RequestHandler*(const std::string& /*location*/,
                                       const std::unordered_map<std::string, std::string>& /*params*/)>;
 
+    // How the Router may reuse instances produced by a factory
+    enum Sharing {
+        PER_REQUEST = 0,  // fresh instance for every request (safe default)
+        PER_THREAD = 1,   // one instance per route per thread, not thread-safe
+        SHARED = 2        // one instance per route built at startup, thread-safe
+    };
+
+    // Whether handle_request may block its thread (sleeping, disk I/O), in
+    // which case the session runs it on the handler thread pool rather than
+    // on an io_service thread. ASYNC handlers derive from
+    // AsyncRequestHandler and wait on the io_service instead of blocking.
+    enum Blocking {
+        NON_BLOCKING = 0,
+        BLOCKING = 1,
+        ASYNC = 2
+    };
+
     // Register a factory under a unique name. Returns false if already present.
-    static bool RegisterHandler(const std::string& name, RequestHandlerFactory factory);
+    static bool RegisterHandler(const std::string& name, RequestHandlerFactory factory,
+                                Sharing sharing = PER_REQUEST,
+                                Blocking blocking = NON_BLOCKING);
 
     // Instantiate a handler by name. Throws std::runtime_error if unknown.
     static RequestHandler* CreateHandler(const std::string& name,
                                          const std::string& location,
                                          const std::unordered_map<std::string, std::string>& params);
 
+    // Sharing declared for this name. Throws std::runtime_error if unknown.
+    static Sharing GetSharing(const std::string& name);
+
+    // Blocking declared for this name. Throws std::runtime_error if unknown.
+    static Blocking GetBlocking(const std::string& name);
+
     // Check if any factory is registered under this name.
     static bool HasHandlerFor(const std::string& name);
 
 private:
-    // Returns the singleton map of name→factory
-    static std::unordered_map<std::string, RequestHandlerFactory>& registry();
+    struct Entry {
+        RequestHandlerFactory factory;
+        Sharing sharing;
+        Blocking blocking;
+    };
+
+    // Returns the singleton map of name→entry
+    static std::unordered_map<std::string, Entry>& registry();
 };
 
 #endif  // HANDLER_REGISTRY_H
@@ -0,0 +1,36 @@
+#ifndef HEADER_SCAN_H
+#define HEADER_SCAN_H
+
+#include <cstddef>
+
+// Vectorized search used by RequestParser to skip over header bytes it
+// doesn't care about. The widest implementation the CPU supports (AVX2,
+// then SSE2, then a plain loop) is picked once at startup.
+namespace header_scan {
+
+    enum Impl {
+        IMPL_SCALAR = 0,
+        IMPL_SSE2 = 1,
+        IMPL_AVX2 = 2
+    };
+
+    // Returns a pointer to the first byte in [begin, end) equal to a or b,
+    // or end if there is none.
+    const char* FindEither(const char* begin, const char* end, char a, char b);
+
+    // Implementation currently used by FindEither
+    Impl ActiveImpl();
+
+    // Human readable name of an implementation ("scalar", "sse2", "avx2")
+    const char* ImplName(Impl impl);
+
+    // Returns true if the running CPU can use impl
+    bool IsSupported(Impl impl);
+
+    // Switches FindEither to impl (used by tests and benchmarks). Returns
+    // false and changes nothing if the CPU doesn't support it.
+    bool ForceImpl(Impl impl);
+
+}  // namespace header_scan
+
+#endif  // HEADER_SCAN_H
@@ -26,6 +26,7 @@ class HealthHandler : public RequestHandler {
 //One-time registration at load time:
 inline bool _health_handler_registered =
     HandlerRegistry::RegisterHandler(HealthHandler::kName,
-                                     HealthHandler::Init);
+                                     HealthHandler::Init,
+                                     HandlerRegistry::SHARED);
 
 #endif // HEALTH_HANDLER_H
\ No newline at end of file
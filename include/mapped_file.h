@@ -0,0 +1,96 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "file_body.h"
+
+// A read-only, shared mmap(2) of a whole file. The session writes straight
+// from the mapping together with the response headers in one gathered
+// write, so the bytes are never copied into a std::string. The mapping
+// stays valid after the file is renamed over or unlinked, but truncating
+// the file in place makes reads past the new end fault, so mapped roots
+// must be updated by replacing files rather than rewriting them.
+class MappedFile {
+  public:
+    // madvise(2) hint applied to new mappings
+    enum Advice {
+      ADVICE_NORMAL = 0,
+      ADVICE_SEQUENTIAL = 1,
+      ADVICE_RANDOM = 2,
+      ADVICE_WILLNEED = 3
+    };
+
+    // Parses "normal", "sequential", "random" or "willneed". Returns false
+    // for anything else.
+    static bool ParseAdvice(const std::string& name, Advice& out);
+
+    // Maps file, which must stay unchanged for as long as the mapping is
+    // read. Returns nullptr if it can't be mapped.
+    static std::shared_ptr<MappedFile> Map(const FileBody& file, Advice advice = ADVICE_NORMAL);
+
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // First byte of the file, nullptr for an empty file
+    const char* data() const;
+
+    std::size_t size() const;
+
+    // Metadata of the file when it was mapped
+    const FileStat& stat() const;
+
+  private:
+    MappedFile(void* addr, const FileStat& stat);
+
+    void* addr_;
+    FileStat stat_;
+};
+
+// Mappings of the files served by one StaticHandler, shared by all its
+// threads. A file is mapped once and remapped only when its metadata
+// changes (new inode, size or mtime); the old mapping lives on until the
+// last response using it is written. Locked per shard.
+class MappedFileTable {
+  public:
+    // Counters since construction
+    struct Stats {
+      std::uint64_t hits = 0;
+      std::uint64_t misses = 0;
+      std::size_t entries = 0;
+      std::size_t bytes = 0;
+    };
+
+    explicit MappedFileTable(std::size_t max_entries = 16384, std::size_t shards = 16);
+
+    // The mapping of path if it was made from a file matching current,
+    // nullptr otherwise. A stale mapping is dropped.
+    std::shared_ptr<const MappedFile> Lookup(const std::string& path, const FileStat& current);
+
+    // Keeps mapping for path, replacing any older one
+    void Insert(const std::string& path, std::shared_ptr<const MappedFile> mapping);
+
+    Stats GetStats() const;
+
+  private:
+    struct Shard {
+      std::mutex mutex;
+      std::unordered_map<std::string, std::shared_ptr<const MappedFile>> index;
+    };
+
+    Shard& ShardFor(const std::string& path);
+
+    std::size_t shard_entries_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+};
+
+#endif  // MAPPED_FILE_H
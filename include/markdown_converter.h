@@ -2,11 +2,12 @@
 #define MARKDOWN_CONVERTER_H
 
 #include <string>
+#include <string_view>
 
 namespace markdown {
 
     // Converts a Markdown string to HTML using the cmark library.
-    std::string ConvertToHtml(const std::string& markdown_input);
+    std::string ConvertToHtml(std::string_view markdown_input);
 
     // (Optional) Wraps the HTML in a full HTML template with <html>, <head>, and <body> tags.
     std::string WrapInHtmlTemplate(const std::string& html_body);
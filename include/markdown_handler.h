@@ -3,7 +3,10 @@
 
 #include "request_handler.h"
 #include "handler_registry.h"
+#include "path_resolver.h"
+#include "filesystem.h"
 #include "markdown_converter.h"
+#include <memory>
 #include <string>
 #include <filesystem>
 #include <stdexcept>
@@ -33,6 +36,10 @@ private:
   std::string prefix_;
   // The absolute filesystem root we were configured with.
   std::string fs_root_;
+  // Maps URLs under prefix_ to files under fs_root_, caching the results
+  PathResolver resolver_;
+  // Opens files, through the process-wide open file cache
+  std::shared_ptr<FileSystemInterface> fs_;
 
   Response handle_get(const Request& request);
   Response handle_post(const Request& request);
@@ -46,6 +53,8 @@ private:
 inline bool _markdown_handler_registered =
     HandlerRegistry::RegisterHandler(
         MarkdownHandler::kName,
-        MarkdownHandler::Init);
+        MarkdownHandler::Init,
+        HandlerRegistry::SHARED,
+        HandlerRegistry::BLOCKING);
 
 #endif  // MARKDOWN_HANDLER_H
@@ -0,0 +1,15 @@
+#ifndef MIME_TYPES_H
+#define MIME_TYPES_H
+
+#include <string>
+
+// Content types of served files, by file name extension
+namespace mime_types {
+
+    // Content-Type for the file at path, with a UTF-8 charset for HTML and
+    // plain text. application/octet-stream for unknown extensions.
+    std::string ContentType(const std::string& path);
+
+}  // namespace mime_types
+
+#endif  // MIME_TYPES_H
@@ -27,6 +27,7 @@ class NotFoundHandler : public RequestHandler {
 //One-time registration at load time:
 inline bool _not_found_handler_registered =
     HandlerRegistry::RegisterHandler(NotFoundHandler::kName,
-                                     NotFoundHandler::Init);
+                                     NotFoundHandler::Init,
+                                     HandlerRegistry::SHARED);
 
 #endif // NOT_FOUND_HANDLER_H
\ No newline at end of file
@@ -0,0 +1,94 @@
+#ifndef OPEN_FILE_CACHE_H
+#define OPEN_FILE_CACHE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "file_body.h"
+
+// Settings of an OpenFileCache, read from the config file
+struct OpenFileCacheOptions {
+  // Most open files kept, 0 disables the cache
+  std::size_t max_entries = 0;
+  // Seconds an unused file stays open
+  unsigned int inactive_seconds = 20;
+  // Seconds a file is served without checking it changed on disk
+  unsigned int valid_seconds = 60;
+};
+
+// Table of open files with their stat(2) results, like nginx's
+// open_file_cache. A hit within the validity interval costs no syscalls at
+// all; after it a single stat() revalidates the entry. Files are handed out
+// as shared FileBodys, so an entry evicted while a response is still being
+// sent keeps its descriptor open until that response is done. Thread-safe,
+// locked per shard.
+class OpenFileCache {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    // Counters since construction
+    struct Stats {
+      std::uint64_t hits = 0;
+      std::uint64_t misses = 0;
+      std::uint64_t revalidations = 0;
+      std::uint64_t evictions = 0;
+      std::size_t entries = 0;
+    };
+
+    // now is the time source, replaceable for tests
+    explicit OpenFileCache(const OpenFileCacheOptions& options, std::size_t shards = 16,
+                           std::function<Clock::time_point()> now = Clock::now);
+
+    // The open file at path, nullptr if it isn't a readable regular file
+    std::shared_ptr<const FileBody> Open(const std::string& path);
+
+    // Drops path, e.g. after writing to it
+    void Invalidate(const std::string& path);
+
+    Stats GetStats() const;
+
+  private:
+    struct Entry {
+      std::shared_ptr<const FileBody> file;
+      Clock::time_point validated;
+      Clock::time_point last_used;
+      // Position in the shard's recency list
+      std::list<std::string>::iterator lru;
+    };
+
+    struct Shard {
+      std::mutex mutex;
+      // Most recently used at the front
+      std::list<std::string> lru;
+      std::unordered_map<std::string, Entry> index;
+      // Bumped by every Invalidate, so a file opened while it was being
+      // written isn't cached with the stat of a half-written file
+      std::uint64_t generation = 0;
+    };
+
+    // Closes files of shard unused for longer than the inactivity limit
+    // and the least recently used ones beyond its size limit. Called with
+    // the shard locked.
+    void Trim(Shard& shard, Clock::time_point now);
+
+    Shard& ShardFor(const std::string& path);
+
+    OpenFileCacheOptions options_;
+    std::size_t shard_entries_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::function<Clock::time_point()> now_;
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+    std::atomic<std::uint64_t> revalidations_{0};
+    std::atomic<std::uint64_t> evictions_{0};
+};
+
+#endif  // OPEN_FILE_CACHE_H
@@ -0,0 +1,79 @@
+#ifndef PATH_RESOLVER_H
+#define PATH_RESOLVER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "directory_watcher.h"
+
+// Maps request URLs below a location prefix to files under a root
+// directory, rejecting any that would resolve outside it. Used by the file
+// serving handlers in place of canonicalizing on every request:
+//  - the root is canonicalized once
+//  - while the root holds no symlinks, a URL without "." or ".." segments
+//    is resolved lexically, without any syscalls
+//  - other results (including rejections) are cached per URL suffix
+// A DirectoryWatcher invalidates both when the tree changes. Without one
+// (inotify unavailable) every URL takes the slow path. Thread-safe.
+class PathResolver {
+  public:
+    // Counters since construction
+    struct Stats {
+      std::uint64_t lexical = 0;
+      std::uint64_t hits = 0;
+      std::uint64_t misses = 0;
+    };
+
+    // root is the absolute filesystem root, watch false disables the
+    // watcher (and so every shortcut)
+    PathResolver(std::string prefix, std::string root, bool watch = true,
+                 std::size_t max_entries = 16384, std::size_t shards = 16);
+
+    // Absolute path of the file url names. Throws std::runtime_error if url
+    // isn't under the prefix or the path leaves the root.
+    std::string Resolve(std::string_view url) const;
+
+    Stats GetStats() const;
+
+  private:
+    // A cached resolution: the path, or the reason it was rejected
+    struct Entry {
+      std::string path;
+      std::string error;
+    };
+
+    struct Shard {
+      std::mutex mutex;
+      std::unordered_map<std::string, Entry> index;
+      // Watcher generation the entries were resolved under
+      std::uint64_t generation = 0;
+    };
+
+    // True if rest has no empty, "." or ".." segments, so it can't step
+    // outside the root lexically
+    static bool IsClean(std::string_view rest);
+
+    // Resolves rest against the filesystem, following symlinks
+    Entry Walk(const std::string& rest) const;
+
+    Shard& ShardFor(const std::string& rest) const;
+
+    std::string prefix_;
+    std::string root_;
+    // Canonical root, empty if it couldn't be resolved at startup
+    std::string base_;
+    std::unique_ptr<DirectoryWatcher> watcher_;
+    std::size_t shard_entries_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    mutable std::atomic<std::uint64_t> lexical_{0};
+    mutable std::atomic<std::uint64_t> hits_{0};
+    mutable std::atomic<std::uint64_t> misses_{0};
+};
+
+#endif  // PATH_RESOLVER_H
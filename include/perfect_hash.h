@@ -0,0 +1,43 @@
+#ifndef PERFECT_HASH_H
+#define PERFECT_HASH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Perfect hash over a fixed set of distinct keys, built with hash and
+// displace: keys are grouped into buckets by one hash, and each bucket gets
+// a seed that sends its keys to free slots. A lookup hashes the key once,
+// reads one seed and one slot and compares one key, with no probing.
+class PerfectHash {
+  public:
+    static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+    // Indexes keys, which must be distinct and outlive the index. Index i
+    // stands for keys[i].
+    explicit PerfectHash(std::vector<std::string_view> keys);
+
+    // Index of key, npos if it isn't one of the keys
+    std::size_t Find(std::string_view key) const;
+
+    std::size_t size() const;
+
+  private:
+    static std::uint64_t Hash(std::string_view key);
+
+    // Slot of a key with hash h in a bucket displaced by seed
+    std::size_t Slot(std::uint64_t h, std::uint32_t seed) const;
+
+    // Tries to place every bucket in slot_count slots. Returns false if
+    // some bucket found no seed, leaving the index unusable.
+    bool Build(std::size_t slot_count);
+
+    std::vector<std::string_view> keys_;
+    std::vector<std::uint32_t> seeds_;
+    // Key index per slot, empty_slot if unused
+    std::vector<std::uint32_t> slots_;
+    static constexpr std::uint32_t empty_slot = static_cast<std::uint32_t>(-1);
+};
+
+#endif  // PERFECT_HASH_H
@@ -0,0 +1,62 @@
+#ifndef PRECOMPRESSED_INDEX_H
+#define PRECOMPRESSED_INDEX_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "content_encoding.h"
+#include "file_body.h"
+
+// Remembers which precompressed siblings (app.css.br, app.css.zst,
+// app.css.gz) exist next to the files StaticHandler serves, so choosing
+// one costs no stat() calls beyond the one of the file itself. Siblings
+// are probed again whenever that file changes, which is when a deploy
+// rewrites them too. Thread-safe, locked per shard.
+class PrecompressedIndex {
+  public:
+    struct Siblings {
+      // content_encoding::Bit()s of the codings with a usable sibling
+      unsigned available = 0;
+      // Metadata of each available sibling, indexed by Coding
+      FileStat stat[content_encoding::NUM_CODINGS];
+    };
+
+    explicit PrecompressedIndex(std::size_t max_entries = 16384, std::size_t shards = 16);
+
+    // Siblings of the file at path, whose current metadata is base
+    Siblings Lookup(const std::string& path, const FileStat& base);
+
+    // Forgets path, e.g. after one of its siblings couldn't be opened
+    void Invalidate(const std::string& path);
+
+    // Number of times siblings were looked for on disk
+    std::uint64_t probes() const;
+
+  private:
+    struct Entry {
+      FileStat base;
+      Siblings siblings;
+    };
+
+    struct Shard {
+      std::mutex mutex;
+      std::unordered_map<std::string, Entry> index;
+    };
+
+    // stat()s each sibling of path. One older than base is stale (the file
+    // was changed without recompressing it) and isn't used.
+    static Siblings Probe(const std::string& path, const FileStat& base);
+
+    Shard& ShardFor(const std::string& path);
+
+    std::size_t shard_entries_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<std::uint64_t> probes_{0};
+};
+
+#endif  // PRECOMPRESSED_INDEX_H
@@ -0,0 +1,80 @@
+#ifndef PRELOADED_ROOT_H
+#define PRELOADED_ROOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "perfect_hash.h"
+
+// Every regular file under a StaticHandler root, read once at startup into
+// a single contiguous arena together with its URL and a prebuilt
+// "HTTP/1.1 200 OK" status line and headers, and found by URL through a
+// perfect hash. Immutable once loaded, so lookups take no locks and make
+// no syscalls; files changed on disk afterwards are only picked up by a
+// restart.
+class PreloadedRoot {
+  public:
+    struct File {
+      // URL path the file is served at, e.g. "/static/css/app.css"
+      std::string_view url;
+      // Status line and headers up to, not including, Connection
+      std::string_view head;
+      std::string_view body;
+      std::string etag;
+      std::int64_t last_modified = 0;
+    };
+
+    // Loads the files under root, served below the URL prefix.
+    // content_type gives the Content-Type of a file path. Symlinks leading
+    // out of root and unreadable files are skipped. Throws
+    // std::runtime_error if root can't be walked.
+    static std::shared_ptr<const PreloadedRoot> Load(
+        const std::string& prefix, const std::string& root,
+        const std::function<std::string(const std::string&)>& content_type);
+
+    ~PreloadedRoot();
+    PreloadedRoot(const PreloadedRoot&) = delete;
+    PreloadedRoot& operator=(const PreloadedRoot&) = delete;
+
+    // The file served at url, whose query string is ignored. nullptr if
+    // there is none.
+    const File* Find(std::string_view url) const;
+
+    // Number of files
+    std::size_t size() const;
+
+    // Bytes held by the arena
+    std::size_t bytes() const;
+
+    // True if the arena is locked into RAM with mlock(2)
+    bool pinned() const;
+
+  private:
+    // Where a file's parts start in the arena while it is being filled
+    struct Extent {
+      std::size_t url = 0, url_length = 0;
+      std::size_t head = 0, head_length = 0;
+      std::size_t body = 0, body_length = 0;
+      std::string etag;
+      std::int64_t last_modified = 0;
+    };
+
+    PreloadedRoot(std::string arena, const std::vector<Extent>& extents);
+
+    // Views into arena_ for each extent
+    std::vector<File> MakeFiles(const std::vector<Extent>& extents) const;
+
+    // URLs of files_, in order
+    std::vector<std::string_view> Urls() const;
+
+    std::string arena_;
+    std::vector<File> files_;
+    PerfectHash index_;
+    bool pinned_ = false;
+};
+
+#endif  // PRELOADED_ROOT_H
@@ -2,12 +2,25 @@
 #define REAL_FILESYSTEM_HPP
 
 #include "filesystem.h"
+#include "open_file_cache.h"
+#include <memory>
 #include <string>
 #include <vector>
 #include <filesystem>
 
 class RealFileSystem : public FileSystemInterface {
 public:
+    // With a cache, open_file, stat_file and read_file reuse open
+    // descriptors, and writes through this object invalidate them
+    explicit RealFileSystem(std::shared_ptr<OpenFileCache> cache = nullptr);
+
+    // The instance every file-serving handler uses, so they all share one
+    // open file cache. Uncached until SetDefault is called.
+    static std::shared_ptr<RealFileSystem> Default();
+
+    // Replaces the default instance; call before building handlers
+    static void SetDefault(std::shared_ptr<RealFileSystem> filesystem);
+
     bool exists(const fs::path& path) const override;
     bool is_directory(const fs::path& path) const override;
     bool is_regular_file(const fs::path& path) const override;
@@ -19,6 +32,15 @@ public:
     std::vector<fs::path> directory_entries(const fs::path& path) const override;
     std::string read_file(const fs::path& path) const override;
     bool write_file(const fs::path& path, const std::string& content) const override;
+    bool write_file(const fs::path& path, std::string_view content) const override;
+    std::shared_ptr<const FileBody> open_file(const fs::path& path) const override;
+    bool stat_file(const fs::path& path, FileStat& out) const override;
+
+    // The open file cache, nullptr if there is none
+    const OpenFileCache* cache() const;
+
+private:
+    std::shared_ptr<OpenFileCache> cache_;
 };
 
 #endif // REAL_FILESYSTEM_HPP
\ No newline at end of file
@@ -1,38 +1,47 @@
 #ifndef REQUEST_H
 #define REQUEST_H
 
+#include <memory>
 #include <string>
-#include <unordered_map>
-
-// Helper function to get next line of a request string
-// Line is stored in line and remaining request in request
-static void getLine(std::string& request, std::string& line);
-
-static bool isValidMethod(const std::string& method);
-
-static bool isValidVersion(const std::string& version);
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "request_parser.h"
 
+// All accessors return views into the request text. For requests built by
+// the session that text is the session's read buffer, so a request must not
+// outlive the handling of the read it came from.
 class Request {
   public:
+    // Parses standalone text; the request keeps its own copy of it
     explicit Request(const std::string& request);
 
+    // Builds a request over text already framed by RequestParser, reusing the
+    // parsed offsets instead of scanning the text again. Nothing is copied,
+    // the caller keeps request alive for as long as the Request is used.
+    Request(std::string_view request, const RequestLayout& layout);
+
+    // A copy holding its own text, which stays valid after the buffer the
+    // request was built over changes (e.g. for handling on another thread)
+    Request Detach() const;
+
     // method getter
-    std::string get_method() const;
+    std::string_view get_method() const;
 
     // url getter
-    std::string get_url() const;
+    std::string_view get_url() const;
 
     // version getter
-    std::string get_version() const;
+    std::string_view get_version() const;
 
-    // header getter
-    std::string get_header(const std::string& header_name) const;
+    // Value of the header named header_name, matched case-insensitively
+    std::string_view get_header(std::string_view header_name) const;
 
     // body getter
-    std::string get_body() const;
+    std::string_view get_body() const;
 
     // Returns string representation of request
-    std::string to_string() const;
+    std::string_view to_string() const;
 
     // Returns true if valid request, false if not
     bool is_valid() const;
@@ -40,15 +49,26 @@ class Request {
     // Returns length of the request
     int length() const;
 
+    // Returns true if the client asked to keep the connection open. HTTP/1.1
+    // defaults to keep-alive unless "Connection: close" is sent, HTTP/1.0
+    // defaults to close unless "Connection: keep-alive" is sent.
+    bool keep_alive() const;
+
   private:  
-    std::string method_;
-    std::string url_;
-    std::string http_version_;
-    std::string body_;
-    std::unordered_map<std::string, std::string> headers_;
-    std::string raw_text_;
+    // Fills in and validates the fields described by layout
+    void Init(const RequestLayout& layout);
+
+    // Set only for standalone requests; shared so copies stay valid
+    std::shared_ptr<const std::string> owned_text_;
+    std::string_view raw_text_;
+    std::string_view method_;
+    std::string_view url_;
+    std::string_view http_version_;
+    std::string_view body_;
+    // Requests carry a handful of headers, a flat list beats hashing
+    std::vector<std::pair<std::string_view, std::string_view>> headers_;
     bool valid_request_;
     int length_;
 };
 
-#endif 
\ No newline at end of file
+#endif 
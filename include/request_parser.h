@@ -0,0 +1,113 @@
+#ifndef REQUEST_PARSER_H
+#define REQUEST_PARSER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Positions of the pieces of a request, relative to the first byte of the
+// request, so Request can be built without scanning the text again.
+struct RequestLayout {
+  struct Span {
+    std::size_t offset = 0;
+    std::size_t length = 0;
+  };
+  struct Header {
+    Span name;
+    Span value;
+  };
+
+  Span method;
+  Span url;
+  Span version;
+  std::vector<Header> headers;
+
+  // True if the request line was terminated and had exactly three tokens
+  bool request_line_ok = false;
+  // False if a header line had no colon, or Content-Length wasn't a number
+  // or was sent twice with different values
+  bool headers_ok = true;
+  // True once the blank line ending the headers has been seen
+  bool headers_complete = false;
+
+  // First byte after the blank line
+  std::size_t body_offset = 0;
+  // Parsed Content-Length, 0 if the header wasn't sent
+  std::size_t content_length = 0;
+  // True if Transfer-Encoding was sent. Chunked bodies aren't supported, so
+  // the body can't be found and Content-Length is ignored for framing.
+  bool transfer_encoding = false;
+};
+
+// Resumable request framing parser. The session feeds it the same growing
+// buffer after every read; each byte of the request line and headers is
+// examined exactly once (runs of uninteresting bytes are skipped with
+// header_scan::FindEither) and the body is skipped using Content-Length.
+class RequestParser {
+  public:
+    enum Result {
+      INCOMPLETE = 0,
+      COMPLETE = 1,
+      // The request line and headers run past kMaxHeaderBytes, whether or
+      // not their end has been seen yet
+      TOO_LARGE = 2
+    };
+
+    // Most bytes of request line and headers, blank line included, a
+    // request may have. Stray empty lines ahead of it don't count.
+    static constexpr std::size_t kMaxHeaderBytes = 16 * 1024;
+
+    // Continues scanning buf from where the previous call stopped. Bytes
+    // before that point must not have changed since then.
+    Result Parse(const std::string& buf);
+
+    // Layout of the current request, valid once Parse returns COMPLETE
+    // (partially filled in before that).
+    const RequestLayout& layout() const;
+
+    // Offset in the buffer of the first byte of the current request
+    std::size_t request_begin() const;
+
+    // Total length of the current request (headers and body; only the
+    // headers if it was sent with Transfer-Encoding)
+    std::size_t request_length() const;
+
+    // Moves on to the request following the current, complete one
+    void Next();
+
+    // Starts over at the beginning of an empty buffer, for a new connection
+    void Reset();
+
+    // Tells the parser the first n bytes were erased from the buffer
+    // (n must not exceed request_begin())
+    void Rebase(std::size_t n);
+
+  private:
+    enum State {
+      STATE_REQUEST_LINE = 0,
+      STATE_HEADER_LINE = 1,
+      STATE_BODY = 2
+    };
+
+    // Starts scanning a new request at offset begin, keeping the header
+    // vector's capacity
+    void Restart(std::size_t begin);
+
+    // Records the header line [line_start_, end) in layout_
+    void FinishHeaderLine(const std::string& buf, std::size_t end);
+
+    State state_ = STATE_REQUEST_LINE;
+    // Absolute offset of the current request and of the next unexamined byte
+    std::size_t begin_ = 0;
+    std::size_t pos_ = 0;
+    // Absolute offsets tracked while inside a line
+    std::size_t line_start_ = 0;
+    std::size_t first_space_ = std::string::npos;
+    std::size_t second_space_ = std::string::npos;
+    std::size_t extra_spaces_ = 0;
+    std::size_t colon_ = std::string::npos;
+    bool content_length_seen_ = false;
+    RequestLayout layout_;
+};
+
+#endif  // REQUEST_PARSER_H
@@ -1,35 +1,151 @@
 #ifndef RESPONSE_H
 #define RESPONSE_H
 
+#include <cstddef>
+#include <memory>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
+#include <vector>
+#include "file_body.h"
+#include "mapped_file.h"
+
+// Part of a file-backed body: literal bytes (e.g. multipart headers)
+// followed by length bytes of file starting at offset. With a mapping the
+// bytes are taken from it instead and file is unused. Members all have
+// defaults, so a slice without a mapping can leave it off.
+struct FileSlice {
+  std::string lead{};
+  std::shared_ptr<const FileBody> file{};
+  std::size_t offset = 0;
+  std::size_t length = 0;
+  std::shared_ptr<const MappedFile> mapping{};
+};
 
 class Response {
   public:
-    explicit Response(const std::string& version, 
+    explicit Response(std::string_view version, 
                       int status_code,
                       std::string content_type,
-                      int content_length,
+                      std::size_t content_length,
                       std::string connection,
                       std::string body,
                       std::string handler_type_ = "N/A");
 
-    // Returns string of response
+    // Returns string of response. A file body is read into the string, so
+    // the session writes header_string() and streams the file instead.
     std::string to_string() const;
 
+    // Status line and headers, including the blank line ending them. A 304
+    // has no body, so it gets no Content-Type or Content-Length either; an
+    // empty content type leaves out just Content-Type.
+    std::string header_string() const;
+
+    // The headers following a prebuilt head: those added with add_header,
+    // Connection and the blank line
+    std::string header_tail() const;
+
+    // Append to_string(), header_string() or header_tail() to out, so a
+    // caller reusing out's capacity serializes without allocating
+    void append_to(std::string& out) const;
+    void append_header_string(std::string& out) const;
+    void append_header_tail(std::string& out) const;
+
+    // Sends the whole file after the headers in place of the string body;
+    // Content-Length becomes the file size
+    void set_file_body(std::shared_ptr<const FileBody> file);
+
+    // Sends the whole mapped file after the headers in place of the string
+    // body; Content-Length becomes the file size
+    void set_mapped_body(std::shared_ptr<const MappedFile> mapping);
+
+    // Sends the slices and then tail after the headers in place of the
+    // string body, e.g. one range of a file or a multipart/byteranges body.
+    // Content-Length becomes the total size.
+    void set_file_slices(std::vector<FileSlice> slices, std::string tail = "");
+
+    // File of the first slice, nullptr for a string or mapped body
+    std::shared_ptr<const FileBody> get_file_body() const;
+
+    // Slices streamed after the headers, empty for a string body
+    const std::vector<FileSlice>& get_file_slices() const;
+
+    // Bytes written after the last slice
+    const std::string& get_file_tail() const;
+
+    // The string body, empty for file and shared bodies
+    const std::string& get_body() const;
+
+    // Replaces the body with a string body; Content-Length becomes its size
+    void set_body(std::string body);
+
+    // Content-Type given to the constructor
+    const std::string& get_content_type() const;
+
+    // Uses body in place of the string body without copying it (e.g. bytes
+    // held by a cache); Content-Length becomes its size
+    void set_shared_body(std::shared_ptr<const std::string> body);
+
+    // Shared body, nullptr if the response owns its body
+    const std::shared_ptr<const std::string>& get_shared_body() const;
+
+    // Sends head, a complete status line and headers up to but excluding
+    // Connection, and then body, both owned by owner (e.g. a preloaded
+    // arena), without copying them. head must carry Content-Length. With
+    // an empty head the status line and headers are built as for any other
+    // response, e.g. for a range of the body.
+    void set_prebuilt(std::shared_ptr<const void> owner, std::string_view head,
+                      std::string_view body);
+
+    // Owner of the prebuilt head and body, nullptr unless set_prebuilt was
+    // called
+    const std::shared_ptr<const void>& get_prebuilt_owner() const;
+    std::string_view get_prebuilt_head() const;
+    std::string_view get_prebuilt_body() const;
+
+    // Appends a header, sent after Content-Length and before Connection
+    void add_header(const std::string& name, const std::string& value);
+
+    // Value of a header added with add_header, "" if there is none
+    std::string get_header(const std::string& name) const;
+
+    // Replaces the value of a header added with add_header, or adds it
+    void set_header(const std::string& name, const std::string& value);
+
+    // True if a prebuilt header block replaces Content-Type/Length
+    bool has_header_block() const;
+
+    // Replaces the Content-Type and Content-Length lines with a prebuilt
+    // block of "Name: value\r\n" lines, which must include both
+    void set_header_block(std::shared_ptr<const std::string> block);
+
     // Returns status code
     int get_status_code() const;
 
     // Returns handler type
     std::string get_handler_type() const;
 
+    // Connection header getter/setter. The session overrides whatever the
+    // handler set once it has decided whether the connection stays open.
+    std::string get_connection() const;
+    void set_connection(const std::string& connection);
+
   private:  
     int status_code_;
     std::string status_line_;
     std::string content_type_;
-    int content_length_;
+    std::size_t content_length_;
     std::string connection_;
     std::string body_;
+    std::vector<FileSlice> file_slices_;
+    std::string file_tail_;
+    std::shared_ptr<const std::string> shared_body_;
+    std::shared_ptr<const std::string> header_block_;
+    std::shared_ptr<const void> prebuilt_owner_;
+    std::string_view prebuilt_head_;
+    std::string_view prebuilt_body_;
+    std::vector<std::pair<std::string, std::string>> extra_headers_;
     std::string handler_type_;
     static const std::unordered_map<int, std::string> status_messages_;
 };
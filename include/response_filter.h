@@ -0,0 +1,18 @@
+#ifndef RESPONSE_FILTER_H
+#define RESPONSE_FILTER_H
+
+#include "request.h"
+#include "response.h"
+
+// A stage the Router runs on every response of a location after its
+// handler, before the session writes it. Filters are shared by all threads
+// serving the location, so Apply must be thread-safe.
+class ResponseFilter {
+  public:
+    virtual ~ResponseFilter() {}
+
+    // Rewrites response, generated for request, in place
+    virtual void Apply(const Request& request, Response& response) const = 0;
+};
+
+#endif // RESPONSE_FILTER_H
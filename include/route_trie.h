@@ -0,0 +1,44 @@
+#ifndef ROUTE_TRIE_H
+#define ROUTE_TRIE_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Compressed radix tree of location prefixes used by Router. Prefixes only
+// match whole path segments: "/foo" matches "/foo", "/foo/bar" and
+// "/foo?x=1" but not "/foobar". Lookups don't allocate.
+class RouteTrie {
+  public:
+    RouteTrie();
+    ~RouteTrie();
+
+    // Adds a sanitized prefix ("/" or "/a/b", no trailing slash) mapping to
+    // value. Returns false and keeps the existing value if the prefix was
+    // already inserted.
+    bool Insert(std::string_view prefix, std::size_t value);
+
+    // Finds the longest prefix matching url on a segment boundary. A missing
+    // leading slash is implied. Returns false if nothing matches.
+    bool Match(std::string_view url, std::size_t& value) const;
+
+  private:
+    struct Node {
+      // Edge label from the parent, never empty except at the root
+      std::string label;
+      bool has_value = false;
+      std::size_t value = 0;
+      // Sorted by the first byte of their labels, which are all distinct
+      std::vector<std::unique_ptr<Node>> children;
+    };
+
+    // Child of node whose label starts with c, or nullptr
+    static Node* FindChild(const Node& node, char c);
+
+    // Keys are prefixes without their leading slash, so the root is "/"
+    std::unique_ptr<Node> root_;
+};
+
+#endif  // ROUTE_TRIE_H
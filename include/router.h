@@ -1,10 +1,15 @@
 #ifndef ROUTER_H
 #define ROUTER_H
 
+#include "async_request_handler.h"
 #include "request_handler.h"
 #include "request.h"
 #include "response.h"
 #include "handler_registry.h"
+#include "response_filter.h"
+#include "route_trie.h"
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <vector>
 #include <utility>
@@ -14,28 +19,74 @@ class Router {
 public:
     using Factory = HandlerRegistry::RequestHandlerFactory;
 
-    // Register a route: we store the factory + its params,
-    // but do *not* instantiate anything yet.
+    // Register a route: we store the factory + its params. A SHARED handler
+    // is instantiated here (so a bad config fails at startup), PER_THREAD
+    // handlers on each thread's first request and PER_REQUEST ones for every
+    // request. Response filters asked for by params (e.g. compress_level,
+    // see CompressionFilter) run on every response of the route. A
+    // "blocking on|off" param overrides the handler's declared blocking
+    // ("off" leaves an ASYNC handler async). Throws whatever the factory
+    // throws, or std::runtime_error for bad filter or blocking params or
+    // a SHARED ASYNC handler that isn't an AsyncRequestHandler.
     void add_route(const std::string& path_prefix,
                     Factory factory,
-                    std::unordered_map<std::string,std::string> params);
+                    std::unordered_map<std::string,std::string> params,
+                    HandlerRegistry::Sharing sharing = HandlerRegistry::PER_REQUEST,
+                    HandlerRegistry::Blocking blocking = HandlerRegistry::NON_BLOCKING);
 
     // Returns a vector of route paths
     std::vector<std::string> get_routes() const;
     
-    // Given a request, passes it to its proper handler and returns the generated response
+    // Given a request, passes it to the handler of the longest location
+    // prefix that matches the URL on a path segment boundary ("/foo"
+    // serves "/foo/bar" but not "/foobar") and returns the generated
+    // response, after the route's filters have run on it
     Response handle_request(const Request& request) const;
 
+    // Like handle_request, but lets an AsyncRequestHandler wait on io
+    // rather than block. done gets the filtered response, maybe before
+    // this returns; request must stay valid until then.
+    void async_handle_request(const Request& request, boost::asio::io_service& io,
+                              std::function<void(Response)> done) const;
+
+    // How the route request goes to runs: BLOCKING ones belong off the
+    // io_service threads, ASYNC ones are driven with async_handle_request
+    HandlerRegistry::Blocking blocking(const Request& request) const;
+
 private:
     struct RouteEntry {
         std::string prefix;
         Factory factory;
         std::unordered_map<std::string,std::string> params;
+        HandlerRegistry::Sharing sharing;
+        HandlerRegistry::Blocking blocking;
+        // The single instance of a SHARED route
+        std::shared_ptr<RequestHandler> shared;
+        // Process-wide unique key for the per-thread handler caches
+        std::uint64_t id;
+        // Run in order on each response of the route
+        std::vector<std::shared_ptr<const ResponseFilter>> filters;
     };
     // Vector containing Router object's routes, where each entry is a pair of
     // (path string, handler)
     std::vector<RouteEntry> routes_;
+    // Maps each distinct prefix to the index of its first entry in routes_
+    RouteTrie trie_;
     
+    // Expires when the router is destroyed, so threads can drop their
+    // cached PER_THREAD handlers for it
+    std::shared_ptr<int> lifetime_ = std::make_shared<int>(0);
+
+    // Runs the handler of a matched route
+    Response run_handler(const RouteEntry& entry, const Request& request) const;
+
+    // The handler instance for a matched route, shared with the caller so a
+    // PER_REQUEST one lives as long as it's needed
+    std::shared_ptr<RequestHandler> route_handler(const RouteEntry& entry) const;
+
+    // Returns the calling thread's instance for a PER_THREAD route
+    RequestHandler& thread_handler(const RouteEntry& entry) const;
+
     // Sanitizes and returns a given path, removing extraneous characters
     std::string sanitize_path(const std::string& path) const;
 };
@@ -5,14 +5,18 @@
 #include "session.h"
 #include "router.h"
 
-using SessionFactory = std::function<std::shared_ptr<session>(boost::asio::io_service&, Router&)>;
-
 class server {
 public:
+  // Listens on port and starts a session from session_factory for every
+  // connection, all on io_service. With reuse_port the listener is bound
+  // with SO_REUSEPORT, so servers on other io_services can share the port
+  // and the kernel spreads connections between them. Throws
+  // boost::system::system_error if the port can't be bound.
   server(boost::asio::io_service& io_service, 
          short port, 
          Router& router,
-         SessionFactory session_factory);
+         SessionFactory session_factory,
+         bool reuse_port = false);
 
 private:
   void start_accept();
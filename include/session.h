@@ -2,43 +2,203 @@
 #define SESSION_H
 
 #include <boost/asio.hpp>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "handler_memory.h"
+#include "response.h"
 #include "router.h"
+#include "request_parser.h"
+
+class session;
+class AsyncFileIO;
+
+using SessionFactory = std::function<std::shared_ptr<session>(boost::asio::io_service&, Router&)>;
+
+// Connection reuse settings, read from the config file
+struct SessionOptions {
+  // Seconds an idle persistent connection waits for its next request.
+  // 0 disables keep-alive entirely.
+  unsigned int keepalive_timeout = 5;
+  // Maximum number of requests served over a single connection
+  unsigned int keepalive_requests = 100;
+  // Maximum number of pipelined responses queued before the session stops
+  // parsing buffered requests and waits for the write to drain
+  std::size_t pipeline_depth = 16;
+  // Reads streamed file bodies off the io_service threads when set, in
+  // place of sendfile(2). Not owned, must outlive every session.
+  AsyncFileIO* file_io = nullptr;
+  // Runs requests for blocking routes (see HandlerRegistry::Blocking) when
+  // set, so they never hold up an io_service thread. Not owned, must
+  // outlive every session.
+  boost::asio::thread_pool* handler_pool = nullptr;
+  // Idle sessions kept per io_service for later connections (see
+  // SessionPool). 0 allocates and frees a session for every connection.
+  std::size_t session_pool = 256;
+};
 
 class session : public std::enable_shared_from_this<session> {
 public:
   static std::shared_ptr<session> MakeSession(boost::asio::io_service& io_service, Router& router);
 
+  // Returns a factory that builds sessions using the given options, reusing
+  // idle ones from the io_service's SessionPool unless options.session_pool
+  // is 0
+  static SessionFactory MakeSessionFactory(const SessionOptions& options);
+
   virtual boost::asio::ip::tcp::socket& socket();
 
   virtual void start();
 
 protected:
-  explicit session(boost::asio::io_service& io_service, Router& router);
+  friend class SessionPool;
+
+  // A serialized response waiting to be written: the header block (or the
+  // whole response), then an optional shared body or file slices and the
+  // bytes following them. A prebuilt response puts its head before data
+  // and its body after it instead, both kept alive by owner.
+  // Every member has a default initializer, so it can be built from just
+  // the leading members it needs.
+  struct OutgoingResponse {
+    std::string data{};
+    std::shared_ptr<const std::string> body{};
+    std::vector<FileSlice> slices{};
+    std::string tail{};
+    std::shared_ptr<const void> owner{};
+    std::string_view head{};
+    std::string_view prebuilt_body{};
+
+    // True if the slices are sent with sendfile(2) after the gathered
+    // write. Mapped slices are part of the gathered write itself.
+    bool streams_file() const { return !slices.empty() && !slices.front().mapping; }
+  };
+
+  explicit session(boost::asio::io_service& io_service, Router& router,
+                   const SessionOptions& options = SessionOptions());
 
   virtual void handle_read(const boost::system::error_code& error,
                   std::size_t bytes_transferred);
   
   virtual void handle_write(const boost::system::error_code& error);
 
-  // Returns true if the request in in_buf_ is complete and false otherwise
-  bool request_complete();
+  // Issues the next async read into chunk_
+  void do_read();
+
+  // Parses and dispatches every complete request in in_buf_, queueing the
+  // serialized responses until the pipeline depth is reached
+  void process_requests();
+
+  // Routes a single request and returns the serialized response
+  OutgoingResponse dispatch(const Request& request, const std::string& client_ip);
+
+  // Refuses request with status and a plain text body, then closes the
+  // connection
+  OutgoingResponse reject(const Request& request, int status, const std::string& body,
+                          const std::string& client_ip);
+
+  // Serializes the response the router gave for request, deciding whether
+  // the connection stays open
+  OutgoingResponse finish(const Request& request, Response response,
+                          const std::string& client_ip);
+
+  // Routes request on options_.handler_pool, then queues its response back
+  // on strand_ and writes it. Only called with nothing queued or being
+  // written, and reading and parsing wait for the response.
+  void offload(const Request& request, const std::string& client_ip);
+
+  // Routes request to an ASYNC route, which answers from a later handler
+  // on any io_service thread, then queues its response back on strand_
+  // and writes it. Called under the same conditions as offload.
+  void start_async(const Request& request, const std::string& client_ip);
+
+  // Queues and writes the response to the request offloaded or started
+  // asynchronously, back on strand_
+  void resume(const Request& request, Response response, const std::string& client_ip);
+
+  // Writes queued responses with a single gathered write, up to and
+  // including the headers of the first one streaming a file
+  void start_write();
+
+  // Sends file slice slice_index_ of the last response in writing_, or
+  // finishes the write once every slice has been sent
+  void continue_slices();
+
+  // Reads the next chunk of the current slice through options_.file_io,
+  // then writes it
+  void read_file_chunk();
+
+  // Streams the current slice with sendfile(2), waiting for the socket to
+  // become writable whenever it would block
+  void send_file();
+
+  // Writes the bytes between the current slice and the next one (the next
+  // part's headers, or the tail after the last slice) and moves on
+  void finish_slice();
+
+
+  // Closes the socket and returns to the state of a new session, keeping
+  // buffers unless they grew beyond max_retained_buffer, so a SessionPool
+  // can hand the session to another connection
+  void recycle();
+
+  // An empty string to serialize a response into, reusing the storage of
+  // one already written when there is one
+  std::string take_buffer();
 
   // Timer functions
-  void start_timer();
+  void start_timer(std::chrono::seconds timeout);
 
   void stop_timer();
 
   void handle_timeout(const boost::system::error_code& error);
 
+  boost::asio::io_service& io_service_;
+  // Executor of the socket and the timer, so the session's handlers never
+  // run concurrently however many threads run the io_service
+  boost::asio::strand<boost::asio::io_service::executor_type> strand_;
   boost::asio::ip::tcp::socket socket_;
   boost::asio::steady_timer timer_;
   Router& router_;
+  SessionOptions options_;
+
+  // Set once a queued response closes the connection
+  bool closing_ = false;
+  // Number of requests routed on this connection
+  unsigned int requests_dispatched_ = 0;
+  // Set while a request is being handled on options_.handler_pool or by
+  // an ASYNC route
+  bool pending_ = false;
   
   std::string in_buf_;
-  std::string out_buf_;
+  // Incremental framing state for the request at the front of in_buf_
+  RequestParser parser_;
+  // Responses waiting to be written, in request order
+  std::deque<OutgoingResponse> write_queue_;
+  // Responses owned by the in-flight gathered write
+  std::vector<OutgoingResponse> writing_;
+  // Buffers of the in-flight gathered write, kept for the next one
+  std::vector<boost::asio::const_buffer> write_buffers_;
+  // Serialized responses already written, cleared for reuse by take_buffer
+  std::vector<std::string> spare_buffers_;
+  // Completion handlers of the read and of the gathered write
+  HandlerMemory read_memory_;
+  HandlerMemory write_memory_;
+  // Progress through the file body being sent
+  std::size_t slice_index_ = 0;
+  std::size_t file_offset_ = 0;
+  std::size_t file_remaining_ = 0;
+  // Chunk of the file read through options_.file_io
+  std::vector<char> file_buf_;
   
   enum { max_length = 1024 };
+  enum { file_chunk_length = 256 * 1024 };
+  // Largest buffer a recycled session keeps
+  enum { max_retained_buffer = 64 * 1024 };
   char chunk_[max_length];
+
+  // Seconds allowed to receive the rest of a partially read request
+  enum { request_timeout = 5 };
 };
 
-#endif // SESSION_H
\ No newline at end of file
+#endif // SESSION_H
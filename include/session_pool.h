@@ -0,0 +1,63 @@
+#ifndef SESSION_POOL_H
+#define SESSION_POOL_H
+
+#include <atomic>
+#include <boost/asio.hpp>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include "session.h"
+
+class Router;
+
+// Idle sessions of one io_service, kept for reuse by later connections
+// with their grown buffers and timer instead of being freed. Installed on
+// the io_service as a service, so the pool and the sessions in it are
+// destroyed with it; in reuseport mode every thread has its own. Used by
+// session::MakeSessionFactory. Thread-safe.
+class SessionPool : public boost::asio::execution_context::service {
+  public:
+    struct Stats {
+      // Sessions allocated because none was idle
+      std::uint64_t created = 0;
+      // Sessions handed out again
+      std::uint64_t reused = 0;
+      // Sessions waiting to be reused
+      std::size_t idle = 0;
+    };
+
+    static boost::asio::execution_context::id id;
+
+    explicit SessionPool(boost::asio::execution_context& context);
+    ~SessionPool() override;
+
+    // The pool of io_service, created on first use
+    static SessionPool& Of(boost::asio::io_service& io_service);
+
+    // An idle session for router reset to its initial state, or a new one.
+    // Once the last reference is dropped it comes back here, keeping up to
+    // options.session_pool idle sessions.
+    std::shared_ptr<session> Acquire(Router& router, const SessionOptions& options);
+
+    Stats GetStats() const;
+
+  private:
+    // Deleter of acquired sessions: pools s, or deletes it if the pool is
+    // full or the io_service is shutting down
+    void Release(session* s, std::size_t limit);
+
+    void shutdown() override;
+
+    boost::asio::io_service& io_service_;
+    mutable std::mutex mutex_;
+    // Idle sessions by the router they serve
+    std::unordered_map<Router*, std::vector<std::unique_ptr<session>>> idle_;
+    std::size_t idle_count_ = 0;
+    bool shut_down_ = false;
+    std::atomic<std::uint64_t> created_{0};
+    std::atomic<std::uint64_t> reused_{0};
+};
+
+#endif  // SESSION_POOL_H
@@ -1,12 +1,14 @@
 #ifndef SLEEP_HANDLER_H
 #define SLEEP_HANDLER_H
 
-#include "request_handler.h"
+#include "async_request_handler.h"
 #include "handler_registry.h"
 #include <string>
 #include <unordered_map>
 
-class SleepHandler : public RequestHandler {
+// Answers after sleep_duration seconds on an io_service timer, so sleeping
+// requests hold no thread
+class SleepHandler : public AsyncRequestHandler {
 public:
     static constexpr char kName[] = "SleepHandler";
     
@@ -16,7 +18,8 @@ public:
     
     explicit SleepHandler(std::string location, int sleep_seconds = 5);
     
-    Response handle_request(const Request& request) override;
+    void async_handle_request(const Request& request, boost::asio::io_service& io,
+                              Callback done) override;
 
 private:
     std::string prefix_;
@@ -26,6 +29,8 @@ private:
 // Registration at init time
 inline bool _sleep_handler_registered =
     HandlerRegistry::RegisterHandler(SleepHandler::kName,
-                                     SleepHandler::Init);
+                                     SleepHandler::Init,
+                                     HandlerRegistry::SHARED,
+                                     HandlerRegistry::ASYNC);
 
 #endif  // SLEEP_HANDLER_H
\ No newline at end of file
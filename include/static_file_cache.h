@@ -0,0 +1,76 @@
+#ifndef STATIC_FILE_CACHE_H
+#define STATIC_FILE_CACHE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "file_body.h"
+
+// Thread-safe LRU of small files served by StaticHandler. Keys are resolved
+// filesystem paths; the byte budget is split evenly over independently
+// locked shards so concurrent requests for different files rarely contend.
+class StaticFileCache {
+  public:
+    // A cached file, immutable once inserted
+    struct Entry {
+      std::shared_ptr<const std::string> body;
+      std::string mime_type;
+      // "Content-Type: ...\r\nContent-Length: ...\r\n", see
+      // Response::set_header_block
+      std::shared_ptr<const std::string> headers;
+      // Metadata of the file the body was read from
+      FileStat stat;
+    };
+
+    // Counters since construction
+    struct Stats {
+      std::uint64_t hits = 0;
+      std::uint64_t misses = 0;
+      std::uint64_t evictions = 0;
+      std::size_t entries = 0;
+      std::size_t bytes = 0;
+    };
+
+    explicit StaticFileCache(std::size_t capacity_bytes, std::size_t shards = 16);
+
+    // Returns the entry for path if it was cached from a file matching
+    // current, nullptr otherwise. A stale entry is dropped.
+    std::shared_ptr<const Entry> Lookup(const std::string& path, const FileStat& current);
+
+    // Caches entry for path, evicting least recently used entries of its
+    // shard as needed. Returns false if the entry is too big to cache.
+    bool Insert(const std::string& path, std::shared_ptr<const Entry> entry);
+
+    // Largest body Insert accepts
+    std::size_t max_entry_bytes() const;
+
+    Stats GetStats() const;
+
+  private:
+    struct Shard {
+      std::mutex mutex;
+      // Most recently used at the front
+      std::list<std::pair<std::string, std::shared_ptr<const Entry>>> lru;
+      std::unordered_map<std::string, decltype(lru)::iterator> index;
+      std::size_t bytes = 0;
+    };
+
+    // Bytes an entry is charged against its shard's budget
+    static std::size_t Cost(const std::string& path, const Entry& entry);
+
+    Shard& ShardFor(const std::string& path);
+
+    std::size_t shard_capacity_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+    std::atomic<std::uint64_t> evictions_{0};
+};
+
+#endif  // STATIC_FILE_CACHE_H
@@ -3,6 +3,15 @@
 
 #include "request_handler.h"
 #include "handler_registry.h"
+#include "path_resolver.h"
+#include "filesystem.h"
+#include "content_encoding.h"
+#include "directory_listing.h"
+#include "mapped_file.h"
+#include "precompressed_index.h"
+#include "preloaded_root.h"
+#include "static_file_cache.h"
+#include <memory>
 #include <string>
 #include <filesystem>
 #include <stdexcept>
@@ -17,6 +26,22 @@ public:
   // Called by the registry to produce a configured instance.
   //  - location is the URL prefix (e.g. "/static")
   //  - params["root"] is the directory on disk
+  //  - params["cache_size_mb"] (optional) enables an in-memory cache of
+  //    small files of that many megabytes
+  //  - params["precompressed"] (optional, "on" or "off") serves foo.br,
+  //    foo.zst or foo.gz in place of foo when the client accepts it
+  //  - params["mmap"] (optional, "on" or "off") serves files from shared
+  //    memory mappings; can't be combined with cache_size_mb
+  //  - params["mmap_advice"] (optional) madvise(2) hint for new mappings:
+  //    normal (default), sequential, random or willneed
+  //  - params["preload"] (optional, "on" or "off") reads the whole root
+  //    into memory at startup and serves it with prebuilt headers; files
+  //    changed afterwards need a restart. Can't be combined with
+  //    precompressed
+  //  - params["index"] (optional) file served for directory URLs, default
+  //    index.html; "off" disables it
+  //  - params["autoindex"] (optional, "on" or "off") lists directories
+  //    without an index file
   static RequestHandler* Init(
       const std::string& location,
       const std::unordered_map<std::string, std::string>& params);
@@ -24,25 +49,82 @@ public:
 
   Response handle_request(const Request& request) override;
 
+  // The file cache, nullptr unless cache_size_mb was set
+  const StaticFileCache* cache() const;
+
+  // The sibling index, nullptr unless precompressed is on
+  const PrecompressedIndex* precompressed() const;
+
+  // The file mappings, nullptr unless mmap is on
+  const MappedFileTable* mapped() const;
+
+  // The preloaded root, nullptr unless preload is on
+  const PreloadedRoot* preloaded() const;
+
+  // The directory listings, nullptr unless autoindex is on
+  const DirectoryListingCache* listings() const;
+
 private:
-  // Each handler instance needs exactly these two pieces of information:
-  StaticHandler(std::string url_prefix, std::string filesystem_root);
+  // The file sent for a request: the requested file itself or one of its
+  // precompressed siblings
+  struct Representation {
+    std::string path;
+    FileStat stat;
+    content_encoding::Coding coding = content_encoding::IDENTITY;
+    // Other codings of the file exist, so responses carry Vary
+    bool varies = false;
+  };
+
+  // Each handler instance needs these two pieces of information, a cache
+  // budget (0 disables caching), whether to look for siblings and whether
+  // to map files or preload the root, and how directories are served:
+  StaticHandler(std::string url_prefix, std::string filesystem_root,
+                std::size_t cache_bytes = 0, bool precompressed = false,
+                bool mmap = false, MappedFile::Advice advice = MappedFile::ADVICE_NORMAL,
+                bool preload = false, std::string index = "index.html",
+                bool autoindex = false);
 
   // The mount point (prefix) we were configured with.
   std::string prefix_;
   // The absolute filesystem root we were configured with.
   std::string fs_root_;
+  // Maps URLs under prefix_ to files under fs_root_, caching the results
+  PathResolver resolver_;
+  // Opens and stats files, through the process-wide open file cache
+  std::shared_ptr<FileSystemInterface> fs_;
+  // Thread-safe, so the handler stays shareable between threads
+  std::unique_ptr<StaticFileCache> cache_;
+  std::unique_ptr<PrecompressedIndex> precompressed_;
+  std::unique_ptr<MappedFileTable> mapped_;
+  MappedFile::Advice mmap_advice_;
+  // Immutable, shared with the responses that point into it
+  std::shared_ptr<const PreloadedRoot> preloaded_;
+  // File name served for directory URLs, empty if disabled
+  std::string index_;
+  std::unique_ptr<DirectoryListingCache> listings_;
 
   // helpers
-  std::string get_extension(const std::string& path) const;
-  std::string get_mime_type(const std::string& ext) const;
   std::string resolve_path(const std::string& url_path) const;
+  std::string get_content_type(const std::string& path) const;
+  Representation choose_representation(const Request& request, const std::string& path,
+                                       const FileStat& st) const;
+  bool serve_preloaded(const Request& request, Response& response) const;
+  bool serve_directory(const Request& request, std::string& path, FileStat& st,
+                       Response& response) const;
+  bool serve_cached(const Representation& rep, const std::string& content_type,
+                    Response& response) const;
 };
 
-// one-time registration at load time:
+// one-time registration at load time. Declared non-blocking even though
+// misses stat and open files and fill the cache: hits on the preloaded,
+// mapped and cached paths make no syscalls, and a hop through the handler
+// pool would cost them more than it saves. Bodies are streamed by the
+// session either way. Routes on cold or slow disks opt in with
+// "blocking on;".
 inline bool _static_handler_registered =
     HandlerRegistry::RegisterHandler(
         StaticHandler::kName,
-        StaticHandler::Init);
+        StaticHandler::Init,
+        HandlerRegistry::SHARED);
 
 #endif  // STATIC_HANDLER_H
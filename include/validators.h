@@ -0,0 +1,39 @@
+#ifndef VALIDATORS_H
+#define VALIDATORS_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "file_body.h"
+#include "request.h"
+
+// Cache validators for file-backed responses (RFC 7232). Everything here
+// works from file metadata, so revalidating never reads file contents.
+namespace validators {
+
+    // Strong ETag built from inode, size and mtime, including the quotes
+    std::string ETag(const FileStat& stat);
+
+    // Seconds since the epoch of the file's mtime, as sent in Last-Modified
+    std::int64_t LastModified(const FileStat& stat);
+
+    // Formats seconds since the epoch as an IMF-fixdate
+    // ("Sun, 06 Nov 1994 08:49:37 GMT")
+    std::string HttpDate(std::int64_t seconds);
+
+    // Parses an IMF-fixdate. Returns false for anything else.
+    bool ParseHttpDate(std::string_view text, std::int64_t& seconds);
+
+    // True if a GET or HEAD request's If-None-Match or (when that is absent)
+    // If-Modified-Since shows the client already has this version
+    bool IsNotModified(const Request& request, std::string_view etag,
+                       std::int64_t last_modified);
+
+    // True if a Range header may be honoured: there is no If-Range, or it
+    // names this version by strong ETag or exact Last-Modified date
+    bool IfRangeMatches(const Request& request, std::string_view etag,
+                        std::int64_t last_modified);
+
+}  // namespace validators
+
+#endif  // VALIDATORS_H
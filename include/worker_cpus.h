@@ -0,0 +1,40 @@
+#ifndef WORKER_CPUS_H
+#define WORKER_CPUS_H
+
+#include <string>
+#include <vector>
+
+// CPUs available to the io_service worker threads, and pinning and naming
+// those threads (see the worker_threads and worker_cpu_affinity
+// directives)
+namespace worker_cpus {
+
+    // CPUs this process may use: the CPUs in its affinity mask (cpusets,
+    // taskset), further limited by a cgroup CPU quota (docker --cpus), which
+    // std::thread::hardware_concurrency() ignores. At least 1.
+    unsigned int Available();
+
+    // CPU quota of the cgroup mounted at root, in CPUs (1.5 for "150000
+    // 100000"), read from cgroup v2 cpu.max or v1 cpu/cpu.cfs_quota_us.
+    // 0 if there is no quota or it can't be read.
+    double CgroupQuota(const std::string& root = "/sys/fs/cgroup");
+
+    // The CPUs this process may run on, in ascending order
+    std::vector<unsigned int> Allowed();
+
+    // CPUs set in a worker_cpu_affinity bitmask, the rightmost digit being
+    // CPU 0 ("0101" is CPUs 0 and 2). Empty if mask isn't made of 0s and 1s
+    // or sets no CPU.
+    std::vector<unsigned int> FromMask(const std::string& mask);
+
+    // Restricts the calling thread to cpus. Returns false if the kernel
+    // refuses, e.g. for CPUs outside the process's cpuset.
+    bool PinCurrentThread(const std::vector<unsigned int>& cpus);
+
+    // Names the calling thread as shown by top -H and ps -L, truncated to
+    // the kernel's 15 characters
+    void NameCurrentThread(const std::string& name);
+
+}  // namespace worker_cpus
+
+#endif  // WORKER_CPUS_H
@@ -21,12 +21,17 @@
 #include "router.h"
 #include "echo_handler.h"
 #include "static_handler.h"
+#include "embedded_static_handler.h"
 #include "crud_api_handler.h"
 #include "not_found_handler.h"
 #include "sleep_handler.h"
 #include "health_handler.h"
 #include "markdown_handler.h"
 #include "handler_registry.h"
+#include "async_file_io.h"
+#include "open_file_cache.h"
+#include "real_filesystem.h"
+#include "worker_cpus.h"
 
 using boost::asio::ip::tcp;
 
@@ -65,6 +70,82 @@ int main(int argc, char* argv[]) {
       return 1;
     }
 
+    // Optional directives keep their defaults when missing, but one that is
+    // present and invalid stops startup rather than being ignored
+    auto invalid = [&config](const std::string& name, bool extracted) {
+      if (extracted || !config.HasDirective(name)) return false;
+      std::cerr << "Invalid \"" << name << "\" directive\n";
+      Logger::log_error("Invalid \"" + name + "\" directive in config");
+      return true;
+    };
+
+    /* ───────────── Extract keep-alive settings ── */
+    // Both directives are optional; SessionOptions holds the defaults
+    SessionOptions session_options;
+    if (invalid("keepalive_timeout",
+                config.ExtractKeepaliveTimeout(session_options.keepalive_timeout)) ||
+        invalid("keepalive_requests",
+                config.ExtractKeepaliveRequests(session_options.keepalive_requests))) {
+      return 1;
+    }
+    Logger::log_info(
+      "Keep-alive timeout " + std::to_string(session_options.keepalive_timeout) +
+      "s, max " + std::to_string(session_options.keepalive_requests) +
+      " requests per connection");
+
+    /* ───────────── Session pool ──────────────── */
+    // Each io_service keeps up to "session_pool <num>;" idle sessions
+    // (default 256) for later connections; 0 frees them instead
+    unsigned int session_pool = static_cast<unsigned int>(session_options.session_pool);
+    if (invalid("session_pool", config.ExtractSessionPool(session_pool))) return 1;
+    session_options.session_pool = session_pool;
+
+    /* ───────────── Asynchronous file I/O ─────── */
+    // "aio on;" reads streamed files through io_uring (or a thread pool if
+    // the kernel refuses it), "aio threads;" always uses the pool. Built
+    // once the io_service exists.
+    std::string aio_mode = "off";
+    unsigned int aio_threads = 4;
+    if (invalid("aio", config.ExtractAio(aio_mode)) ||
+        invalid("aio_threads", config.ExtractAioThreads(aio_threads))) {
+      return 1;
+    }
+
+    /* ───────────── Blocking handlers ──────────── */
+    // Requests for blocking routes run on a pool of "handler_threads <num>;"
+    // threads (default 8); 0 runs them on the io_service threads
+    unsigned int handler_threads = 8;
+    if (invalid("handler_threads", config.ExtractHandlerThreads(handler_threads))) return 1;
+    std::unique_ptr<boost::asio::thread_pool> handler_pool;
+    if (handler_threads > 0) {
+      handler_pool = std::make_unique<boost::asio::thread_pool>(handler_threads);
+      session_options.handler_pool = handler_pool.get();
+      Logger::log_info("Running blocking handlers on " + std::to_string(handler_threads) +
+                       " threads");
+    }
+
+    /* ───────────── Open file cache ────────────── */
+    // Off unless "open_file_cache <num>;" is set. Handlers built below pick
+    // up the default filesystem, so it has to be in place before them.
+    OpenFileCacheOptions open_file_options;
+    unsigned int open_files = 0;
+    if (invalid("open_file_cache", config.ExtractOpenFileCache(open_files)) ||
+        invalid("open_file_cache_inactive",
+                config.ExtractOpenFileCacheInactive(open_file_options.inactive_seconds)) ||
+        invalid("open_file_cache_valid",
+                config.ExtractOpenFileCacheValid(open_file_options.valid_seconds))) {
+      return 1;
+    }
+    if (open_files > 0) {
+      open_file_options.max_entries = open_files;
+      RealFileSystem::SetDefault(std::make_shared<RealFileSystem>(
+        std::make_shared<OpenFileCache>(open_file_options)));
+      Logger::log_info(
+        "Open file cache of " + std::to_string(open_files) + " files, inactive after " +
+        std::to_string(open_file_options.inactive_seconds) + "s, revalidated every " +
+        std::to_string(open_file_options.valid_seconds) + "s");
+    }
+
     /* ───────────── Extract routes ─────────────── */
     std::vector<NginxConfig::RouteConfig> routes;
     if (!config.ExtractRoutes(routes)) {
@@ -96,12 +177,23 @@ int main(int argc, char* argv[]) {
         return HandlerRegistry::CreateHandler(name, loc, prms);
       };
 
-      // Register it with the router, deferring actual instantiation
-      router.add_route(
-        route.path,
-        factory,
-        route.params
-      );
+      // Register it with the router; the handler's declared sharing decides
+      // whether it's built now, once per thread or for every request, and its
+      // declared blocking whether it runs on the handler pool or
+      // asynchronously on the io_service
+      try {
+        router.add_route(
+          route.path,
+          factory,
+          route.params,
+          HandlerRegistry::GetSharing(route.handler_type),
+          HandlerRegistry::GetBlocking(route.handler_type)
+        );
+      } catch (const std::exception& e) {
+        Logger::log_error("Failed to instantiate handler '" + route.handler_type +
+                          "' for location '" + route.path + "': " + e.what());
+        return 1;
+      }
     }
     /* ───────────── Start server ───────────────── */
     Logger::log_server_startup(port);
@@ -112,38 +204,111 @@ int main(int argc, char* argv[]) {
       std::_Exit(0);
     });
 
-    // Initialize io_service
-    boost::asio::io_service io_service;
+    /* ───────────── Worker threads ───────────── */
+    // "worker_threads <num>;" io_service threads, by default (or with
+    // "auto") one per CPU the process may use, counting cpusets and cgroup
+    // quotas. "worker_cpu_affinity auto;" pins thread i to the i-th allowed
+    // CPU, "worker_cpu_affinity <mask> ...;" to the CPUs of the i-th mask.
+    unsigned int num_threads = 0;
+    std::vector<std::string> affinity;
+    if (invalid("worker_threads", config.ExtractWorkerThreads(num_threads)) ||
+        invalid("worker_cpu_affinity", config.ExtractWorkerCpuAffinity(affinity))) {
+      return 1;
+    }
+    if (num_threads == 0) num_threads = worker_cpus::Available();
+    std::vector<std::vector<unsigned int>> mask_cpus;
+    for (const auto& mask : affinity) {
+      if (mask == "auto") continue;
+      mask_cpus.push_back(worker_cpus::FromMask(mask));
+      // Longer than any cpu_set_t can hold
+      if (mask_cpus.back().empty() && invalid("worker_cpu_affinity", false)) return 1;
+    }
+    std::vector<std::vector<unsigned int>> thread_cpus;
+    if (!affinity.empty()) {
+      std::vector<unsigned int> allowed = worker_cpus::Allowed();
+      for (unsigned int i = 0; i < num_threads; ++i) {
+        if (mask_cpus.empty()) {
+          if (!allowed.empty()) thread_cpus.push_back({allowed[i % allowed.size()]});
+        } else {
+          thread_cpus.push_back(mask_cpus[i % mask_cpus.size()]);
+        }
+      }
+    }
+
+    // Names worker i for top -H and pins it if asked to
+    auto start_worker = [&thread_cpus](unsigned int i) {
+      worker_cpus::NameCurrentThread("worker-" + std::to_string(i));
+      if (i < thread_cpus.size() && !worker_cpus::PinCurrentThread(thread_cpus[i])) {
+        Logger::log_warning("Could not pin worker " + std::to_string(i) +
+                            " to the CPUs of worker_cpu_affinity");
+      }
+    };
+
+    /* ───────────── Reactors ──────────────────── */
+    // By default every thread runs one shared io_service behind a single
+    // listener. "reuseport on;" gives each thread its own io_service and
+    // SO_REUSEPORT listener instead: the kernel spreads connections across
+    // them and a session never leaves the thread that accepted it.
+    bool reuse_port = false;
+    if (invalid("reuseport", config.ExtractReusePort(reuse_port))) return 1;
+    std::vector<std::unique_ptr<boost::asio::io_service>> io_services;
+    for (unsigned int i = 0; i < (reuse_port ? num_threads : 1); ++i) {
+        io_services.push_back(std::make_unique<boost::asio::io_service>());
+    }
+    boost::asio::io_service& io_service = *io_services.front();
 
     // Clean shutdown on SIGINT / SIGTERM
     boost::asio::signal_set signals(io_service, SIGINT, SIGTERM);
     signals.async_wait([&](auto, auto) {
       Logger::log_server_shutdown();
-      io_service.stop();
+      for (auto& io : io_services) io->stop();
     });
 
-    server srv(io_service, port, router, session::MakeSession);
+    // File I/O completions run on the io_service that asked for them, so
+    // each one gets its own backend
+    std::vector<std::unique_ptr<AsyncFileIO>> file_ios;
+    std::vector<std::unique_ptr<server>> servers;
+    for (auto& io : io_services) {
+        SessionOptions options = session_options;
+        if (aio_mode != "off") {
+            file_ios.push_back(AsyncFileIO::Create(*io, aio_mode == "on", aio_threads));
+            options.file_io = file_ios.back().get();
+        }
+        servers.push_back(std::make_unique<server>(
+            *io, port, router, session::MakeSessionFactory(options), reuse_port));
+    }
+    if (!file_ios.empty()) {
+        Logger::log_info(std::string("Streaming files with ") +
+                         (file_ios.front()->backend() == AsyncFileIO::BACKEND_URING
+                            ? "io_uring" : std::to_string(aio_threads) + " file I/O threads") +
+                         (reuse_port ? " per io_service" : ""));
+    }
 
     std::cout << "Server running on port " << port << "\n";
     
-    // Running the io_service with multiple threads
-    const unsigned int num_threads = std::max(2u, std::thread::hardware_concurrency());
-    Logger::log_info("Starting server with " + std::to_string(num_threads) + " threads");
+    // Running the io_services with multiple threads
+    Logger::log_info("Starting server with " + std::to_string(num_threads) + " threads" +
+                     (reuse_port ? ", one io_service and listener each" : "") +
+                     (thread_cpus.empty() ? "" : ", pinned to CPUs"));
     
     std::vector<std::thread> threads;
     
-    // Creates worker threads (leaving one for main thread)
-    for (unsigned int i = 0; i < num_threads - 1; ++i) {
-        threads.emplace_back([&io_service]() {
+    // Creates worker threads (leaving one for main thread), each running
+    // its own io_service with reuseport or the shared one otherwise
+    for (unsigned int i = 1; i < num_threads; ++i) {
+        boost::asio::io_service& io = *io_services[reuse_port ? i : 0];
+        threads.emplace_back([&io, &start_worker, i]() {
+            start_worker(i);
             try {
-                io_service.run();
+                io.run();
             } catch (const std::exception& e) {
                 Logger::log_error("Worker thread exception: " + std::string(e.what()));
             }
         });
     }
     
-    // Running io_service in main thread as well
+    // Running the first io_service in main thread as well
+    start_worker(0);
     try {
         io_service.run();
     } catch (const std::exception& e) {
@@ -156,6 +321,12 @@ int main(int argc, char* argv[]) {
             thread.join();
         }
     }
+    // Handlers still running post their responses to the stopped
+    // io_services, which must outlive them
+    if (handler_pool) {
+        handler_pool->stop();
+        handler_pool->join();
+    }
   }
   catch (const std::exception& e) {
     std::cerr << "Exception: " << e.what() << "\n";
@@ -0,0 +1,428 @@
+#include "async_file_io.h"
+#include "logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <deque>
+#include <linux/io_uring.h>
+#include <mutex>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+
+static boost::system::error_code errnoCode(int err) {
+  return boost::system::error_code(err, boost::system::system_category());
+}
+
+// Blocking read of up to length bytes at offset, retried on EINTR.
+// Returns the bytes read or -errno.
+static ssize_t readAt(int fd, char* buffer, std::size_t length, std::size_t offset) {
+  for (;;) {
+    ssize_t n = ::pread(fd, buffer, length, static_cast<off_t>(offset));
+    if (n >= 0 || errno != EINTR) return n < 0 ? -errno : n;
+  }
+}
+
+// Blocking calls on a thread pool, for kernels (or sandboxes) without
+// io_uring
+class ThreadPoolFileIO : public AsyncFileIO {
+  public:
+    ThreadPoolFileIO(boost::asio::io_service& io_service, std::size_t threads)
+      : io_service_(io_service), pool_(std::max<std::size_t>(threads, 1)) {}
+
+    ~ThreadPoolFileIO() override { pool_.join(); }
+
+    void Read(std::shared_ptr<const FileBody> file, std::size_t offset, char* buffer,
+              std::size_t length, ReadCallback callback) override {
+      boost::asio::io_service& io = io_service_;
+      boost::asio::post(pool_, [&io, file = std::move(file), offset, buffer, length,
+                                callback = std::move(callback)]() mutable {
+        ssize_t n = readAt(file->fd(), buffer, length, offset);
+        boost::asio::post(io, [n, callback = std::move(callback)] {
+          if (n < 0) callback(errnoCode(static_cast<int>(-n)), 0);
+          else callback(boost::system::error_code(), static_cast<std::size_t>(n));
+        });
+      });
+    }
+
+    Backend backend() const override { return BACKEND_THREADS; }
+
+  private:
+    boost::asio::io_service& io_service_;
+    boost::asio::thread_pool pool_;
+};
+
+// An io_uring instance driven without liburing. Submissions come from any
+// thread; completions are signalled through an eventfd read by the
+// io_service, so callbacks run on its threads. Held by shared_ptr so a
+// pending eventfd read can't outlive it.
+class UringRing : public std::enable_shared_from_this<UringRing> {
+  public:
+    // Sets up a ring of the given size, nullptr if the kernel refuses or
+    // lacks an operation used here
+    static std::shared_ptr<UringRing> Create(boost::asio::io_service& io_service,
+                                             unsigned entries);
+
+    ~UringRing();
+
+    // Starts waiting for completions
+    void Start();
+
+    // Stops delivering completions; the ring is torn down once the pending
+    // eventfd read has been cancelled
+    void Stop();
+
+    void Read(std::shared_ptr<const FileBody> file, std::size_t offset, char* buffer,
+              std::size_t length, AsyncFileIO::ReadCallback callback);
+
+  private:
+    // One read in flight
+    struct Op {
+      std::shared_ptr<const FileBody> file;
+      char* buffer = nullptr;
+      std::size_t offset = 0;
+      std::size_t length = 0;
+      AsyncFileIO::ReadCallback on_read;
+    };
+
+    UringRing(boost::asio::io_service& io_service, int ring_fd, int event_fd);
+
+    // Maps the submission and completion rings described by params
+    bool MapRings(const io_uring_params& params);
+
+    // Submits op, or leaves it waiting while the ring is full
+    void Enqueue(Op* op);
+
+    // Submits waiting reads for as long as the ring has room
+    void SubmitWaiting();
+
+    // Fills an SQE for op and submits it, with sq_mutex_ held. Returns
+    // false, leaving op untouched, if that failed.
+    bool Submit(Op* op);
+
+    // True if a failed submission can be retried once a read in flight
+    // completes
+    bool CanRetry(int error) const;
+
+    // Ends op after its read finished with result
+    void Complete(Op* op, int result);
+
+    // Ends op, calling its callback if deliver
+    void Finish(Op* op, int error, std::size_t bytes, bool deliver);
+
+    // Takes every available completion off the ring
+    std::vector<std::pair<Op*, int>> Reap();
+
+    void WaitForEvents();
+
+    boost::asio::io_service& io_service_;
+    int ring_fd_;
+    boost::asio::posix::stream_descriptor event_;
+    std::uint64_t event_count_ = 0;
+    std::atomic<bool> stopped_{false};
+    std::atomic<std::size_t> in_flight_{0};
+
+    std::mutex sq_mutex_;
+    // Reads not yet submitted because sq_entries_ were already in flight;
+    // more would overflow the completion ring
+    std::deque<Op*> waiting_;
+    void* sq_ring_ = MAP_FAILED;
+    std::size_t sq_ring_size_ = 0;
+    void* cq_ring_ = MAP_FAILED;
+    std::size_t cq_ring_size_ = 0;
+    io_uring_sqe* sqes_ = static_cast<io_uring_sqe*>(MAP_FAILED);
+    std::size_t sqes_size_ = 0;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned sq_entries_ = 0;
+    unsigned* sq_array_ = nullptr;
+
+    std::mutex cq_mutex_;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    io_uring_cqe* cqes_ = nullptr;
+};
+
+static int uringSetup(unsigned entries, io_uring_params* params) {
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+static int uringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return static_cast<int>(
+      ::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+static int uringRegister(int fd, unsigned opcode, void* arg, unsigned nr_args) {
+  return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+// True if the ring supports every operation used here
+static bool uringSupportsOps(int ring_fd) {
+  std::vector<char> storage(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+  auto* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+  if (uringRegister(ring_fd, IORING_REGISTER_PROBE, probe, 256) < 0) return false;
+  return IORING_OP_READ <= probe->last_op &&
+         (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+}
+
+template <typename T>
+static T* ringField(void* ring, unsigned offset) {
+  return reinterpret_cast<T*>(static_cast<char*>(ring) + offset);
+}
+
+std::shared_ptr<UringRing> UringRing::Create(boost::asio::io_service& io_service,
+                                             unsigned entries) {
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  int ring_fd = uringSetup(entries, &params);
+  if (ring_fd < 0) return nullptr;
+  if (!uringSupportsOps(ring_fd)) {
+    ::close(ring_fd);
+    return nullptr;
+  }
+
+  int event_fd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+  if (event_fd < 0) {
+    ::close(ring_fd);
+    return nullptr;
+  }
+  // From here on the ring and the eventfd are owned by the object
+  std::shared_ptr<UringRing> ring(new UringRing(io_service, ring_fd, event_fd));
+  if (!ring->MapRings(params) ||
+      uringRegister(ring_fd, IORING_REGISTER_EVENTFD, &event_fd, 1) < 0) {
+    return nullptr;
+  }
+  return ring;
+}
+
+UringRing::UringRing(boost::asio::io_service& io_service, int ring_fd, int event_fd)
+  : io_service_(io_service), ring_fd_(ring_fd), event_(io_service, event_fd) {}
+
+bool UringRing::MapRings(const io_uring_params& params) {
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single) sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+
+  sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                    ring_fd_, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) return false;
+  if (single) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) return false;
+  }
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void* sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_fd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) return false;
+  sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+  sq_head_ = ringField<unsigned>(sq_ring_, params.sq_off.head);
+  sq_tail_ = ringField<unsigned>(sq_ring_, params.sq_off.tail);
+  sq_mask_ = *ringField<unsigned>(sq_ring_, params.sq_off.ring_mask);
+  sq_entries_ = *ringField<unsigned>(sq_ring_, params.sq_off.ring_entries);
+  sq_array_ = ringField<unsigned>(sq_ring_, params.sq_off.array);
+  cq_head_ = ringField<unsigned>(cq_ring_, params.cq_off.head);
+  cq_tail_ = ringField<unsigned>(cq_ring_, params.cq_off.tail);
+  cq_mask_ = *ringField<unsigned>(cq_ring_, params.cq_off.ring_mask);
+  cqes_ = ringField<io_uring_cqe>(cq_ring_, params.cq_off.cqes);
+  return true;
+}
+
+UringRing::~UringRing() {
+  for (Op* op : waiting_) Finish(op, ECANCELED, 0, false);
+  // Nobody delivers completions any more; wait out what the kernel still
+  // holds so it doesn't write into freed buffers
+  while (in_flight_ > 0 && cq_head_) {
+    if (uringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) break;
+    for (const auto& done : Reap()) Finish(done.first, ECANCELED, 0, false);
+  }
+  if (sqes_ != MAP_FAILED) ::munmap(sqes_, sqes_size_);
+  if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) ::munmap(cq_ring_, cq_ring_size_);
+  if (sq_ring_ != MAP_FAILED) ::munmap(sq_ring_, sq_ring_size_);
+  ::close(ring_fd_);
+}
+
+void UringRing::Start() { WaitForEvents(); }
+
+void UringRing::Stop() {
+  stopped_ = true;
+  boost::system::error_code ec;
+  event_.cancel(ec);
+}
+
+void UringRing::WaitForEvents() {
+  auto self = shared_from_this();
+  event_.async_read_some(
+      boost::asio::buffer(&event_count_, sizeof(event_count_)),
+      [self](const boost::system::error_code& err, std::size_t) {
+        if (self->stopped_) return;
+        if (err) {
+          Logger::log_error("io_uring eventfd read failed: " + err.message());
+          return;
+        }
+        for (const auto& done : self->Reap()) self->Complete(done.first, done.second);
+        self->SubmitWaiting();
+        self->WaitForEvents();
+      });
+}
+
+std::vector<std::pair<UringRing::Op*, int>> UringRing::Reap() {
+  std::vector<std::pair<Op*, int>> done;
+  std::lock_guard<std::mutex> lock(cq_mutex_);
+  unsigned head = *cq_head_;
+  unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  for (; head != tail; ++head) {
+    const io_uring_cqe& cqe = cqes_[head & cq_mask_];
+    done.emplace_back(reinterpret_cast<Op*>(static_cast<std::uintptr_t>(cqe.user_data)),
+                      cqe.res);
+    --in_flight_;
+  }
+  __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  return done;
+}
+
+void UringRing::Enqueue(Op* op) {
+  int error;
+  {
+    std::lock_guard<std::mutex> lock(sq_mutex_);
+    // Behind any read already waiting, so reads go out in order
+    if (!waiting_.empty() || in_flight_ >= sq_entries_) {
+      waiting_.push_back(op);
+      return;
+    }
+    if (Submit(op)) return;
+    error = errno;
+    if (CanRetry(error)) {
+      waiting_.push_back(op);
+      return;
+    }
+  }
+  boost::asio::post(io_service_, [op, error] {
+    op->on_read(errnoCode(error), 0);
+    delete op;
+  });
+}
+
+void UringRing::SubmitWaiting() {
+  std::vector<std::pair<Op*, int>> failed;
+  {
+    std::lock_guard<std::mutex> lock(sq_mutex_);
+    while (!waiting_.empty() && in_flight_ < sq_entries_) {
+      Op* op = waiting_.front();
+      if (!Submit(op)) {
+        int error = errno;
+        if (CanRetry(error)) break;
+        failed.emplace_back(op, error);
+      }
+      waiting_.pop_front();
+    }
+  }
+  // Outside the lock, the callbacks may start further reads
+  for (const auto& f : failed) Finish(f.first, f.second, 0, true);
+}
+
+bool UringRing::CanRetry(int error) const {
+  // The kernel refuses submissions while completions back up; one still in
+  // flight will wake WaitForEvents, which tries again
+  return (error == EBUSY || error == EAGAIN) && in_flight_ > 0;
+}
+
+bool UringRing::Submit(Op* op) {
+  unsigned tail = *sq_tail_;
+  unsigned head = __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  if (tail - head >= sq_entries_) {
+    errno = EBUSY;
+    return false;
+  }
+
+  unsigned index = tail & sq_mask_;
+  io_uring_sqe& sqe = sqes_[index];
+  std::memset(&sqe, 0, sizeof(sqe));
+  sqe.user_data = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(op));
+  sqe.opcode = IORING_OP_READ;
+  sqe.fd = op->file->fd();
+  sqe.addr = reinterpret_cast<std::uintptr_t>(op->buffer);
+  sqe.len = static_cast<unsigned>(std::min<std::size_t>(op->length, INT_MAX));
+  sqe.off = op->offset;
+  sq_array_[index] = index;
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+  // Also flushes anything an earlier failed enter left in the ring
+  unsigned pending = tail + 1 - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+  int submitted;
+  do {
+    submitted = uringEnter(ring_fd_, pending, 0, 0);
+  } while (submitted < 0 && errno == EINTR);
+  if (submitted < 0 && __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) == head) {
+    // Nothing was consumed, so this entry can be taken back
+    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+    return false;
+  }
+  ++in_flight_;
+  return true;
+}
+
+void UringRing::Read(std::shared_ptr<const FileBody> file, std::size_t offset, char* buffer,
+                     std::size_t length, AsyncFileIO::ReadCallback callback) {
+  Op* op = new Op;
+  op->file = std::move(file);
+  op->buffer = buffer;
+  op->offset = offset;
+  op->length = length;
+  op->on_read = std::move(callback);
+  Enqueue(op);
+}
+
+void UringRing::Complete(Op* op, int result) {
+  if (result < 0) Finish(op, -result, 0, true);
+  else Finish(op, 0, static_cast<std::size_t>(result), true);
+}
+
+void UringRing::Finish(Op* op, int error, std::size_t bytes, bool deliver) {
+  if (deliver) op->on_read(error ? errnoCode(error) : boost::system::error_code(), bytes);
+  delete op;
+}
+
+// Owns a UringRing for as long as the ring's completions are delivered
+class UringFileIO : public AsyncFileIO {
+  public:
+    explicit UringFileIO(std::shared_ptr<UringRing> ring) : ring_(std::move(ring)) {
+      ring_->Start();
+    }
+
+    ~UringFileIO() override { ring_->Stop(); }
+
+    void Read(std::shared_ptr<const FileBody> file, std::size_t offset, char* buffer,
+              std::size_t length, ReadCallback callback) override {
+      ring_->Read(std::move(file), offset, buffer, length, std::move(callback));
+    }
+
+    Backend backend() const override { return BACKEND_URING; }
+
+  private:
+    std::shared_ptr<UringRing> ring_;
+};
+
+std::unique_ptr<AsyncFileIO> AsyncFileIO::Create(boost::asio::io_service& io_service,
+                                                 bool allow_uring, std::size_t threads,
+                                                 unsigned uring_entries) {
+  if (allow_uring) {
+    if (auto ring = UringRing::Create(io_service, uring_entries)) {
+      return std::make_unique<UringFileIO>(std::move(ring));
+    }
+    Logger::log_warning("io_uring unavailable, falling back to " + std::to_string(threads) +
+                        " file I/O threads");
+  }
+  return std::make_unique<ThreadPoolFileIO>(io_service, threads);
+}
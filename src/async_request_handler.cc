@@ -0,0 +1,17 @@
+#include "async_request_handler.h"
+
+#include <memory>
+
+Response AsyncRequestHandler::handle_request(const Request& request) {
+  boost::asio::io_service io;
+  std::unique_ptr<Response> response;
+  async_handle_request(request, io, [&response](Response r) {
+    response = std::make_unique<Response>(std::move(r));
+  });
+  io.run();
+  if (!response) {
+    std::string body = "500 Internal Server Error";
+    return Response(request.get_version(), 500, "text/plain", body.size(), "close", body);
+  }
+  return std::move(*response);
+}
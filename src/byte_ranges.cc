@@ -0,0 +1,97 @@
+#include "byte_ranges.h"
+
+#include <cctype>
+#include <limits>
+
+namespace byte_ranges {
+
+static std::string_view trim(std::string_view s) {
+  while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+  while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+  return s;
+}
+
+// Parses a non-empty run of digits, failing on overflow
+static bool parseNumber(std::string_view text, std::size_t& out) {
+  if (text.empty()) return false;
+  out = 0;
+  for (char c : text) {
+    if (c < '0' || c > '9') return false;
+    std::size_t digit = static_cast<std::size_t>(c - '0');
+    if (out > (std::numeric_limits<std::size_t>::max() - digit) / 10) return false;
+    out = out * 10 + digit;
+  }
+  return true;
+}
+
+static bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+  if (a.size() != b.size()) return false;
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    if (std::tolower(static_cast<unsigned char>(a[i])) !=
+        std::tolower(static_cast<unsigned char>(b[i]))) return false;
+  }
+  return true;
+}
+
+Result Parse(std::string_view header, std::size_t size, std::vector<Range>& out) {
+  header = trim(header);
+  std::size_t eq = header.find('=');
+  if (eq == std::string_view::npos || !equalsIgnoreCase(trim(header.substr(0, eq)), "bytes")) {
+    return RANGE_NONE;
+  }
+
+  std::vector<Range> ranges;
+  std::size_t specs = 0;
+  std::string_view list = header.substr(eq + 1);
+  while (true) {
+    std::size_t comma = list.find(',');
+    std::string_view spec = trim(list.substr(0, comma));
+    // Empty list elements are allowed ("bytes=0-1,,5-6")
+    if (!spec.empty()) {
+      if (++specs > kMaxRanges) return RANGE_NONE;
+      std::size_t dash = spec.find('-');
+      if (dash == std::string_view::npos) return RANGE_NONE;
+      std::string_view first_text = spec.substr(0, dash);
+      std::string_view last_text = spec.substr(dash + 1);
+
+      std::size_t first, last;
+      if (first_text.empty()) {
+        // Suffix range: the final N bytes
+        if (!parseNumber(last_text, last)) return RANGE_NONE;
+        if (last > 0 && size > 0) {
+          std::size_t length = last < size ? last : size;
+          ranges.push_back(Range{size - length, length});
+        }
+      } else {
+        if (!parseNumber(first_text, first)) return RANGE_NONE;
+        if (last_text.empty()) {
+          last = size > 0 ? size - 1 : 0;
+        } else if (!parseNumber(last_text, last) || last < first) {
+          return RANGE_NONE;
+        }
+        if (first < size) {
+          if (last >= size) last = size - 1;
+          ranges.push_back(Range{first, last - first + 1});
+        }
+      }
+    }
+    if (comma == std::string_view::npos) break;
+    list.remove_prefix(comma + 1);
+  }
+
+  if (specs == 0) return RANGE_NONE;
+  if (ranges.empty()) return RANGE_UNSATISFIABLE;
+  out.insert(out.end(), ranges.begin(), ranges.end());
+  return RANGE_SATISFIABLE;
+}
+
+std::string ContentRange(const Range& range, std::size_t size) {
+  return "bytes " + std::to_string(range.first) + "-" +
+         std::to_string(range.first + range.length - 1) + "/" + std::to_string(size);
+}
+
+std::string UnsatisfiedRange(std::size_t size) {
+  return "bytes */" + std::to_string(size);
+}
+
+}  // namespace byte_ranges
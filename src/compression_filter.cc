@@ -0,0 +1,152 @@
+#include "compression_filter.h"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include "logger.h"
+
+// Parses a config value of at most max_digits digits
+static bool parseUnsigned(const std::string& value, std::size_t max_digits, std::size_t& out) {
+  if (value.empty() || value.size() > max_digits ||
+      !std::all_of(value.begin(), value.end(), [](unsigned char c) { return std::isdigit(c); })) {
+    return false;
+  }
+  out = std::stoul(value);
+  return true;
+}
+
+std::unique_ptr<CompressionFilter> CompressionFilter::FromParams(
+    const std::string& location,
+    const std::unordered_map<std::string, std::string>& params) {
+  auto level_it = params.find("compress_level");
+  if (level_it == params.end()) return nullptr;
+  std::size_t level = 0;
+  if (!parseUnsigned(level_it->second, 1, level)) {
+    throw std::runtime_error("'compress_level' must be 0-9 for location " + location);
+  }
+  if (level == 0) return nullptr;
+
+  std::size_t min_length = 256;
+  auto min_it = params.find("compress_min_length");
+  if (min_it != params.end() && !parseUnsigned(min_it->second, 9, min_length)) {
+    throw std::runtime_error("'compress_min_length' must be a number for location " + location);
+  }
+
+  Logger::log_info("Compressing responses at level " + level_it->second + " for location " +
+                   location);
+  return std::make_unique<CompressionFilter>(static_cast<int>(level), min_length);
+}
+
+CompressionFilter::CompressionFilter(int level, std::size_t min_length,
+                                     std::size_t cache_capacity)
+  : level_(level), min_length_(min_length), cache_capacity_(cache_capacity) {}
+
+bool CompressionFilter::IsCompressible(const std::string& content_type) {
+  std::string type = content_type.substr(0, content_type.find(';'));
+  while (!type.empty() && type.back() == ' ') type.pop_back();
+  std::transform(type.begin(), type.end(), type.begin(),
+                 [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+  static const char* const kTypes[] = {"application/json", "application/javascript",
+                                       "application/xml", "image/svg+xml"};
+  if (type.rfind("text/", 0) == 0) return true;
+  for (const char* t : kTypes) {
+    if (type == t) return true;
+  }
+  // Structured syntax suffixes, e.g. application/problem+json
+  auto endsWith = [&type](const std::string& suffix) {
+    return type.size() > suffix.size() &&
+           type.compare(type.size() - suffix.size(), suffix.size(), suffix) == 0;
+  };
+  return endsWith("+json") || endsWith("+xml");
+}
+
+void CompressionFilter::Apply(const Request& request, Response& response) const {
+  // Only bodies the handler built in memory, and the 304s revalidating
+  // them. Files go out with sendfile and prebuilt cached headers can't
+  // change, precompressed siblings cover both.
+  int status = response.get_status_code();
+  if ((status != 200 && status != 304) || response.has_header_block() ||
+      response.get_shared_body() || !response.get_file_slices().empty() ||
+      response.get_prebuilt_owner() ||
+      !response.get_header("Content-Encoding").empty()) return;
+  if (!IsCompressible(response.get_content_type())) return;
+
+  // Vary and the ETag follow from the type and Accept-Encoding alone, not
+  // the body, so a 304 carries the same ones as the 200 it stands for.
+  // Compressed or not, the bytes sent depend on Accept-Encoding.
+  response.set_header("Vary", "Accept-Encoding");
+  auto coding = content_encoding::Choose(
+      content_encoding::Accepted(request.get_header("Accept-Encoding")),
+      content_encoding::Bit(content_encoding::GZIP) | content_encoding::Bit(content_encoding::DEFLATE));
+  if (coding == content_encoding::IDENTITY) return;
+
+  // A strong ETag pins the body, anything else is compressed every time.
+  // Weak even when the body goes out as is, which a weak tag allows.
+  std::string etag = response.get_header("ETag");
+  bool cacheable = etag.size() >= 2 && etag.front() == '"';
+  if (cacheable) response.set_header("ETag", "W/" + etag);
+
+  const std::string& body = response.get_body();
+  if (status != 200 || body.size() < min_length_) return;
+  std::string key;
+  std::shared_ptr<const std::string> compressed;
+  if (cacheable) {
+    key = std::string(content_encoding::Name(coding)) + " " + std::to_string(body.size()) +
+          " " + etag;
+    compressed = CacheLookup(key);
+  }
+  if (!compressed) {
+    try {
+      compressed = std::make_shared<const std::string>(
+          content_encoding::Compress(body, coding, level_));
+    } catch (const std::runtime_error& e) {
+      Logger::log_error(std::string("Sending response uncompressed: ") + e.what());
+      return;
+    }
+    ++compressed_;
+    if (cacheable) CacheInsert(key, compressed);
+  }
+
+  // Nothing gained, e.g. text that's already dense
+  if (compressed->size() >= body.size()) return;
+  response.set_shared_body(std::move(compressed));
+  response.set_header("Content-Encoding", content_encoding::Name(coding));
+}
+
+std::shared_ptr<const std::string> CompressionFilter::CacheLookup(const std::string& key) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key);
+  if (it == index_.end()) return nullptr;
+  lru_.splice(lru_.begin(), lru_, it->second);
+  ++cache_hits_;
+  return it->second->second;
+}
+
+void CompressionFilter::CacheInsert(const std::string& key,
+                                    std::shared_ptr<const std::string> body) const {
+  std::size_t cost = key.size() + body->size();
+  if (cost > cache_capacity_) return;
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  // Another thread compressed the same body meanwhile
+  if (index_.count(key)) return;
+  while (cache_bytes_ + cost > cache_capacity_ && !lru_.empty()) {
+    auto& victim = lru_.back();
+    cache_bytes_ -= victim.first.size() + victim.second->size();
+    index_.erase(victim.first);
+    lru_.pop_back();
+  }
+  lru_.emplace_front(key, std::move(body));
+  index_[key] = lru_.begin();
+  cache_bytes_ += cost;
+}
+
+CompressionFilter::Stats CompressionFilter::GetStats() const {
+  Stats stats;
+  stats.compressed = compressed_;
+  stats.cache_hits = cache_hits_;
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats.cache_bytes = cache_bytes_;
+  return stats;
+}
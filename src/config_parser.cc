@@ -10,6 +10,7 @@
 #include <cstdio>
 #include <fstream>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <stack>
 #include <string>
@@ -107,6 +108,131 @@ bool NginxConfig::ExtractPort(unsigned short& port_out) {
   return false;
 }
 
+bool NginxConfig::HasDirective(const std::string& name) const {
+  for (const auto& stmt : statements_) {
+    if (!stmt->tokens_.empty() && stmt->tokens_[0] == name && !stmt->child_block_) return true;
+  }
+  return false;
+}
+
+bool NginxConfig::ExtractKeepaliveTimeout(unsigned int& seconds_out) {
+  return ExtractUnsigned("keepalive_timeout", seconds_out);
+}
+
+bool NginxConfig::ExtractKeepaliveRequests(unsigned int& requests_out) {
+  unsigned int requests = 0;
+  if (!ExtractUnsigned("keepalive_requests", requests) || requests == 0) return false;
+  requests_out = requests;
+  return true;
+}
+
+bool NginxConfig::ExtractOpenFileCache(unsigned int& entries_out) {
+  return ExtractUnsigned("open_file_cache", entries_out);
+}
+
+bool NginxConfig::ExtractOpenFileCacheInactive(unsigned int& seconds_out) {
+  unsigned int seconds = 0;
+  if (!ExtractUnsigned("open_file_cache_inactive", seconds) || seconds == 0) return false;
+  seconds_out = seconds;
+  return true;
+}
+
+bool NginxConfig::ExtractOpenFileCacheValid(unsigned int& seconds_out) {
+  return ExtractUnsigned("open_file_cache_valid", seconds_out);
+}
+
+bool NginxConfig::ExtractAio(std::string& mode_out) {
+  for (const auto& stmt : statements_) {
+    if (stmt->tokens_.size() == 2 && stmt->tokens_[0] == "aio") {
+      const std::string& mode = stmt->tokens_[1];
+      if (mode != "on" && mode != "threads" && mode != "off") return false;
+      mode_out = mode;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool NginxConfig::ExtractAioThreads(unsigned int& threads_out) {
+  unsigned int threads = 0;
+  if (!ExtractUnsigned("aio_threads", threads) || threads == 0) return false;
+  threads_out = threads;
+  return true;
+}
+
+bool NginxConfig::ExtractHandlerThreads(unsigned int& threads_out) {
+  return ExtractUnsigned("handler_threads", threads_out);
+}
+
+bool NginxConfig::ExtractReusePort(bool& on_out) {
+  for (const auto& stmt : statements_) {
+    if (stmt->tokens_.size() == 2 && stmt->tokens_[0] == "reuseport") {
+      const std::string& value = stmt->tokens_[1];
+      if (value != "on" && value != "off") return false;
+      on_out = value == "on";
+      return true;
+    }
+  }
+  return false;
+}
+
+bool NginxConfig::ExtractSessionPool(unsigned int& sessions_out) {
+  return ExtractUnsigned("session_pool", sessions_out);
+}
+
+bool NginxConfig::ExtractWorkerThreads(unsigned int& threads_out) {
+  for (const auto& stmt : statements_) {
+    if (stmt->tokens_.size() == 2 && stmt->tokens_[0] == "worker_threads" &&
+        stmt->tokens_[1] == "auto") {
+      threads_out = 0;
+      return true;
+    }
+  }
+  unsigned int threads = 0;
+  if (!ExtractUnsigned("worker_threads", threads) || threads == 0) return false;
+  threads_out = threads;
+  return true;
+}
+
+bool NginxConfig::ExtractWorkerCpuAffinity(std::vector<std::string>& masks_out) {
+  for (const auto& stmt : statements_) {
+    if (stmt->tokens_.size() < 2 || stmt->tokens_[0] != "worker_cpu_affinity") continue;
+    std::vector<std::string> masks(stmt->tokens_.begin() + 1, stmt->tokens_.end());
+    if (masks.size() == 1 && masks[0] == "auto") {
+      masks_out = masks;
+      return true;
+    }
+    for (const auto& mask : masks) {
+      if (mask.find_first_not_of("01") != std::string::npos ||
+          mask.find('1') == std::string::npos) {
+        return false;
+      }
+    }
+    masks_out = masks;
+    return true;
+  }
+  return false;
+}
+
+bool NginxConfig::ExtractUnsigned(const std::string& name, unsigned int& value_out) {
+  for (const auto& stmt : statements_) {
+    if (stmt->tokens_.size() == 2 && stmt->tokens_[0] == name) {
+      const std::string& value = stmt->tokens_[1];
+      if (value.empty() || value.find_first_not_of("0123456789") != std::string::npos)
+        return false;
+      unsigned long parsed = 0;
+      try {
+        parsed = std::stoul(value);
+      } catch (...) { return false; }
+      // Would otherwise wrap, e.g. to 0
+      if (parsed > std::numeric_limits<unsigned int>::max()) return false;
+      value_out = static_cast<unsigned int>(parsed);
+      return true;
+    }
+  }
+  return false;
+}
+
 std::string NginxConfigStatement::ToString(int depth) {
   std::string serialized_statement;
   for (int i = 0; i < depth; ++i) {
@@ -0,0 +1,133 @@
+#include "content_encoding.h"
+
+#include <cctype>
+#include <stdexcept>
+#include <zlib.h>
+
+namespace content_encoding {
+
+// Server preference, best compression ratio first
+static const Coding kPreference[] = {BROTLI, ZSTD, GZIP, DEFLATE};
+
+static std::string_view trim(std::string_view s) {
+  while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+  while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+  return s;
+}
+
+static bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+  if (a.size() != b.size()) return false;
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    if (std::tolower(static_cast<unsigned char>(a[i])) !=
+        std::tolower(static_cast<unsigned char>(b[i]))) return false;
+  }
+  return true;
+}
+
+// False if the parameters of a list element carry "q=0" (or 0.0, 0.00...)
+static bool hasNonZeroQuality(std::string_view params) {
+  while (!params.empty()) {
+    std::size_t semi = params.find(';');
+    std::string_view param = trim(params.substr(0, semi));
+    if (param.size() >= 2 && (param[0] == 'q' || param[0] == 'Q') && param[1] == '=') {
+      for (char c : param.substr(2)) {
+        if (c != '0' && c != '.') return true;
+      }
+      return false;
+    }
+    if (semi == std::string_view::npos) break;
+    params.remove_prefix(semi + 1);
+  }
+  return true;
+}
+
+unsigned Accepted(std::string_view accept_encoding) {
+  unsigned accepted = 0;
+  unsigned listed = 0;
+  bool wildcard = false;
+  while (!accept_encoding.empty()) {
+    std::size_t comma = accept_encoding.find(',');
+    std::string_view item = accept_encoding.substr(0, comma);
+    std::size_t semi = item.find(';');
+    std::string_view name = trim(item.substr(0, semi));
+    bool ok = semi == std::string_view::npos || hasNonZeroQuality(item.substr(semi + 1));
+
+    unsigned bit = 0;
+    if (equalsIgnoreCase(name, "gzip") || equalsIgnoreCase(name, "x-gzip")) bit = Bit(GZIP);
+    else if (equalsIgnoreCase(name, "br")) bit = Bit(BROTLI);
+    else if (equalsIgnoreCase(name, "zstd")) bit = Bit(ZSTD);
+    else if (equalsIgnoreCase(name, "deflate")) bit = Bit(DEFLATE);
+    else if (name == "*") wildcard = ok;
+
+    if (bit) {
+      listed |= bit;
+      if (ok) accepted |= bit;
+      else accepted &= ~bit;
+    }
+    if (comma == std::string_view::npos) break;
+    accept_encoding.remove_prefix(comma + 1);
+  }
+
+  if (wildcard) {
+    for (Coding coding : kPreference) {
+      if (!(listed & Bit(coding))) accepted |= Bit(coding);
+    }
+  }
+  return accepted;
+}
+
+Coding Choose(unsigned accepted, unsigned available) {
+  for (Coding coding : kPreference) {
+    if (accepted & available & Bit(coding)) return coding;
+  }
+  return IDENTITY;
+}
+
+const char* Name(Coding coding) {
+  switch (coding) {
+    case GZIP: return "gzip";
+    case BROTLI: return "br";
+    case ZSTD: return "zstd";
+    case DEFLATE: return "deflate";
+    default: return "";
+  }
+}
+
+const char* Suffix(Coding coding) {
+  switch (coding) {
+    case GZIP: return ".gz";
+    case BROTLI: return ".br";
+    case ZSTD: return ".zst";
+    default: return "";
+  }
+}
+
+bool CanCompress(Coding coding) {
+  return coding == GZIP || coding == DEFLATE;
+}
+
+std::string Compress(std::string_view data, Coding coding, int level) {
+  if (!CanCompress(coding)) {
+    throw std::runtime_error(std::string("Compression not supported for ") + Name(coding));
+  }
+
+  // "deflate" in HTTP means the zlib format, gzip adds its own wrapper
+  z_stream stream = {};
+  int window_bits = coding == GZIP ? 15 + 16 : 15;
+  if (deflateInit2(&stream, level, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+    throw std::runtime_error("deflateInit2 failed");
+  }
+
+  std::string out(deflateBound(&stream, static_cast<uLong>(data.size())), '\0');
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = static_cast<uInt>(data.size());
+  stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+  stream.avail_out = static_cast<uInt>(out.size());
+  int rc = deflate(&stream, Z_FINISH);
+  out.resize(stream.total_out);
+  deflateEnd(&stream);
+  if (rc != Z_STREAM_END) throw std::runtime_error("deflate failed");
+  return out;
+}
+
+}  // namespace content_encoding
@@ -18,8 +18,8 @@ RequestHandler* CrudApiHandler::Init(
       "CrudApiHandler missing 'root' parameter for location " + location);
   }
 
-  // use default RealFileSystem implementation
-  auto fs_impl = std::make_shared<RealFileSystem>();
+  // use the shared RealFileSystem, so reads go through the open file cache
+  auto fs_impl = RealFileSystem::Default();
 
   // canonicalize the root on disk
   fs::path cfg = it->second;
@@ -36,11 +36,24 @@ CrudApiHandler::CrudApiHandler(std::string url_prefix, std::string filesystem_ro
     fs_root_(std::move(filesystem_root)),
     fs_impl_(std::move(fs)) {}
 
-bool CrudApiHandler::is_valid_json(const std::string& body) const {
+namespace {
+// Read-only streambuf over existing memory, lets the JSON parser read the
+// request body in place instead of copying it into a stringstream
+class ViewStreamBuf : public std::streambuf {
+  public:
+    explicit ViewStreamBuf(std::string_view view) {
+      char* begin = const_cast<char*>(view.data());
+      setg(begin, begin, begin + view.size());
+    }
+};
+}  // namespace
+
+bool CrudApiHandler::is_valid_json(std::string_view body) const {
   try {
-    std::stringstream ss(body);
+    ViewStreamBuf buf(body);
+    std::istream in(&buf);
     pt::ptree pt;
-    pt::read_json(ss, pt);
+    pt::read_json(in, pt);
     return true;
   } 
   catch (const pt::ptree_error& e) {
@@ -111,7 +124,7 @@ int CrudApiHandler::generate_unique_id(const std::string& entity) const {
 
 Response CrudApiHandler::make_error_response(const Request& request, int status_code, const std::string& message) const {
   
-  Logger::log_error("Error " + std::to_string(status_code) + ": " + message + " | Method: " + request.get_method());
+  Logger::log_error("Error " + std::to_string(status_code) + ": " + message + " | Method: " + std::string(request.get_method()));
 
   return Response(
     request.get_version(),
@@ -138,7 +151,7 @@ Response CrudApiHandler::make_success_response(const Request& request, const std
 
 Response CrudApiHandler::handle_post(const Request& request, const std::string& entity_type){
   //verify request body is valid json
-    std::string request_body = request.get_body();
+    std::string_view request_body = request.get_body();
     if (!is_valid_json(request_body)) {
         return make_error_response(request, 400, "400 Bad Request: Invalid JSON in request body");
     }
@@ -240,7 +253,7 @@ Response CrudApiHandler::handle_get(const Request& request, const std::string& e
 
 Response CrudApiHandler::handle_put(const Request& request, const std::string& entity_type, const std::string& entity_id) {
   // verify body is present in request
-  const std::string& body = request.get_body();
+  std::string_view body = request.get_body();
   if (body.empty()) {
     return make_error_response(request, 400, "400 Bad Request: Missing request body");
   }
@@ -312,14 +325,14 @@ Response CrudApiHandler::handle_request(const Request& request) {
 
   //get entity from web url and return errors if it doesn't exist
   std::string entity_type;
-  entity_type = parse_for_entity(request.get_url());
+  entity_type = parse_for_entity(std::string(request.get_url()));
   if (entity_type.empty()) {
     return make_error_response(request, 400, "400 Bad Request: Missing entity type in URL");
   }
 
   // get ID similar to parsing entity
   std::string entity_id;
-  entity_id = parse_for_id(request.get_url());
+  entity_id = parse_for_id(std::string(request.get_url()));
 
 
   if (method == "GET") {
@@ -0,0 +1,134 @@
+#include "directory_listing.h"
+#include "validators.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <filesystem>
+
+namespace fs = std::filesystem;
+
+// text with the characters special in HTML escaped
+static std::string escapeHtml(const std::string& text) {
+  std::string out;
+  out.reserve(text.size());
+  for (char c : text) {
+    switch (c) {
+      case '&': out += "&amp;"; break;
+      case '<': out += "&lt;"; break;
+      case '>': out += "&gt;"; break;
+      case '"': out += "&quot;"; break;
+      case '\'': out += "&#39;"; break;
+      default: out += c;
+    }
+  }
+  return out;
+}
+
+// name percent-encoded for use as a relative URL path segment
+static std::string encodeSegment(const std::string& name) {
+  std::string out;
+  for (unsigned char c : name) {
+    if (std::isalnum(c) || c == '-' || c == '.' || c == '_' || c == '~') {
+      out += static_cast<char>(c);
+    } else {
+      char buf[4];
+      std::snprintf(buf, sizeof(buf), "%%%02X", c);
+      out += buf;
+    }
+  }
+  return out;
+}
+
+DirectoryListingCache::DirectoryListingCache(std::size_t max_entries, std::size_t shards)
+  : shard_entries_(std::max<std::size_t>(max_entries / std::max<std::size_t>(shards, 1), 1)) {
+  for (std::size_t i = 0; i < std::max<std::size_t>(shards, 1); ++i) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+}
+
+DirectoryListingCache::Shard& DirectoryListingCache::ShardFor(const std::string& dir) {
+  return *shards_[std::hash<std::string>()(dir) % shards_.size()];
+}
+
+std::shared_ptr<const std::string> DirectoryListingCache::Get(const std::string& dir,
+                                                              const FileStat& current,
+                                                              const std::string& url) {
+  Shard& shard = ShardFor(dir);
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(dir);
+    if (it != shard.index.end() && it->second.stat.SameFile(current) && it->second.url == url) {
+      ++hits_;
+      return it->second.html;
+    }
+  }
+
+  // Built outside the lock, a large directory doesn't hold up its shard
+  ++misses_;
+  std::shared_ptr<const std::string> html;
+  try {
+    html = std::make_shared<const std::string>(Render(dir, url));
+  } catch (const fs::filesystem_error&) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  if (shard.index.size() >= shard_entries_ && !shard.index.count(dir)) shard.index.clear();
+  shard.index[dir] = Entry{current, url, html};
+  return html;
+}
+
+DirectoryListingCache::Stats DirectoryListingCache::GetStats() const {
+  Stats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  for (const auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    stats.entries += shard->index.size();
+  }
+  return stats;
+}
+
+std::string DirectoryListingCache::Render(const std::string& dir, const std::string& url) {
+  struct Item {
+    std::string name;
+    bool directory;
+    FileStat stat;
+  };
+  std::vector<Item> items;
+  for (const auto& entry : fs::directory_iterator(dir)) {
+    std::string name = entry.path().filename().string();
+    if (name.empty() || name[0] == '.') continue;
+    Item item{name, false, {}};
+    // Entries that vanish or can't be stat'ed are left out
+    if (!FileStat::Load(entry.path().string(), item.stat)) continue;
+    std::error_code ec;
+    item.directory = entry.is_directory(ec);
+    if (!item.directory && !item.stat.regular) continue;
+    items.push_back(std::move(item));
+  }
+  std::sort(items.begin(), items.end(), [](const Item& a, const Item& b) {
+    if (a.directory != b.directory) return a.directory;
+    return a.name < b.name;
+  });
+
+  std::string title = "Index of " + escapeHtml(url);
+  std::string html = "<!doctype html>\n<html>\n<head><meta charset=\"utf-8\"><title>" + title +
+                     "</title></head>\n<body>\n<h1>" + title + "</h1><hr><pre>";
+  if (url != "/") html += "<a href=\"../\">../</a>\n";
+  for (const auto& item : items) {
+    std::string suffix = item.directory ? "/" : "";
+    html += "<a href=\"" + encodeSegment(item.name) + suffix + "\">" + escapeHtml(item.name) +
+            suffix + "</a>";
+    // Pad by characters of the shown name, not bytes of the markup
+    std::size_t shown = item.name.size() + suffix.size();
+    html.append(shown < 50 ? 51 - shown : 1, ' ');
+    html += validators::HttpDate(validators::LastModified(item.stat));
+    std::string size = item.directory ? "-" : std::to_string(item.stat.size);
+    html.append(size.size() < 20 ? 20 - size.size() : 1, ' ');
+    html += size + "\n";
+  }
+  html += "</pre><hr></body>\n</html>\n";
+  return html;
+}
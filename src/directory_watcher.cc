@@ -0,0 +1,106 @@
+#include "directory_watcher.h"
+
+#include <filesystem>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#include "logger.h"
+
+namespace fs = std::filesystem;
+
+// Changes that can alter how a path under the tree resolves
+static const std::uint32_t kWatchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO |
+                                        IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+
+DirectoryWatcher::DirectoryWatcher(const std::string& root) {
+  inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  wake_fd_ = eventfd(0, EFD_CLOEXEC);
+  if (inotify_fd_ < 0 || wake_fd_ < 0) {
+    Logger::log_warning("Can't watch " + root + " for changes, path caching disabled");
+    return;
+  }
+
+  healthy_ = true;
+  AddTree(root);
+  if (!healthy_) {
+    Logger::log_warning("Can't watch all of " + root + " for changes, path caching disabled");
+    return;
+  }
+  thread_ = std::thread([this] { Run(); });
+}
+
+DirectoryWatcher::~DirectoryWatcher() {
+  if (thread_.joinable()) {
+    std::uint64_t one = 1;
+    ssize_t ignored = write(wake_fd_, &one, sizeof(one));
+    (void)ignored;
+    thread_.join();
+  }
+  if (inotify_fd_ >= 0) close(inotify_fd_);
+  if (wake_fd_ >= 0) close(wake_fd_);
+}
+
+bool DirectoryWatcher::healthy() const { return healthy_; }
+
+std::uint64_t DirectoryWatcher::generation() const { return generation_; }
+
+bool DirectoryWatcher::symlink_free() const { return symlink_free_; }
+
+void DirectoryWatcher::AddTree(const std::string& dir) {
+  int wd = inotify_add_watch(inotify_fd_, dir.c_str(), kWatchMask);
+  if (wd < 0) {
+    healthy_ = false;
+    return;
+  }
+  dirs_[wd] = dir;
+
+  std::error_code ec;
+  for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+    if (it->is_symlink(ec)) {
+      symlink_free_ = false;
+    } else if (it->is_directory(ec)) {
+      AddTree(it->path().string());
+    }
+  }
+}
+
+void DirectoryWatcher::Run() {
+  alignas(struct inotify_event) char buf[4096];
+  pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+  while (true) {
+    if (poll(fds, 2, -1) < 0) continue;
+    if (fds[1].revents) return;
+
+    ssize_t len;
+    while ((len = read(inotify_fd_, buf, sizeof(buf))) > 0) {
+      for (char* p = buf; p < buf + len;) {
+        auto* event = reinterpret_cast<struct inotify_event*>(p);
+        p += sizeof(struct inotify_event) + event->len;
+
+        if (event->mask & IN_Q_OVERFLOW) {
+          // Lost events may include new directories left unwatched
+          healthy_ = false;
+          continue;
+        }
+        if (event->mask & IN_IGNORED) {
+          dirs_.erase(event->wd);
+          continue;
+        }
+        auto dir = dirs_.find(event->wd);
+        if (dir == dirs_.end() || event->len == 0) continue;
+
+        std::string path = dir->second + "/" + event->name;
+        if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+          std::error_code ec;
+          auto status = fs::symlink_status(path, ec);
+          if (fs::is_symlink(status)) symlink_free_ = false;
+          else if (fs::is_directory(status)) AddTree(path);
+        }
+      }
+      // Published after the tree state above, so a reader seeing the new
+      // generation also sees the flags
+      ++generation_;
+    }
+  }
+}
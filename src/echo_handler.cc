@@ -20,5 +20,5 @@ Response EchoHandler::handle_request(const Request& request) {
   }
 
   // ---------- normal 200 echo path ----------
-  return Response(request.get_version(), 200, "text/plain", request.length(), "close", request.to_string(), EchoHandler::kName);
+  return Response(request.get_version(), 200, "text/plain", request.length(), "close", std::string(request.to_string()), EchoHandler::kName);
 }
\ No newline at end of file
@@ -0,0 +1,4 @@
+// Linked in place of a generated table when EMBED_STATIC_DIR is unset
+#include "embedded_assets.h"
+
+EmbeddedAssetTable EmbeddedAssets() { return {nullptr, 0}; }
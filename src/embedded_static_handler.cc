@@ -0,0 +1,76 @@
+// src/embedded_static_handler.cc
+#include "embedded_static_handler.h"
+#include "logger.h"
+#include "validators.h"
+#include <stdexcept>
+#include <vector>
+
+// define the kName symbol
+constexpr char EmbeddedStaticHandler::kName[];
+
+// Factory invoked by HandlerRegistry
+RequestHandler* EmbeddedStaticHandler::Init(
+    const std::string& location,
+    const std::unordered_map<std::string, std::string>& /*params*/) {
+  EmbeddedAssetTable assets = EmbeddedAssets();
+  if (assets.count == 0) {
+    throw std::runtime_error(
+      "EmbeddedStaticHandler has no assets for location " + location +
+      ", build with -DEMBED_STATIC_DIR=<dir>");
+  }
+  return new EmbeddedStaticHandler(location, assets);
+}
+
+// Paths of assets, in table order
+static std::vector<std::string_view> assetPaths(const EmbeddedAssetTable& assets) {
+  std::vector<std::string_view> paths;
+  paths.reserve(assets.count);
+  for (std::size_t i = 0; i < assets.count; ++i) paths.push_back(assets.assets[i].path);
+  return paths;
+}
+
+EmbeddedStaticHandler::EmbeddedStaticHandler(std::string url_prefix, EmbeddedAssetTable assets)
+  : prefix_(std::move(url_prefix)),
+    assets_(assets),
+    index_(std::make_shared<const PerfectHash>(assetPaths(assets))) {
+  while (!prefix_.empty() && prefix_.back() == '/') prefix_.pop_back();
+}
+
+std::size_t EmbeddedStaticHandler::size() const { return assets_.count; }
+
+Response EmbeddedStaticHandler::handle_request(const Request& request) {
+  std::string_view url = request.get_url();
+  url = url.substr(0, url.find('?'));
+  std::size_t found = PerfectHash::npos;
+  if (url.compare(0, prefix_.size(), prefix_) == 0) found = index_->Find(url.substr(prefix_.size()));
+  if (found == PerfectHash::npos) {
+    // 404 Not Found
+    std::string b = "404 Error: File not found";
+    return Response(request.get_version(), 404, "text/plain", b.size(), "close", b,
+                    EmbeddedStaticHandler::kName);
+  }
+  const EmbeddedAsset& asset = assets_.assets[found];
+
+  if (validators::IsNotModified(request, asset.etag, asset.last_modified)) {
+    Response response(request.get_version(), 304, "", 0, "close", "",
+                      EmbeddedStaticHandler::kName);
+    response.add_header("ETag", std::string(asset.etag));
+    response.add_header("Last-Modified", validators::HttpDate(asset.last_modified));
+    return response;
+  }
+
+  // The prebuilt head names HTTP/1.1; other versions get headers of their
+  // own. The body is never copied, and HEAD drops it unsent.
+  if (request.get_version() == "HTTP/1.1") {
+    Response response(request.get_version(), 200, "", 0, "close", "",
+                      EmbeddedStaticHandler::kName);
+    response.set_prebuilt(index_, asset.head, asset.body);
+    return response;
+  }
+  Response response(request.get_version(), 200, std::string(asset.content_type), 0, "close", "",
+                    EmbeddedStaticHandler::kName);
+  response.add_header("ETag", std::string(asset.etag));
+  response.add_header("Last-Modified", validators::HttpDate(asset.last_modified));
+  response.set_prebuilt(index_, "", asset.body);
+  return response;
+}
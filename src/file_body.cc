@@ -0,0 +1,63 @@
+#include "file_body.h"
+
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static FileStat fromStat(const struct stat& st) {
+  FileStat out;
+  out.size = static_cast<std::size_t>(st.st_size);
+  out.mtime_ns = static_cast<std::int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+  out.inode = static_cast<std::uint64_t>(st.st_ino);
+  out.device = static_cast<std::uint64_t>(st.st_dev);
+  out.regular = S_ISREG(st.st_mode);
+  return out;
+}
+
+bool FileStat::Load(const std::string& path, FileStat& out) {
+  struct stat st;
+  if (::stat(path.c_str(), &st) != 0) return false;
+  out = fromStat(st);
+  return true;
+}
+
+bool FileStat::SameFile(const FileStat& other) const {
+  return size == other.size && mtime_ns == other.mtime_ns &&
+         inode == other.inode && device == other.device;
+}
+
+std::shared_ptr<FileBody> FileBody::Open(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return nullptr;
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+    ::close(fd);
+    return nullptr;
+  }
+  return std::shared_ptr<FileBody>(new FileBody(fd, fromStat(st)));
+}
+
+FileBody::FileBody(int fd, const FileStat& stat) : fd_(fd), stat_(stat) {}
+
+FileBody::~FileBody() { ::close(fd_); }
+
+int FileBody::fd() const { return fd_; }
+
+std::size_t FileBody::size() const { return stat_.size; }
+
+const FileStat& FileBody::stat() const { return stat_; }
+
+std::string FileBody::Read(std::size_t offset, std::size_t length) const {
+  std::string out(length, '\0');
+  std::size_t done = 0;
+  while (done < length) {
+    ssize_t n = ::pread(fd_, &out[done], length - done, static_cast<off_t>(offset + done));
+    if (n < 0 && errno == EINTR) continue;
+    if (n <= 0) break;  // Error or the file shrank, return what was read
+    done += static_cast<std::size_t>(n);
+  }
+  out.resize(done);
+  return out;
+}
@@ -2,18 +2,20 @@
 #include <stdexcept>
 
 // Returns the single registry map, created on first call
-std::unordered_map<std::string, HandlerRegistry::RequestHandlerFactory>&
+std::unordered_map<std::string, HandlerRegistry::Entry>&
 HandlerRegistry::registry() {
-  static std::unordered_map<std::string, RequestHandlerFactory> map;
+  static std::unordered_map<std::string, Entry> map;
   return map;
 }
 
 // Store the factory under 'name'; skip if already exists.
 bool HandlerRegistry::RegisterHandler(const std::string& name,
-                                      RequestHandlerFactory factory) {
+                                      RequestHandlerFactory factory,
+                                      Sharing sharing,
+                                      Blocking blocking) {
   auto& m = registry();
   if (m.count(name)) return false;  // duplicate registration not allowed
-  m[name] = std::move(factory);
+  m[name] = Entry{std::move(factory), sharing, blocking};
   return true;
 }
 
@@ -28,7 +30,29 @@ RequestHandler* HandlerRegistry::CreateHandler(
   if (it == m.end()) {
     throw std::runtime_error("Unknown handler: " + name);
   }
-  return it->second(location, params);
+  return it->second.factory(location, params);
+}
+
+// Look up how instances registered under 'name' may be reused.
+// Throws if no such handler was registered.
+HandlerRegistry::Sharing HandlerRegistry::GetSharing(const std::string& name) {
+  auto& m = registry();
+  auto it = m.find(name);
+  if (it == m.end()) {
+    throw std::runtime_error("Unknown handler: " + name);
+  }
+  return it->second.sharing;
+}
+
+// Look up whether handlers registered under 'name' may block.
+// Throws if no such handler was registered.
+HandlerRegistry::Blocking HandlerRegistry::GetBlocking(const std::string& name) {
+  auto& m = registry();
+  auto it = m.find(name);
+  if (it == m.end()) {
+    throw std::runtime_error("Unknown handler: " + name);
+  }
+  return it->second.blocking;
 }
 
 // Check if any factory is registered under this name.
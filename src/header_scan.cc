@@ -0,0 +1,111 @@
+#include "header_scan.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define HEADER_SCAN_X86 1
+#include <immintrin.h>
+#endif
+
+namespace header_scan {
+
+namespace {
+
+using FindFn = const char* (*)(const char*, const char*, char, char);
+
+const char* FindEitherScalar(const char* p, const char* end, char a, char b) {
+    for (; p < end; ++p) {
+        if (*p == a || *p == b) return p;
+    }
+    return end;
+}
+
+#ifdef HEADER_SCAN_X86
+// 16 bytes per step; SSE2 is part of the x86-64 baseline
+__attribute__((target("sse2")))
+const char* FindEitherSse2(const char* p, const char* end, char a, char b) {
+    const __m128i va = _mm_set1_epi8(a);
+    const __m128i vb = _mm_set1_epi8(b);
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        int mask = _mm_movemask_epi8(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, va), _mm_cmpeq_epi8(chunk, vb)));
+        if (mask != 0) return p + __builtin_ctz(static_cast<unsigned int>(mask));
+        p += 16;
+    }
+    return FindEitherScalar(p, end, a, b);
+}
+
+// 32 bytes per step, only called after the CPU reported AVX2 support
+__attribute__((target("avx2")))
+const char* FindEitherAvx2(const char* p, const char* end, char a, char b) {
+    const __m256i va = _mm256_set1_epi8(a);
+    const __m256i vb = _mm256_set1_epi8(b);
+    while (end - p >= 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        unsigned int mask = static_cast<unsigned int>(_mm256_movemask_epi8(
+            _mm256_or_si256(_mm256_cmpeq_epi8(chunk, va), _mm256_cmpeq_epi8(chunk, vb))));
+        if (mask != 0) return p + __builtin_ctz(mask);
+        p += 32;
+    }
+    return FindEitherSse2(p, end, a, b);
+}
+#endif
+
+FindFn FnFor(Impl impl) {
+    switch (impl) {
+#ifdef HEADER_SCAN_X86
+        case IMPL_AVX2: return FindEitherAvx2;
+        case IMPL_SSE2: return FindEitherSse2;
+#endif
+        default:        return FindEitherScalar;
+    }
+}
+
+Impl BestImpl() {
+    if (IsSupported(IMPL_AVX2)) return IMPL_AVX2;
+    if (IsSupported(IMPL_SSE2)) return IMPL_SSE2;
+    return IMPL_SCALAR;
+}
+
+// Chosen once during static initialization, before any request is parsed
+Impl active_impl = BestImpl();
+FindFn active_fn = FnFor(active_impl);
+
+}  // namespace
+
+const char* FindEither(const char* begin, const char* end, char a, char b) {
+    return active_fn(begin, end, a, b);
+}
+
+Impl ActiveImpl() { return active_impl; }
+
+const char* ImplName(Impl impl) {
+    switch (impl) {
+        case IMPL_AVX2: return "avx2";
+        case IMPL_SSE2: return "sse2";
+        default:        return "scalar";
+    }
+}
+
+bool IsSupported(Impl impl) {
+#ifdef HEADER_SCAN_X86
+    // Required when called from static initializers, harmless otherwise
+    __builtin_cpu_init();
+#endif
+    switch (impl) {
+        case IMPL_SCALAR: return true;
+#ifdef HEADER_SCAN_X86
+        case IMPL_SSE2:   return __builtin_cpu_supports("sse2");
+        case IMPL_AVX2:   return __builtin_cpu_supports("avx2");
+#endif
+        default:          return false;
+    }
+}
+
+bool ForceImpl(Impl impl) {
+    if (!IsSupported(impl)) return false;
+    active_impl = impl;
+    active_fn = FnFor(impl);
+    return true;
+}
+
+}  // namespace header_scan
@@ -9,8 +9,6 @@
 #include <boost/log/sinks/text_file_backend.hpp>
 #include <boost/log/support/date_time.hpp>
 
-#include <sstream>
-
 namespace logging = boost::log;
 namespace attrs = boost::log::attributes;
 namespace expr = boost::log::expressions;
@@ -87,13 +85,12 @@ void Logger::log_request(
     int status_code, 
     const std::string& handler_type
     ) {
-    std::ostringstream log_line;
-    log_line <<
+    // Streamed into the record, so nothing is formatted when it's filtered out
+    BOOST_LOG_TRIVIAL(info) <<
         "[ResponseMetrics] " <<
         "request_ip:" << client_ip << " " <<
         "request_method:" << method << " " <<
         "request_path:" << uri << " " <<
-        "-> response_code:" << std::to_string(status_code) << " " <<
+        "-> response_code:" << status_code << " " <<
         "handler_type:" << handler_type;
-    Logger::log_info(log_line.str());
 }
\ No newline at end of file
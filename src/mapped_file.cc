@@ -0,0 +1,91 @@
+#include "mapped_file.h"
+
+#include <algorithm>
+#include <functional>
+#include <sys/mman.h>
+
+bool MappedFile::ParseAdvice(const std::string& name, Advice& out) {
+  static const std::unordered_map<std::string, Advice> names = {
+    {"normal", ADVICE_NORMAL},
+    {"sequential", ADVICE_SEQUENTIAL},
+    {"random", ADVICE_RANDOM},
+    {"willneed", ADVICE_WILLNEED},
+  };
+  auto it = names.find(name);
+  if (it == names.end()) return false;
+  out = it->second;
+  return true;
+}
+
+std::shared_ptr<MappedFile> MappedFile::Map(const FileBody& file, Advice advice) {
+  // mmap rejects empty lengths, an empty file needs no pages anyway
+  if (file.size() == 0) return std::shared_ptr<MappedFile>(new MappedFile(nullptr, file.stat()));
+
+  void* addr = ::mmap(nullptr, file.size(), PROT_READ, MAP_SHARED, file.fd(), 0);
+  if (addr == MAP_FAILED) return nullptr;
+
+  static const int advice_flags[] = {MADV_NORMAL, MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED};
+  // Only a hint, a kernel that refuses it still serves the pages
+  ::madvise(addr, file.size(), advice_flags[advice]);
+  return std::shared_ptr<MappedFile>(new MappedFile(addr, file.stat()));
+}
+
+MappedFile::MappedFile(void* addr, const FileStat& stat) : addr_(addr), stat_(stat) {}
+
+MappedFile::~MappedFile() {
+  if (addr_) ::munmap(addr_, stat_.size);
+}
+
+const char* MappedFile::data() const { return static_cast<const char*>(addr_); }
+
+std::size_t MappedFile::size() const { return stat_.size; }
+
+const FileStat& MappedFile::stat() const { return stat_; }
+
+MappedFileTable::MappedFileTable(std::size_t max_entries, std::size_t shards)
+  : shard_entries_(std::max<std::size_t>(max_entries / std::max<std::size_t>(shards, 1), 1)) {
+  for (std::size_t i = 0; i < std::max<std::size_t>(shards, 1); ++i) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+}
+
+MappedFileTable::Shard& MappedFileTable::ShardFor(const std::string& path) {
+  return *shards_[std::hash<std::string>()(path) % shards_.size()];
+}
+
+std::shared_ptr<const MappedFile> MappedFileTable::Lookup(const std::string& path,
+                                                          const FileStat& current) {
+  Shard& shard = ShardFor(path);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.index.find(path);
+  if (it != shard.index.end()) {
+    if (it->second->stat().SameFile(current)) {
+      ++hits_;
+      return it->second;
+    }
+    // Replaced or modified on disk, remap on the next Insert
+    shard.index.erase(it);
+  }
+  ++misses_;
+  return nullptr;
+}
+
+void MappedFileTable::Insert(const std::string& path, std::shared_ptr<const MappedFile> mapping) {
+  Shard& shard = ShardFor(path);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  // Mappings still being written stay alive through their responses
+  if (shard.index.size() >= shard_entries_ && !shard.index.count(path)) shard.index.clear();
+  shard.index[path] = std::move(mapping);
+}
+
+MappedFileTable::Stats MappedFileTable::GetStats() const {
+  Stats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  for (const auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    stats.entries += shard->index.size();
+    for (const auto& entry : shard->index) stats.bytes += entry.second->size();
+  }
+  return stats;
+}
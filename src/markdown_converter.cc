@@ -4,8 +4,8 @@
 namespace markdown {
 
 // Use CMARK_OPT_SAFE to strip raw HTML
-std::string ConvertToHtml(const std::string& markdown_input) {
-    char* html = cmark_markdown_to_html(markdown_input.c_str(),
+std::string ConvertToHtml(std::string_view markdown_input) {
+    char* html = cmark_markdown_to_html(markdown_input.data(),
                                         markdown_input.size(),
                                         CMARK_OPT_SAFE);
 
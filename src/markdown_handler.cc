@@ -1,8 +1,9 @@
 // src/markdown_handler.cc
 #include "markdown_handler.h"
+#include "file_body.h"
 #include "logger.h"
-#include <fstream>
-#include <iterator>
+#include "real_filesystem.h"
+#include "validators.h"
 #include <cstring>
 
 // define the kName symbol
@@ -30,7 +31,9 @@ RequestHandler* MarkdownHandler::Init(
 // Constructor saves both pieces of information
 MarkdownHandler::MarkdownHandler(std::string url_prefix, std::string filesystem_root)
   : prefix_(std::move(url_prefix)),
-    fs_root_(std::move(filesystem_root)) {}
+    fs_root_(std::move(filesystem_root)),
+    resolver_(prefix_, fs_root_),
+    fs_(RealFileSystem::Default()) {}
 
 // Extract file extension (including the dot), or "" if none
 std::string MarkdownHandler::get_extension(const std::string& path) const {
@@ -38,24 +41,10 @@ std::string MarkdownHandler::get_extension(const std::string& path) const {
   return (pos == std::string::npos ? "" : path.substr(pos));
 }
 
-// Build the real filesystem path, guard against traversal
+// Build the real filesystem path, guard against traversal. Throws
+// std::runtime_error for paths outside the mount or the root.
 std::string MarkdownHandler::resolve_path(const std::string& url_path) const {
-  // strip off the URL prefix
-  if (url_path.rfind(prefix_,0)!=0) {
-    throw std::runtime_error("No static mount for this path");
-  }
-  std::string rest = url_path.substr(prefix_.size());
-  if (!rest.empty() && rest[0]=='/') rest.erase(0,1);
-
-  // canonicalize base and candidate
-  fs::path base = fs::canonical(fs_root_);
-  fs::path full = fs::weakly_canonical(base / rest);
-
-  // ensure full stays under base
-  if (full.generic_string().rfind(base.generic_string(),0)!=0) {
-    throw std::runtime_error("Path traversal attempt detected");
-  }
-  return full.string();
+  return resolver_.Resolve(url_path);
 }
 
 // The actual request handler
@@ -77,19 +66,15 @@ Response MarkdownHandler::handle_request(const Request& request) {
 
 Response MarkdownHandler::handle_get(const Request& request) {
   try {
-    auto path = resolve_path(request.get_url());
-    std::ifstream in(path, std::ios::binary);
-    if (!in) {
+    auto path = resolve_path(std::string(request.get_url()));
+    auto file = fs_->open_file(path);
+    if (!file) {
       // 404 Not Found
       std::string b = "404: File not found";
       Logger::log_error("MarkdownHandler error: " + b);
       return Response(request.get_version(), 404, "text/plain", b.size(), "close", b, MarkdownHandler::kName);
     }
 
-    // slurp the file
-    std::string body{ std::istreambuf_iterator<char>(in),
-                      std::istreambuf_iterator<char>() };
-
     auto ext = get_extension(path);
 
     // 400 Bad Request if request file is not .md
@@ -99,11 +84,27 @@ Response MarkdownHandler::handle_get(const Request& request) {
         return Response(request.get_version(), 400, "text/plain", msg.size(), "close", msg, MarkdownHandler::kName);
     }
 
+    // The HTML only depends on the source file, so its metadata validates
+    // the rendered page and a revalidation skips reading and converting
+    std::string etag = validators::ETag(file->stat());
+    std::int64_t last_modified = validators::LastModified(file->stat());
+    if (validators::IsNotModified(request, etag, last_modified)) {
+      // The type isn't sent, it tells a compressing route this is HTML
+      Response response(request.get_version(), 304, "text/html; charset=utf-8", 0, "close", "", MarkdownHandler::kName);
+      response.add_header("ETag", etag);
+      response.add_header("Last-Modified", validators::HttpDate(last_modified));
+      return response;
+    }
+
     // Convert body from .md to .html
+    std::string body = file->Read(0, file->size());
     std::string html_body = markdown::ConvertToHtml(body);
     std::string full_html = markdown::WrapInHtmlTemplate(html_body);
 
-    return Response(request.get_version(), 200, "text/html; charset=utf-8", full_html.size(), "close", full_html, MarkdownHandler::kName);
+    Response response(request.get_version(), 200, "text/html; charset=utf-8", full_html.size(), "close", full_html, MarkdownHandler::kName);
+    response.add_header("ETag", etag);
+    response.add_header("Last-Modified", validators::HttpDate(last_modified));
+    return response;
   }
   catch (const std::runtime_error& e) {
     // 404 Not Found on traversal or bad mount to obscure file structure
@@ -0,0 +1,29 @@
+#include "mime_types.h"
+
+#include <unordered_map>
+
+namespace mime_types {
+
+// Extension (including the dot), or "" if none
+static std::string extension(const std::string& path) {
+  auto pos = path.find_last_of('.');
+  return pos == std::string::npos ? "" : path.substr(pos);
+}
+
+std::string ContentType(const std::string& path) {
+  // A small static table; falls back to octet-stream
+  static const std::unordered_map<std::string, std::string> m = {
+    {".html","text/html; charset=utf-8"},{".htm","text/html"},
+    {".txt","text/plain; charset=utf-8"},
+    {".css","text/css"},{".js","application/javascript"},
+    {".json","application/json"},{".jpg","image/jpeg"},
+    {".jpeg","image/jpeg"},{".png","image/png"},{".gif","image/gif"},
+    {".svg","image/svg+xml"},{".zip","application/zip"},
+    {".pdf","application/pdf"}, {".md", "text/markdown"},
+    {".log", "text/plain"}
+  };
+  auto it = m.find(extension(path));
+  return it == m.end() ? "application/octet-stream" : it->second;
+}
+
+}  // namespace mime_types
@@ -0,0 +1,119 @@
+#include "open_file_cache.h"
+
+#include <algorithm>
+
+OpenFileCache::OpenFileCache(const OpenFileCacheOptions& options, std::size_t shards,
+                             std::function<Clock::time_point()> now)
+  : options_(options),
+    shard_entries_(std::max<std::size_t>(
+        (options.max_entries + std::max<std::size_t>(shards, 1) - 1) /
+        std::max<std::size_t>(shards, 1), 1)),
+    now_(std::move(now)) {
+  for (std::size_t i = 0; i < std::max<std::size_t>(shards, 1); ++i) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+}
+
+OpenFileCache::Shard& OpenFileCache::ShardFor(const std::string& path) {
+  return *shards_[std::hash<std::string>()(path) % shards_.size()];
+}
+
+void OpenFileCache::Trim(Shard& shard, Clock::time_point now) {
+  auto inactive = std::chrono::seconds(options_.inactive_seconds);
+  while (!shard.lru.empty()) {
+    auto it = shard.index.find(shard.lru.back());
+    if (shard.index.size() <= shard_entries_ && now - it->second.last_used < inactive) break;
+    shard.index.erase(it);
+    shard.lru.pop_back();
+    ++evictions_;
+  }
+}
+
+std::shared_ptr<const FileBody> OpenFileCache::Open(const std::string& path) {
+  if (options_.max_entries == 0) return FileBody::Open(path);
+
+  Shard& shard = ShardFor(path);
+  Clock::time_point now = now_();
+  std::shared_ptr<const FileBody> cached;
+  std::uint64_t generation;
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    generation = shard.generation;
+    auto it = shard.index.find(path);
+    if (it != shard.index.end()) {
+      Entry& entry = it->second;
+      if (now - entry.validated < std::chrono::seconds(options_.valid_seconds)) {
+        entry.last_used = now;
+        shard.lru.splice(shard.lru.begin(), shard.lru, entry.lru);
+        ++hits_;
+        std::shared_ptr<const FileBody> file = entry.file;
+        Trim(shard, now);
+        return file;
+      }
+      cached = entry.file;
+    }
+  }
+
+  // Expired or missing: stat (or open) without holding the lock
+  std::shared_ptr<const FileBody> file;
+  if (cached) {
+    ++revalidations_;
+    FileStat current;
+    if (FileStat::Load(path, current) && cached->stat().SameFile(current)) file = cached;
+  }
+  if (!file) {
+    ++misses_;
+    file = FileBody::Open(path);
+  }
+  // Entries record when their stat was taken
+  now = now_();
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  // Something in the shard was written meanwhile, possibly this file: the
+  // stat may describe it half-written, so it's served but not kept
+  if (shard.generation != generation) return file;
+  auto it = shard.index.find(path);
+  if (!file) {
+    // Gone or unreadable, don't keep a stale descriptor around
+    if (it != shard.index.end()) {
+      shard.lru.erase(it->second.lru);
+      shard.index.erase(it);
+    }
+    return nullptr;
+  }
+  if (it == shard.index.end()) {
+    shard.lru.push_front(path);
+    it = shard.index.emplace(path, Entry{file, now, now, shard.lru.begin()}).first;
+  } else {
+    it->second.file = file;
+    it->second.validated = now;
+    it->second.last_used = now;
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second.lru);
+  }
+  Trim(shard, now);
+  return file;
+}
+
+void OpenFileCache::Invalidate(const std::string& path) {
+  if (options_.max_entries == 0) return;
+  Shard& shard = ShardFor(path);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  ++shard.generation;
+  auto it = shard.index.find(path);
+  if (it == shard.index.end()) return;
+  shard.lru.erase(it->second.lru);
+  shard.index.erase(it);
+}
+
+OpenFileCache::Stats OpenFileCache::GetStats() const {
+  Stats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.revalidations = revalidations_;
+  stats.evictions = evictions_;
+  for (const auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    stats.entries += shard->index.size();
+  }
+  return stats;
+}
@@ -0,0 +1,119 @@
+#include "path_resolver.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <functional>
+#include <stdexcept>
+
+namespace fs = std::filesystem;
+
+PathResolver::PathResolver(std::string prefix, std::string root, bool watch,
+                           std::size_t max_entries, std::size_t shards)
+  : prefix_(std::move(prefix)),
+    root_(std::move(root)),
+    shard_entries_(std::max<std::size_t>(max_entries / std::max<std::size_t>(shards, 1), 1)) {
+  for (std::size_t i = 0; i < std::max<std::size_t>(shards, 1); ++i) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+  // A root that doesn't exist yet is canonicalized per request, as before
+  std::error_code ec;
+  fs::path base = fs::canonical(root_, ec);
+  if (ec) return;
+  base_ = base.string();
+  if (watch) watcher_ = std::make_unique<DirectoryWatcher>(base_);
+}
+
+bool PathResolver::IsClean(std::string_view rest) {
+  if (rest.find('\0') != std::string_view::npos) return false;
+  while (!rest.empty()) {
+    std::size_t slash = rest.find('/');
+    std::string_view segment = rest.substr(0, slash);
+    if (segment.empty() || segment == "." || segment == "..") return false;
+    if (slash == std::string_view::npos) break;
+    rest.remove_prefix(slash + 1);
+  }
+  return true;
+}
+
+PathResolver::Shard& PathResolver::ShardFor(const std::string& rest) const {
+  return *shards_[std::hash<std::string>()(rest) % shards_.size()];
+}
+
+PathResolver::Entry PathResolver::Walk(const std::string& rest) const {
+  // canonicalize base and candidate
+  fs::path base = base_.empty() ? fs::canonical(root_) : fs::path(base_);
+  fs::path full = fs::weakly_canonical(base / rest);
+
+  // ensure full stays under base, on a component boundary
+  std::string b = base.generic_string();
+  std::string f = full.generic_string();
+  if (f.rfind(b, 0) != 0 || (f.size() > b.size() && f[b.size()] != '/' && b != "/")) {
+    return Entry{"", "Path traversal attempt detected"};
+  }
+  return Entry{full.string(), ""};
+}
+
+std::string PathResolver::Resolve(std::string_view url) const {
+  // strip off the URL prefix
+  if (url.substr(0, prefix_.size()) != prefix_) {
+    throw std::runtime_error("No static mount for this path");
+  }
+  std::string_view rest_view = url.substr(prefix_.size());
+  if (!rest_view.empty() && rest_view[0] == '/') rest_view.remove_prefix(1);
+
+  bool watched = watcher_ && watcher_->healthy();
+  if (watched && watcher_->symlink_free() && IsClean(rest_view)) {
+    ++lexical_;
+    std::string path = base_;
+    if (!rest_view.empty()) {
+      if (path != "/") path += '/';
+      path.append(rest_view);
+    }
+    return path;
+  }
+
+  std::string rest(rest_view);
+  if (!watched) {
+    Entry entry = Walk(rest);
+    if (!entry.error.empty()) throw std::runtime_error(entry.error);
+    return entry.path;
+  }
+
+  Shard& shard = ShardFor(rest);
+  std::uint64_t generation = watcher_->generation();
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    if (shard.generation != generation) {
+      shard.index.clear();
+      shard.generation = generation;
+    }
+    auto it = shard.index.find(rest);
+    if (it != shard.index.end()) {
+      ++hits_;
+      if (!it->second.error.empty()) throw std::runtime_error(it->second.error);
+      return it->second.path;
+    }
+  }
+
+  ++misses_;
+  Entry entry = Walk(rest);
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    // Don't cache what the tree looked like before a change that happened
+    // while walking it
+    if (shard.generation == generation && watcher_->generation() == generation) {
+      if (shard.index.size() >= shard_entries_) shard.index.clear();
+      shard.index[rest] = entry;
+    }
+  }
+  if (!entry.error.empty()) throw std::runtime_error(entry.error);
+  return entry.path;
+}
+
+PathResolver::Stats PathResolver::GetStats() const {
+  Stats stats;
+  stats.lexical = lexical_;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  return stats;
+}
@@ -0,0 +1,96 @@
+#include "perfect_hash.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+// Seeds tried per bucket before the table is grown
+static const std::uint32_t kMaxSeed = 1 << 16;
+
+// splitmix64 finalizer, spreads a seeded hash over all bits
+static std::uint64_t mix(std::uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9ULL;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+PerfectHash::PerfectHash(std::vector<std::string_view> keys) : keys_(std::move(keys)) {
+  // Start at 80% load and grow until every bucket fits; distinct keys
+  // practically always fit on the first try
+  std::size_t slot_count = keys_.size() + keys_.size() / 4 + 1;
+  while (!Build(slot_count)) {
+    if (slot_count > 8 * keys_.size() + 64) {
+      throw std::runtime_error("PerfectHash keys are not distinct");
+    }
+    slot_count += slot_count / 2;
+  }
+}
+
+std::uint64_t PerfectHash::Hash(std::string_view key) {
+  // FNV-1a
+  std::uint64_t h = 0xcbf29ce484222325ULL;
+  for (unsigned char c : key) {
+    h ^= c;
+    h *= 0x100000001b3ULL;
+  }
+  return h;
+}
+
+std::size_t PerfectHash::Slot(std::uint64_t h, std::uint32_t seed) const {
+  return mix(h ^ (static_cast<std::uint64_t>(seed) * 0x9e3779b97f4a7c15ULL)) % slots_.size();
+}
+
+bool PerfectHash::Build(std::size_t slot_count) {
+  std::size_t bucket_count = std::max<std::size_t>((keys_.size() + 3) / 4, 1);
+  seeds_.assign(bucket_count, 0);
+  slots_.assign(slot_count, empty_slot);
+
+  std::vector<std::vector<std::uint32_t>> buckets(bucket_count);
+  std::vector<std::uint64_t> hashes(keys_.size());
+  for (std::size_t i = 0; i < keys_.size(); ++i) {
+    hashes[i] = Hash(keys_[i]);
+    buckets[hashes[i] % bucket_count].push_back(static_cast<std::uint32_t>(i));
+  }
+
+  // Fullest buckets first, while most slots are still free
+  std::vector<std::size_t> order(bucket_count);
+  for (std::size_t b = 0; b < bucket_count; ++b) order[b] = b;
+  std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+    return buckets[a].size() > buckets[b].size();
+  });
+
+  std::vector<std::size_t> placed;
+  for (std::size_t b : order) {
+    if (buckets[b].empty()) break;
+    std::uint32_t seed = 0;
+    for (; seed < kMaxSeed; ++seed) {
+      placed.clear();
+      bool fits = true;
+      for (std::uint32_t key : buckets[b]) {
+        std::size_t slot = Slot(hashes[key], seed);
+        if (slots_[slot] != empty_slot ||
+            std::find(placed.begin(), placed.end(), slot) != placed.end()) {
+          fits = false;
+          break;
+        }
+        placed.push_back(slot);
+      }
+      if (fits) break;
+    }
+    if (seed == kMaxSeed) return false;
+    seeds_[b] = seed;
+    for (std::size_t i = 0; i < placed.size(); ++i) slots_[placed[i]] = buckets[b][i];
+  }
+  return true;
+}
+
+std::size_t PerfectHash::Find(std::string_view key) const {
+  if (keys_.empty()) return npos;
+  std::uint64_t h = Hash(key);
+  std::uint32_t index = slots_[Slot(h, seeds_[h % seeds_.size()])];
+  if (index == empty_slot || keys_[index] != key) return npos;
+  return index;
+}
+
+std::size_t PerfectHash::size() const { return keys_.size(); }
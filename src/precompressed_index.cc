@@ -0,0 +1,60 @@
+#include "precompressed_index.h"
+
+#include <algorithm>
+#include <functional>
+
+PrecompressedIndex::PrecompressedIndex(std::size_t max_entries, std::size_t shards)
+  : shard_entries_(std::max<std::size_t>(max_entries / std::max<std::size_t>(shards, 1), 1)) {
+  for (std::size_t i = 0; i < std::max<std::size_t>(shards, 1); ++i) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+}
+
+PrecompressedIndex::Shard& PrecompressedIndex::ShardFor(const std::string& path) {
+  return *shards_[std::hash<std::string>()(path) % shards_.size()];
+}
+
+PrecompressedIndex::Siblings PrecompressedIndex::Probe(const std::string& path,
+                                                       const FileStat& base) {
+  Siblings siblings;
+  for (int c = content_encoding::GZIP; c < content_encoding::NUM_CODINGS; ++c) {
+    auto coding = static_cast<content_encoding::Coding>(c);
+    if (*content_encoding::Suffix(coding) == '\0') continue;
+    FileStat st;
+    if (FileStat::Load(path + content_encoding::Suffix(coding), st) && st.regular &&
+        st.mtime_ns >= base.mtime_ns) {
+      siblings.available |= content_encoding::Bit(coding);
+      siblings.stat[coding] = st;
+    }
+  }
+  return siblings;
+}
+
+PrecompressedIndex::Siblings PrecompressedIndex::Lookup(const std::string& path,
+                                                        const FileStat& base) {
+  Shard& shard = ShardFor(path);
+  {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.index.find(path);
+    if (it != shard.index.end() && it->second.base.SameFile(base)) return it->second.siblings;
+  }
+
+  // Probe without holding the lock; racing threads just probe twice
+  ++probes_;
+  Siblings siblings = Probe(path, base);
+
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  // Entries are tiny, so a full shard is simply started over rather than
+  // tracked for recency
+  if (shard.index.size() >= shard_entries_ && !shard.index.count(path)) shard.index.clear();
+  shard.index[path] = Entry{base, siblings};
+  return siblings;
+}
+
+void PrecompressedIndex::Invalidate(const std::string& path) {
+  Shard& shard = ShardFor(path);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  shard.index.erase(path);
+}
+
+std::uint64_t PrecompressedIndex::probes() const { return probes_; }
@@ -0,0 +1,129 @@
+#include "preloaded_root.h"
+#include "file_body.h"
+#include "logger.h"
+#include "validators.h"
+
+#include <filesystem>
+#include <sys/mman.h>
+
+namespace fs = std::filesystem;
+
+// True if path is base or below it
+static bool isWithin(const fs::path& path, const fs::path& base) {
+  const std::string& p = path.native();
+  const std::string& b = base.native();
+  return p.compare(0, b.size(), b) == 0 &&
+         (p.size() == b.size() || p[b.size()] == '/' || b == "/");
+}
+
+std::shared_ptr<const PreloadedRoot> PreloadedRoot::Load(
+    const std::string& prefix, const std::string& root,
+    const std::function<std::string(const std::string&)>& content_type) {
+  fs::path base = fs::canonical(root);
+  std::string url_base = prefix;
+  while (!url_base.empty() && url_base.back() == '/') url_base.pop_back();
+
+  // Size everything first so the arena is allocated once
+  std::vector<fs::path> paths;
+  std::size_t estimate = 0;
+  for (const auto& entry :
+       fs::recursive_directory_iterator(base, fs::directory_options::skip_permission_denied)) {
+    std::error_code ec;
+    if (!entry.is_regular_file(ec)) continue;
+    if (entry.is_symlink(ec) && !isWithin(fs::canonical(entry.path(), ec), base)) {
+      Logger::log_warning("Not preloading " + entry.path().string() + ", it links out of " +
+                          base.string());
+      continue;
+    }
+    paths.push_back(entry.path());
+    estimate += entry.file_size(ec) + entry.path().native().size() + 256;
+  }
+
+  std::string arena;
+  arena.reserve(estimate);
+  std::vector<Extent> extents;
+  extents.reserve(paths.size());
+  for (const auto& path : paths) {
+    auto file = FileBody::Open(path.string());
+    if (!file) {
+      Logger::log_warning("Not preloading unreadable " + path.string());
+      continue;
+    }
+    std::string body = file->Read(0, file->size());
+    if (body.size() != file->size()) {
+      Logger::log_warning("Not preloading " + path.string() + ", it changed while being read");
+      continue;
+    }
+
+    Extent extent;
+    extent.etag = validators::ETag(file->stat());
+    extent.last_modified = validators::LastModified(file->stat());
+    std::string url = url_base + "/" + path.lexically_relative(base).generic_string();
+    std::string head = "HTTP/1.1 200 OK\r\n"
+                       "Content-Type: " + content_type(path.string()) + "\r\n"
+                       "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                       "ETag: " + extent.etag + "\r\n"
+                       "Last-Modified: " + validators::HttpDate(extent.last_modified) + "\r\n"
+                       "Accept-Ranges: bytes\r\n";
+
+    extent.url = arena.size();
+    extent.url_length = url.size();
+    arena += url;
+    extent.head = arena.size();
+    extent.head_length = head.size();
+    arena += head;
+    extent.body = arena.size();
+    extent.body_length = body.size();
+    arena += body;
+    extents.push_back(std::move(extent));
+  }
+  return std::shared_ptr<const PreloadedRoot>(new PreloadedRoot(std::move(arena), extents));
+}
+
+PreloadedRoot::PreloadedRoot(std::string arena, const std::vector<Extent>& extents)
+  : arena_(std::move(arena)),
+    files_(MakeFiles(extents)),
+    index_(Urls()) {
+  // Keeps the site from being paged out; needs CAP_IPC_LOCK or a high
+  // enough RLIMIT_MEMLOCK, and serving works the same without it
+  pinned_ = !arena_.empty() && ::mlock(arena_.data(), arena_.size()) == 0;
+}
+
+PreloadedRoot::~PreloadedRoot() {
+  if (pinned_) ::munlock(arena_.data(), arena_.size());
+}
+
+std::vector<PreloadedRoot::File> PreloadedRoot::MakeFiles(
+    const std::vector<Extent>& extents) const {
+  std::string_view arena(arena_);
+  std::vector<File> files;
+  files.reserve(extents.size());
+  for (const auto& extent : extents) {
+    File file;
+    file.url = arena.substr(extent.url, extent.url_length);
+    file.head = arena.substr(extent.head, extent.head_length);
+    file.body = arena.substr(extent.body, extent.body_length);
+    file.etag = extent.etag;
+    file.last_modified = extent.last_modified;
+    files.push_back(std::move(file));
+  }
+  return files;
+}
+
+std::vector<std::string_view> PreloadedRoot::Urls() const {
+  std::vector<std::string_view> urls;
+  urls.reserve(files_.size());
+  for (const auto& file : files_) urls.push_back(file.url);
+  return urls;
+}
+
+const PreloadedRoot::File* PreloadedRoot::Find(std::string_view url) const {
+  std::size_t index = index_.Find(url.substr(0, url.find('?')));
+  return index == PerfectHash::npos ? nullptr : &files_[index];
+}
+
+std::size_t PreloadedRoot::size() const { return files_.size(); }
+
+std::size_t PreloadedRoot::bytes() const { return arena_.size(); }
+
+bool PreloadedRoot::pinned() const { return pinned_; }
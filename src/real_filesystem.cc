@@ -1,7 +1,25 @@
 #include "real_filesystem.h"
 #include <fstream>
+#include <mutex>
 #include <stdexcept>
 
+static std::mutex default_mutex;
+static std::shared_ptr<RealFileSystem> default_filesystem;
+
+RealFileSystem::RealFileSystem(std::shared_ptr<OpenFileCache> cache) : cache_(std::move(cache)) {}
+
+std::shared_ptr<RealFileSystem> RealFileSystem::Default() {
+    std::lock_guard<std::mutex> lock(default_mutex);
+    if (!default_filesystem) default_filesystem = std::make_shared<RealFileSystem>();
+    return default_filesystem;
+}
+
+void RealFileSystem::SetDefault(std::shared_ptr<RealFileSystem> filesystem) {
+    std::lock_guard<std::mutex> lock(default_mutex);
+    default_filesystem = std::move(filesystem);
+}
+
+const OpenFileCache* RealFileSystem::cache() const { return cache_.get(); }
 
 bool RealFileSystem::exists(const fs::path& path) const {
     return fs::exists(path);
@@ -20,6 +38,7 @@ bool RealFileSystem::create_directories(const fs::path& path) const {
 }
 
 bool RealFileSystem::remove(const fs::path& path) const {
+    if (cache_) cache_->Invalidate(path.string());
     return fs::remove(path);
 }
 
@@ -44,6 +63,14 @@ std::vector<fs::path> RealFileSystem::directory_entries(const fs::path& path) co
 }
 
 std::string RealFileSystem::read_file(const fs::path& path) const {
+    if (cache_) {
+        // Positional read from the shared descriptor, no open/close
+        auto body = cache_->Open(path.string());
+        if (!body) {
+            throw std::runtime_error("Failed to open file for reading: " + path.string());
+        }
+        return body->Read(0, body->size());
+    }
     std::ifstream file(path);
     if (!file) {
         throw std::runtime_error("Failed to open file for reading: " + path.string());
@@ -52,10 +79,30 @@ std::string RealFileSystem::read_file(const fs::path& path) const {
 }
 
 bool RealFileSystem::write_file(const fs::path& path, const std::string& content) const {
+    return write_file(path, std::string_view(content));
+}
+
+bool RealFileSystem::write_file(const fs::path& path, std::string_view content) const {
     std::ofstream file(path);
     if (!file) {
         return false;
     }
-    file << content;
+    file.write(content.data(), content.size());
+    file.close();
+    // The cached descriptor is the same inode, but its stat is stale
+    if (cache_) cache_->Invalidate(path.string());
     return file.good();
+}
+
+std::shared_ptr<const FileBody> RealFileSystem::open_file(const fs::path& path) const {
+    if (cache_) return cache_->Open(path.string());
+    return FileBody::Open(path.string());
+}
+
+bool RealFileSystem::stat_file(const fs::path& path, FileStat& out) const {
+    if (!cache_) return FileStat::Load(path.string(), out) && out.regular;
+    auto body = cache_->Open(path.string());
+    if (!body) return false;
+    out = body->stat();
+    return true;
 }
\ No newline at end of file
@@ -4,109 +4,126 @@
 #include <vector>
 #include <set>
 
-static void getLine(std::string& request, std::string& line) {
-  // Find first instance of \n 
-  auto eol= request.find("\n");
-  line = request.substr(0, eol);
-  // Don't include \r if line ends with \r\n
-  if (line.back() == '\r') line.pop_back();
-  // Remove line from request
-  request = request.substr(eol + 1);
-}
+namespace {
 
-static bool isValidMethod(const std::string& method) {
-  static const std::set<std::string> supported_methods = {
+bool isValidMethod(std::string_view method) {
+  static const std::set<std::string, std::less<>> supported_methods = {
     "GET", "POST", "PUT", "DELETE", "HEAD"
   };
   return (supported_methods.find(method) != supported_methods.end());
 }
 
-static bool isValidVersion(const std::string& version) {
-  static const std::set<std::string> supported_versions = {
+bool isValidVersion(std::string_view version) {
+  static const std::set<std::string, std::less<>> supported_versions = {
     "HTTP/1.0", "HTTP/1.1"
   };
   return (supported_versions.find(version) != supported_versions.end());
 }
 
-Request::Request(const std::string& request) {
-  // Grab the request line (up to CR/LF or LF)
-  std::string req = request;
-  std::string line;
-  getLine(req, line);
+}  // namespace
 
-  // Split the request line by space 
-  std::vector<std::string> line_tokens;
-  boost::split(line_tokens, line, boost::is_any_of(" "));
-  if (line_tokens.size() != 3) { valid_request_ = false; return; }
-  method_ = line_tokens[0];
-  url_ = line_tokens[1];
-  http_version_ = line_tokens[2]; 
+Request::Request(const std::string& request)
+  : owned_text_(std::make_shared<const std::string>(request)),
+    raw_text_(*owned_text_) {
+  // Standalone text (not framed by a session): everything after the blank
+  // line is the body, and a missing blank line still leaves the headers
+  RequestParser parser;
+  parser.Parse(*owned_text_);
+  Init(parser.layout());
+}
 
-  // Check that method and version are valid
-  if (!isValidMethod(method_) || !isValidVersion(http_version_)) { valid_request_ = false; return; }
+Request::Request(std::string_view request, const RequestLayout& layout)
+  : raw_text_(request) {
+  Init(layout);
+}
+
+Request Request::Detach() const {
+  if (owned_text_) return *this;
+  Request copy = *this;
+  copy.owned_text_ = std::make_shared<const std::string>(raw_text_);
+  copy.raw_text_ = *copy.owned_text_;
+  // Every view lies within raw_text_, move it to the same offset in the copy
+  auto rebase = [&](std::string_view view) {
+    if (view.data() == nullptr) return view;
+    return copy.raw_text_.substr(view.data() - raw_text_.data(), view.size());
+  };
+  copy.method_ = rebase(method_);
+  copy.url_ = rebase(url_);
+  copy.http_version_ = rebase(http_version_);
+  copy.body_ = rebase(body_);
+  for (auto& header : copy.headers_) {
+    header.first = rebase(header.first);
+    header.second = rebase(header.second);
+  }
+  return copy;
+}
 
-  // For remaining lines, map headers to their values
-  // If end of request headers, only remaining part will be \r\n or \n
-  while (req != "\r\n" && req != "\n" && !req.empty()) {
-    getLine(req, line);
-    if (line.empty()) break;
+void Request::Init(const RequestLayout& layout) {
+  valid_request_ = false;
+  if (!layout.request_line_ok || !layout.headers_ok) return;
+
+  auto view = [this](const RequestLayout::Span& span) {
+    return raw_text_.substr(span.offset, span.length);
+  };
+  method_ = view(layout.method);
+  url_ = view(layout.url);
+  http_version_ = view(layout.version);
 
-    auto split = line.find(":");
-    if (split == std::string::npos) { valid_request_ = false; return; }
-    std::string header_name = line.substr(0, split);
+  // Check that method and version are valid
+  if (!isValidMethod(method_) || !isValidVersion(http_version_)) return;
+
+  // Map headers to their values
+  headers_.reserve(layout.headers.size());
+  for (const auto& header : layout.headers) {
+    std::string_view header_name = view(header.name);
     // if header name has any spaces, request is invalid
-    if (header_name.find(" ") != std::string::npos) { valid_request_ = false; return; }
-    // if header is duplicated, request is invalid
-    if (headers_.find(header_name) != headers_.end()) { valid_request_ = false; return; }
-    // if header value is empty after colon, i.e "" or " ", value set to empty string
-    if (split + 2 >= line.length()) { headers_[header_name] = ""; continue; }
-    headers_[header_name] = line.substr(split + 2); // Don't include space following colon
-  }
-  raw_text_ = request;
-  length_ = request.length();
-
-  // Extract body from request (everything after headers)
-  size_t header_end = request.find("\r\n\r\n");
-  if (header_end != std::string::npos) {
-    body_ = request.substr(header_end + 4);  // Skip over \r\n\r\n
-  } else {
-    header_end = request.find("\n\n");
-    if (header_end != std::string::npos) {
-      body_ = request.substr(header_end + 2);  // Skip over \n\n
+    if (header_name.find(' ') != std::string_view::npos) return;
+    // if header is duplicated, request is invalid; names are
+    // case-insensitive (RFC 7230 section 3.2)
+    for (const auto& existing : headers_) {
+      if (boost::iequals(existing.first, header_name)) return;
     }
+    headers_.emplace_back(header_name, view(header.value));
+  }
+  length_ = raw_text_.length();
+
+  // Body is everything after the blank line ending the headers
+  if (layout.headers_complete) {
+    body_ = raw_text_.substr(layout.body_offset);
   }
 
   valid_request_ = true;
 }
 
-std::string Request::get_method() const { 
+std::string_view Request::get_method() const { 
   if (!valid_request_) return "N/A";
   return method_; 
 }
 
-std::string Request::get_url() const { 
+std::string_view Request::get_url() const { 
   if (!valid_request_) return "N/A";
   return url_; 
 }
 
-std::string Request::get_version() const { 
+std::string_view Request::get_version() const { 
   if (!valid_request_) return "N/A";
   return http_version_; 
 }
 
-std::string Request::get_header(const std::string& header_name) const { 
+std::string_view Request::get_header(std::string_view header_name) const { 
   if (!valid_request_) return "N/A";
-  if (headers_.find(header_name) != headers_.end())
-    return headers_.at(header_name);
+  for (const auto& header : headers_) {
+    if (boost::iequals(header.first, header_name)) return header.second;
+  }
   return "";
 }
 
-std::string Request::get_body() const { 
+std::string_view Request::get_body() const { 
   if (!valid_request_) return "N/A";
   return body_; 
 }
 
-std::string Request::to_string() const { 
+std::string_view Request::to_string() const { 
   if (!valid_request_) return "N/A";
   return raw_text_; 
 }
@@ -118,4 +135,11 @@ int Request::length() const {
   return length_;
 }
 
-
+bool Request::keep_alive() const {
+  if (!valid_request_) return false;
+  std::string_view connection = get_header("Connection");
+  if (http_version_ == "HTTP/1.0") {
+    return boost::iequals(connection, "keep-alive");
+  }
+  return !boost::iequals(connection, "close");
+}
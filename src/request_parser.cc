@@ -0,0 +1,160 @@
+#include "request_parser.h"
+#include "header_scan.h"
+
+#include <cctype>
+
+// Case-insensitive comparison of buf[offset, offset + length) with name
+static bool spanEquals(const std::string& buf, std::size_t offset, std::size_t length,
+                       const char* name) {
+  std::size_t i = 0;
+  for (; i < length; ++i) {
+    if (name[i] == '\0') return false;
+    if (std::tolower(static_cast<unsigned char>(buf[offset + i])) !=
+        std::tolower(static_cast<unsigned char>(name[i]))) return false;
+  }
+  return name[i] == '\0';
+}
+
+RequestParser::Result RequestParser::Parse(const std::string& buf) {
+  const std::size_t size = buf.size();
+  const char* data = buf.data();
+
+  // Empty lines ahead of a request line are ignored (RFC 7230 3.5), some
+  // clients send a stray CRLF after a request body
+  if (state_ == STATE_REQUEST_LINE && pos_ == begin_) {
+    while (pos_ < size && (data[pos_] == '\r' || data[pos_] == '\n')) ++pos_;
+    begin_ = pos_;
+    line_start_ = pos_;
+  }
+
+  while (state_ != STATE_BODY && pos_ < size) {
+    // Jump straight to the next byte that can change state: spaces only
+    // matter on the request line, and only the first colon of a header line
+    char wanted = '\n';
+    if (state_ == STATE_REQUEST_LINE) wanted = ' ';
+    else if (colon_ == std::string::npos) wanted = ':';
+    pos_ = header_scan::FindEither(data + pos_, data + size, '\n', wanted) - data;
+    if (pos_ == size) break;
+
+    const char c = buf[pos_];
+    if (c == '\n') {
+      // Line content excludes the LF and an optional preceding CR
+      std::size_t end = (pos_ > line_start_ && buf[pos_ - 1] == '\r') ? pos_ - 1 : pos_;
+
+      if (state_ == STATE_REQUEST_LINE) {
+        // Request line must be exactly "<method> <url> <version>"
+        if (first_space_ != std::string::npos && second_space_ != std::string::npos &&
+            extra_spaces_ == 0 && second_space_ < end) {
+          layout_.request_line_ok = true;
+          layout_.method  = {line_start_ - begin_, first_space_ - line_start_};
+          layout_.url     = {first_space_ + 1 - begin_, second_space_ - first_space_ - 1};
+          layout_.version = {second_space_ + 1 - begin_, end - second_space_ - 1};
+        }
+        state_ = STATE_HEADER_LINE;
+      } else if (end == line_start_) {
+        // Blank line ends the headers
+        layout_.headers_complete = true;
+        layout_.body_offset = pos_ + 1 - begin_;
+        state_ = STATE_BODY;
+      } else {
+        FinishHeaderLine(buf, end);
+      }
+      line_start_ = pos_ + 1;
+      colon_ = std::string::npos;
+    } else if (state_ == STATE_REQUEST_LINE && c == ' ') {
+      if (first_space_ == std::string::npos) first_space_ = pos_;
+      else if (second_space_ == std::string::npos) second_space_ = pos_;
+      else ++extra_spaces_;
+    } else if (state_ == STATE_HEADER_LINE && c == ':' && colon_ == std::string::npos) {
+      colon_ = pos_;
+    }
+    ++pos_;
+  }
+
+  // Checked even once the headers are complete, so the limit doesn't
+  // depend on how the bytes were split across reads
+  if (state_ != STATE_BODY) return pos_ - begin_ > kMaxHeaderBytes ? TOO_LARGE : INCOMPLETE;
+  if (layout_.body_offset > kMaxHeaderBytes) return TOO_LARGE;
+
+  // Body bytes are never examined, only counted
+  if (size - begin_ < request_length()) return INCOMPLETE;
+  pos_ = begin_ + request_length();
+  return COMPLETE;
+}
+
+void RequestParser::FinishHeaderLine(const std::string& buf, std::size_t end) {
+  if (colon_ == std::string::npos) {
+    layout_.headers_ok = false;
+    return;
+  }
+
+  // Skip optional whitespace after the colon
+  std::size_t value_start = colon_ + 1;
+  while (value_start < end && (buf[value_start] == ' ' || buf[value_start] == '\t'))
+    ++value_start;
+
+  RequestLayout::Header header;
+  header.name  = {line_start_ - begin_, colon_ - line_start_};
+  header.value = {value_start - begin_, end - value_start};
+  layout_.headers.push_back(header);
+
+  if (spanEquals(buf, line_start_, colon_ - line_start_, "Content-Length")) {
+    // Reject anything but a plain decimal number, framing would be ambiguous
+    std::size_t length = 0;
+    std::size_t digits = end - value_start;
+    if (digits == 0 || digits > 18) { layout_.headers_ok = false; return; }
+    for (std::size_t i = value_start; i < end; ++i) {
+      if (!std::isdigit(static_cast<unsigned char>(buf[i]))) { layout_.headers_ok = false; return; }
+      length = length * 10 + (buf[i] - '0');
+    }
+    // Differing values leave no telling where the body ends
+    if (content_length_seen_ && length != layout_.content_length) {
+      layout_.headers_ok = false;
+      return;
+    }
+    content_length_seen_ = true;
+    layout_.content_length = length;
+  } else if (spanEquals(buf, line_start_, colon_ - line_start_, "Transfer-Encoding")) {
+    layout_.transfer_encoding = true;
+  }
+}
+
+const RequestLayout& RequestParser::layout() const { return layout_; }
+
+std::size_t RequestParser::request_begin() const { return begin_; }
+
+std::size_t RequestParser::request_length() const {
+  if (layout_.transfer_encoding) return layout_.body_offset;
+  return layout_.body_offset + layout_.content_length;
+}
+
+void RequestParser::Next() { Restart(begin_ + request_length()); }
+
+void RequestParser::Reset() { Restart(0); }
+
+void RequestParser::Restart(std::size_t begin) {
+  begin_ = begin;
+  pos_ = begin_;
+  line_start_ = begin_;
+  first_space_ = std::string::npos;
+  second_space_ = std::string::npos;
+  extra_spaces_ = 0;
+  colon_ = std::string::npos;
+  content_length_seen_ = false;
+  state_ = STATE_REQUEST_LINE;
+  // Reuses the header vector rather than allocating one per request
+  std::vector<RequestLayout::Header> headers = std::move(layout_.headers);
+  headers.clear();
+  layout_ = RequestLayout();
+  layout_.headers = std::move(headers);
+}
+
+void RequestParser::Rebase(std::size_t n) {
+  // Layout offsets are relative to begin_, only absolute positions move
+  begin_ -= n;
+  pos_ -= n;
+  line_start_ -= n;
+  if (first_space_ != std::string::npos) first_space_ -= n;
+  if (second_space_ != std::string::npos) second_space_ -= n;
+  if (colon_ != std::string::npos) colon_ -= n;
+}
@@ -1,39 +1,203 @@
 #include "response.h"
 
-Response::Response(const std::string& version, 
+Response::Response(std::string_view version, 
                    int status_code,
                    std::string content_type,
-                   int content_length,
+                   std::size_t content_length,
                    std::string connection,
                    std::string body,
                    std::string handler_type):
                    status_code_(status_code),
-                   content_type_(content_type),
+                   content_type_(std::move(content_type)),
                    content_length_(content_length),
-                   connection_(connection),
-                   body_(body),
-                   handler_type_(handler_type)
+                   connection_(std::move(connection)),
+                   body_(std::move(body)),
+                   handler_type_(std::move(handler_type))
 {
-    status_line_ = version + " " + status_messages_.at(status_code);
+    status_line_ = std::string(version) + " " + status_messages_.at(status_code);
 }
 
 std::string Response::to_string() const {
-    std::string response = status_line_ + "\r\n";
-    response += "Content-Type: " + content_type_ + "\r\n";
-    response += "Content-Length: " + std::to_string(content_length_) + "\r\n";
-    response += "Connection: " + connection_ + "\r\n\r\n";
-    response += body_;
+    std::string response;
+    append_to(response);
     return response;
 }
 
+void Response::append_to(std::string& out) const {
+    append_header_string(out);
+    if (status_code_ == 304) return;
+    if (prebuilt_owner_) out += prebuilt_body_;
+    else if (!file_slices_.empty()) {
+        for (const auto& slice : file_slices_) {
+            out += slice.lead;
+            if (slice.mapping) out.append(slice.mapping->data() + slice.offset, slice.length);
+            else out += slice.file->Read(slice.offset, slice.length);
+        }
+        out += file_tail_;
+    }
+    else if (shared_body_) out += *shared_body_;
+    else out += body_;
+}
+
+std::string Response::header_string() const {
+    std::string response;
+    append_header_string(response);
+    return response;
+}
+
+void Response::append_header_string(std::string& out) const {
+    if (!prebuilt_head_.empty()) {
+        out += prebuilt_head_;
+        append_header_tail(out);
+        return;
+    }
+    out += status_line_;
+    out += "\r\n";
+    // Not Modified describes the client's copy, there's no body to describe
+    if (status_code_ != 304) {
+        if (header_block_) {
+            out += *header_block_;
+        } else {
+            if (!content_type_.empty()) {
+                out += "Content-Type: ";
+                out += content_type_;
+                out += "\r\n";
+            }
+            out += "Content-Length: ";
+            out += std::to_string(content_length_);
+            out += "\r\n";
+        }
+    }
+    append_header_tail(out);
+}
+
+std::string Response::header_tail() const {
+    std::string tail;
+    append_header_tail(tail);
+    return tail;
+}
+
+void Response::append_header_tail(std::string& out) const {
+    for (const auto& header : extra_headers_) {
+        out += header.first;
+        out += ": ";
+        out += header.second;
+        out += "\r\n";
+    }
+    out += "Connection: ";
+    out += connection_;
+    out += "\r\n\r\n";
+}
+
+void Response::set_prebuilt(std::shared_ptr<const void> owner, std::string_view head,
+                            std::string_view body) {
+    content_length_ = body.size();
+    body_.clear();
+    prebuilt_owner_ = std::move(owner);
+    prebuilt_head_ = head;
+    prebuilt_body_ = body;
+}
+
+const std::shared_ptr<const void>& Response::get_prebuilt_owner() const { return prebuilt_owner_; }
+
+std::string_view Response::get_prebuilt_head() const { return prebuilt_head_; }
+
+std::string_view Response::get_prebuilt_body() const { return prebuilt_body_; }
+
+void Response::set_file_body(std::shared_ptr<const FileBody> file) {
+    std::size_t size = file->size();
+    set_file_slices({FileSlice{"", std::move(file), 0, size}});
+}
+
+void Response::set_mapped_body(std::shared_ptr<const MappedFile> mapping) {
+    std::size_t size = mapping->size();
+    set_file_slices({FileSlice{"", nullptr, 0, size, std::move(mapping)}});
+}
+
+void Response::set_file_slices(std::vector<FileSlice> slices, std::string tail) {
+    content_length_ = tail.size();
+    for (const auto& slice : slices) content_length_ += slice.lead.size() + slice.length;
+    body_.clear();
+    file_slices_ = std::move(slices);
+    file_tail_ = std::move(tail);
+}
+
+std::shared_ptr<const FileBody> Response::get_file_body() const {
+    return file_slices_.empty() ? nullptr : file_slices_.front().file;
+}
+
+const std::vector<FileSlice>& Response::get_file_slices() const { return file_slices_; }
+
+const std::string& Response::get_file_tail() const { return file_tail_; }
+
+const std::string& Response::get_body() const { return body_; }
+
+void Response::set_body(std::string body) {
+    content_length_ = body.size();
+    body_ = std::move(body);
+    shared_body_.reset();
+    prebuilt_owner_.reset();
+    prebuilt_head_ = {};
+    prebuilt_body_ = {};
+    file_slices_.clear();
+    file_tail_.clear();
+}
+
+const std::string& Response::get_content_type() const { return content_type_; }
+
+void Response::set_shared_body(std::shared_ptr<const std::string> body) {
+    content_length_ = body->size();
+    body_.clear();
+    shared_body_ = std::move(body);
+}
+
+const std::shared_ptr<const std::string>& Response::get_shared_body() const { return shared_body_; }
+
+void Response::add_header(const std::string& name, const std::string& value) {
+    extra_headers_.emplace_back(name, value);
+}
+
+std::string Response::get_header(const std::string& name) const {
+    for (const auto& header : extra_headers_) {
+        if (header.first == name) return header.second;
+    }
+    return "";
+}
+
+void Response::set_header(const std::string& name, const std::string& value) {
+    for (auto& header : extra_headers_) {
+        if (header.first == name) {
+            header.second = value;
+            return;
+        }
+    }
+    add_header(name, value);
+}
+
+bool Response::has_header_block() const { return header_block_ != nullptr; }
+
+void Response::set_header_block(std::shared_ptr<const std::string> block) {
+    header_block_ = std::move(block);
+}
+
 int Response::get_status_code() const { return status_code_; }
 
 std::string Response::get_handler_type() const { return handler_type_; }
 
+std::string Response::get_connection() const { return connection_; }
+
+void Response::set_connection(const std::string& connection) { connection_ = connection; }
+
 const std::unordered_map<int, std::string> Response::status_messages_ = {
     {200, "200 OK"},
+    {206, "206 Partial Content"},
+    {301, "301 Moved Permanently"},
+    {304, "304 Not Modified"},
     {400, "400 Bad Request"},
     {403, "403 Forbidden"},
     {404, "404 Not Found"},
-    {500, "500 Internal Server Error"}
+    {416, "416 Range Not Satisfiable"},
+    {431, "431 Request Header Fields Too Large"},
+    {500, "500 Internal Server Error"},
+    {501, "501 Not Implemented"}
 };
\ No newline at end of file
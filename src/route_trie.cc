@@ -0,0 +1,93 @@
+#include "route_trie.h"
+
+#include <algorithm>
+
+// A prefix ending at pos of rest matches if the next byte starts a new
+// segment or the query string
+static bool atBoundary(std::string_view rest, std::size_t pos) {
+  return pos == rest.size() || rest[pos] == '/' || rest[pos] == '?';
+}
+
+RouteTrie::RouteTrie() : root_(std::make_unique<Node>()) {}
+
+RouteTrie::~RouteTrie() = default;
+
+RouteTrie::Node* RouteTrie::FindChild(const Node& node, char c) {
+  auto it = std::lower_bound(node.children.begin(), node.children.end(), c,
+                             [](const std::unique_ptr<Node>& child, char ch) {
+                               return child->label[0] < ch;
+                             });
+  if (it == node.children.end() || (*it)->label[0] != c) return nullptr;
+  return it->get();
+}
+
+bool RouteTrie::Insert(std::string_view prefix, std::size_t value) {
+  if (!prefix.empty() && prefix[0] == '/') prefix.remove_prefix(1);
+
+  Node* node = root_.get();
+  while (!prefix.empty()) {
+    Node* child = FindChild(*node, prefix[0]);
+    if (!child) {
+      // No edge shares a byte with the rest of the key, hang it off here
+      auto leaf = std::make_unique<Node>();
+      leaf->label = std::string(prefix);
+      auto pos = std::lower_bound(node->children.begin(), node->children.end(), prefix[0],
+                                  [](const std::unique_ptr<Node>& c, char ch) {
+                                    return c->label[0] < ch;
+                                  });
+      node = node->children.insert(pos, std::move(leaf))->get();
+      break;
+    }
+
+    // Length of the common part of the edge and the key
+    std::size_t common = 0;
+    std::size_t limit = std::min(child->label.size(), prefix.size());
+    while (common < limit && child->label[common] == prefix[common]) ++common;
+
+    if (common < child->label.size()) {
+      // Split the edge so the key ends at, or branches from, a node
+      auto tail = std::make_unique<Node>();
+      tail->label = child->label.substr(common);
+      tail->has_value = child->has_value;
+      tail->value = child->value;
+      tail->children = std::move(child->children);
+
+      child->label.resize(common);
+      child->has_value = false;
+      child->children.clear();
+      child->children.push_back(std::move(tail));
+    }
+    node = child;
+    prefix.remove_prefix(common);
+  }
+
+  if (node->has_value) return false;
+  node->has_value = true;
+  node->value = value;
+  return true;
+}
+
+bool RouteTrie::Match(std::string_view url, std::size_t& value) const {
+  std::string_view rest = url;
+  if (!rest.empty() && rest[0] == '/') rest.remove_prefix(1);
+
+  // The root is "/", which matches every path
+  const Node* node = root_.get();
+  bool found = node->has_value;
+  if (found) value = node->value;
+
+  std::size_t pos = 0;
+  while (pos < rest.size()) {
+    const Node* child = FindChild(*node, rest[pos]);
+    if (!child) break;
+    const std::string& label = child->label;
+    if (rest.compare(pos, label.size(), label) != 0) break;
+    pos += label.size();
+    node = child;
+    if (node->has_value && atBoundary(rest, pos)) {
+      found = true;
+      value = node->value;
+    }
+  }
+  return found;
+}
@@ -1,14 +1,50 @@
 #include "router.h"
+#include "compression_filter.h"
 #include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <stdexcept>
+
+// Route ids are never reused, even across Router instances
+static std::atomic<std::uint64_t> next_route_id{1};
 
 void Router::add_route(const std::string& path_prefix,
                        Factory factory,
-                       std::unordered_map<std::string,std::string> params) {
-  routes_.push_back(RouteEntry{
+                       std::unordered_map<std::string,std::string> params,
+                       HandlerRegistry::Sharing sharing,
+                       HandlerRegistry::Blocking blocking) {
+  RouteEntry entry{
     sanitize_path(path_prefix),
     std::move(factory),
-    std::move(params)
-  });
+    std::move(params),
+    sharing,
+    blocking,
+    nullptr,
+    next_route_id++,
+    {}
+  };
+  auto blocking_it = entry.params.find("blocking");
+  if (blocking_it != entry.params.end()) {
+    if (blocking_it->second != "on" && blocking_it->second != "off") {
+      throw std::runtime_error("'blocking' must be on or off for location " + entry.prefix);
+    }
+    if (blocking_it->second == "on") entry.blocking = HandlerRegistry::BLOCKING;
+    else if (entry.blocking == HandlerRegistry::BLOCKING) entry.blocking = HandlerRegistry::NON_BLOCKING;
+  }
+  if (auto compression = CompressionFilter::FromParams(entry.prefix, entry.params)) {
+    entry.filters.push_back(std::move(compression));
+  }
+  if (sharing == HandlerRegistry::SHARED) {
+    entry.shared.reset(entry.factory(entry.prefix, entry.params));
+    if (entry.blocking == HandlerRegistry::ASYNC &&
+        !dynamic_cast<AsyncRequestHandler*>(entry.shared.get())) {
+      throw std::runtime_error("Handler for location " + entry.prefix +
+                               " is declared async but isn't an AsyncRequestHandler");
+    }
+  }
+  // A duplicate prefix keeps routing to the route added first
+  trie_.Insert(entry.prefix, routes_.size());
+  routes_.push_back(std::move(entry));
 }
 
 std::vector<std::string> Router::get_routes() const {
@@ -18,31 +54,101 @@ std::vector<std::string> Router::get_routes() const {
 }
 
 Response Router::handle_request(const Request& request) const {
-  const std::string path = sanitize_path(request.get_url());
-
-  // find longest‐matching prefix
-  const RouteEntry* best = nullptr;
-  size_t best_len = 0;
-  for (auto& e : routes_) {
-    if (path.rfind(e.prefix, 0) == 0 && e.prefix.size() > best_len) {
-      best = &e;
-      best_len = e.prefix.size();
-    }
-  }
+  // Match on the raw URL (the trie implies a missing leading slash), so
+  // nothing is copied per request
+  std::size_t index = 0;
 
   //Expect the NotFoundHandler to be registered at '/'
   //If no match is found, we have a configuration error
-  if (!best) {
+  if (!trie_.Match(request.get_url(), index)) {
     return Response(request.get_version(), 500, // Returns a 500 Internal Server Error in this case
                    "text/plain", 32, "close", 
                    "Server Error: No handlers registered");
   }
+  const RouteEntry& best = routes_[index];
+
+  Response response = run_handler(best, request);
+  for (const auto& filter : best.filters) filter->Apply(request, response);
+  return response;
+}
+
+void Router::async_handle_request(const Request& request, boost::asio::io_service& io,
+                                  std::function<void(Response)> done) const {
+  std::size_t index = 0;
+  if (!trie_.Match(request.get_url(), index)) {
+    done(handle_request(request));
+    return;
+  }
+  const RouteEntry& best = routes_[index];
+
+  std::shared_ptr<RequestHandler> handler = route_handler(best);
+  auto* async = dynamic_cast<AsyncRequestHandler*>(handler.get());
+  if (!async) {
+    Response response = handler->handle_request(request);
+    for (const auto& filter : best.filters) filter->Apply(request, response);
+    done(std::move(response));
+    return;
+  }
+  // The router outlives every request it routes, so best stays valid
+  async->async_handle_request(
+      request, io,
+      [&best, &request, handler, done = std::move(done)](Response response) {
+        for (const auto& filter : best.filters) filter->Apply(request, response);
+        done(std::move(response));
+      });
+}
+
+HandlerRegistry::Blocking Router::blocking(const Request& request) const {
+  std::size_t index = 0;
+  if (!trie_.Match(request.get_url(), index)) return HandlerRegistry::NON_BLOCKING;
+  return routes_[index].blocking;
+}
+
+Response Router::run_handler(const RouteEntry& entry, const Request& request) const {
+  switch (entry.sharing) {
+    case HandlerRegistry::SHARED:
+      return entry.shared->handle_request(request);
+    case HandlerRegistry::PER_THREAD:
+      return thread_handler(entry).handle_request(request);
+    default: {
+      // **per-request** instantiate, use, then destroy:
+      std::unique_ptr<RequestHandler> h(entry.factory(entry.prefix, entry.params));
+      return h->handle_request(request);
+    }
+  }
+}
+
+std::shared_ptr<RequestHandler> Router::route_handler(const RouteEntry& entry) const {
+  switch (entry.sharing) {
+    case HandlerRegistry::SHARED:
+      return entry.shared;
+    case HandlerRegistry::PER_THREAD:
+      // Owned by the thread's cache, which keeps it while the router lives
+      return std::shared_ptr<RequestHandler>(std::shared_ptr<RequestHandler>(),
+                                             &thread_handler(entry));
+    default:
+      return std::shared_ptr<RequestHandler>(entry.factory(entry.prefix, entry.params));
+  }
+}
+
+RequestHandler& Router::thread_handler(const RouteEntry& entry) const {
+  struct Cached {
+    std::weak_ptr<int> owner;
+    std::unique_ptr<RequestHandler> handler;
+  };
+  thread_local std::unordered_map<std::uint64_t, Cached> cache;
+
+  auto it = cache.find(entry.id);
+  if (it != cache.end()) return *it->second.handler;
+
+  // Misses are rare, use them to drop handlers of destroyed routers
+  for (auto c = cache.begin(); c != cache.end();) {
+    c = c->second.owner.expired() ? cache.erase(c) : std::next(c);
+  }
 
-  // **per-request** instantiate, use, then destroy:
-  RequestHandler* h = best->factory(best->prefix, best->params);
-  Response resp = h->handle_request(request);
-  delete h;
-  return resp;
+  Cached cached{lifetime_,
+                std::unique_ptr<RequestHandler>(entry.factory(entry.prefix, entry.params))};
+  return *cache.emplace(entry.id, std::move(cached)).first->second.handler;
 }
 
 std::string Router::sanitize_path(const std::string& path) const {
@@ -1,17 +1,46 @@
 #include "server.h"
 #include "logger.h"
 #include <boost/bind.hpp>
+#include <cstddef>
+#include <sys/socket.h>
 
 using boost::asio::ip::tcp;
 
+namespace {
+
+// SO_REUSEPORT as a SettableSocketOption, which Asio has no public type for
+class ReusePort {
+  public:
+    explicit ReusePort(bool on) : value_(on ? 1 : 0) {}
+
+    template <typename Protocol> int level(const Protocol&) const { return SOL_SOCKET; }
+    template <typename Protocol> int name(const Protocol&) const { return SO_REUSEPORT; }
+    template <typename Protocol> const int* data(const Protocol&) const { return &value_; }
+    template <typename Protocol> std::size_t size(const Protocol&) const { return sizeof(value_); }
+
+  private:
+    int value_;
+};
+
+}  // namespace
+
 server::server(boost::asio::io_service& io_service, 
                short port, 
                Router& router,
-               SessionFactory session_factory)
+               SessionFactory session_factory,
+               bool reuse_port)
   : io_service_(io_service),
-    acceptor_(io_service, tcp::endpoint(tcp::v4(), port)),
+    acceptor_(io_service),
     router_(router),
     session_factory_(session_factory) {
+  tcp::endpoint endpoint(tcp::v4(), port);
+  acceptor_.open(endpoint.protocol());
+  acceptor_.set_option(tcp::acceptor::reuse_address(true));
+  if (reuse_port) {
+    acceptor_.set_option(ReusePort(true));
+  }
+  acceptor_.bind(endpoint);
+  acceptor_.listen();
   Logger::log_info("Server listening on port " + std::to_string(port));
   start_accept();
 }
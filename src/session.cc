@@ -1,22 +1,57 @@
 #include "session.h"
+#include "async_file_io.h"
 #include "logger.h"
 #include "request.h"
+#include "session_pool.h"
 #include "echo_handler.h"
 #include "static_handler.h"
 
-#include <boost/bind.hpp>
+#include <algorithm>
+#include <cerrno>
 #include <string>
-#include <sstream>
+#include <sys/sendfile.h>
 
 using boost::asio::ip::tcp;
 
+namespace {
+
+// The session's buffer vector as a ConstBufferSequence that async_write
+// can copy without copying the vector. It must not change until the write
+// completes.
+struct BufferView {
+  using value_type = boost::asio::const_buffer;
+  using const_iterator = std::vector<boost::asio::const_buffer>::const_iterator;
+
+  const std::vector<boost::asio::const_buffer>* buffers;
+
+  const_iterator begin() const { return buffers->begin(); }
+  const_iterator end() const { return buffers->end(); }
+};
+
+}  // namespace
+
 std::shared_ptr<session> session::MakeSession(boost::asio::io_service& io, Router& r) {
     return std::shared_ptr<session>(new session(io, r));
 }
 
-session::session(boost::asio::io_service& io_service, Router& r)
-  : socket_(io_service), router_(r),
-    timer_(io_service.get_executor().context()){}
+SessionFactory session::MakeSessionFactory(const SessionOptions& options) {
+    if (options.session_pool > 0) {
+      return [options](boost::asio::io_service& io, Router& r) {
+          return SessionPool::Of(io).Acquire(r, options);
+      };
+    }
+    return [options](boost::asio::io_service& io, Router& r) {
+        return std::shared_ptr<session>(new session(io, r, options));
+    };
+}
+
+session::session(boost::asio::io_service& io_service, Router& r, const SessionOptions& options)
+  : io_service_(io_service),
+    strand_(boost::asio::make_strand(io_service)),
+    socket_(strand_),
+    timer_(strand_),
+    router_(r),
+    options_(options) {}
 
 // Return the underlying socket so the acceptor can bind to it.
 tcp::socket& session::socket() {
@@ -24,23 +59,25 @@ tcp::socket& session::socket() {
 }
 
 void session::start() {
-  auto self = shared_from_this();
   // Kick off the first asynchronous read.
   auto ip = Logger::get_client_ip(socket_);
   Logger::log_connection(ip);
-  start_timer();
+  start_timer(std::chrono::seconds(request_timeout));
+  do_read();
+}
+
+void session::do_read() {
+  auto self = shared_from_this();
   socket_.async_read_some(
       boost::asio::buffer(chunk_, max_length),
-      boost::bind(&session::handle_read, self,
-                  boost::asio::placeholders::error,
-                  boost::asio::placeholders::bytes_transferred));
+      MakeMemoryHandler(read_memory_, [self](const boost::system::error_code& err, std::size_t n) {
+          self->handle_read(err, n);
+      }));
 }
 
 void session::handle_read(const boost::system::error_code& error,
                                 std::size_t bytes_transferred)
 {
-  auto self = shared_from_this();
-
   if (error) { 
     stop_timer();
     return; 
@@ -48,116 +85,429 @@ void session::handle_read(const boost::system::error_code& error,
 
   in_buf_.append(chunk_, bytes_transferred);
 
-  if (!request_complete()) {
-    start_timer(); // Restart timer after receiving
-    socket_.async_read_some(
-        boost::asio::buffer(chunk_, max_length),
-        [self](const boost::system::error_code& err, std::size_t n) {
-            self->handle_read(err, n);
-        });
+  // Dispatch every complete request already buffered (pipelining)
+  process_requests();
+
+  if (write_queue_.empty() && pending_) {
+    // Resumed when the pending handler's response is queued
+    stop_timer();
+    return;
+  }
+  if (write_queue_.empty()) {
+    start_timer(std::chrono::seconds(request_timeout)); // Restart timer after receiving
+    do_read();
     return;
   }
 
-  // Stop timer if complete request read
+  // Stop timer while responses are being written
   stop_timer();
+  start_write();
+}
 
-  // Parse
-  Request  request(in_buf_);
-
-  // Add logger
+void session::process_requests() {
   std::string client_ip = Logger::get_client_ip(socket_);
+  while (!closing_ && !pending_ && write_queue_.size() < options_.pipeline_depth) {
+    RequestParser::Result parsed = parser_.Parse(in_buf_);
+    if (parsed == RequestParser::INCOMPLETE) break;
+    if (parsed == RequestParser::TOO_LARGE) {
+      // Never routed, the request is only built for the log line
+      Request request(std::string_view(in_buf_).substr(parser_.request_begin()),
+                      parser_.layout());
+      write_queue_.push_back(
+          reject(request, 431, "Request Header Fields Too Large", client_ip));
+      break;
+    }
+
+    // The request views in_buf_ directly, which stays untouched until it has
+    // been dispatched
+    Request request(std::string_view(in_buf_).substr(parser_.request_begin(),
+                                                     parser_.request_length()),
+                    parser_.layout());
+    // A body framed by Transfer-Encoding can't be found, so the request is
+    // refused before any handler sees it
+    bool framed = !parser_.layout().transfer_encoding;
+    auto blocking = request.is_valid() && framed ? router_.blocking(request)
+                                                 : HandlerRegistry::NON_BLOCKING;
+    if (blocking == HandlerRegistry::ASYNC ||
+        (blocking == HandlerRegistry::BLOCKING && options_.handler_pool)) {
+      // Left in in_buf_ until the responses ahead of it are written, so
+      // nothing else of the session is in flight while it's handled
+      if (!write_queue_.empty()) break;
+      parser_.Next();
+      if (blocking == HandlerRegistry::ASYNC) start_async(request, client_ip);
+      else offload(request, client_ip);
+      break;
+    }
+    parser_.Next();
+    write_queue_.push_back(framed ? dispatch(request, client_ip)
+                                  : reject(request, 501, "Not Implemented", client_ip));
+  }
+
+  // Drop the bytes of every dispatched request; the parser keeps its place
+  // in a partially received one
+  std::size_t consumed = parser_.request_begin();
+  if (consumed > 0) {
+    in_buf_.erase(0, consumed);
+    parser_.Rebase(consumed);
+  }
+}
+
+session::OutgoingResponse session::dispatch(const Request& request, const std::string& client_ip) {
+    //Early 400 on malformed syntax, framing can't be trusted so always close
+    if (!request.is_valid()) return reject(request, 400, "Bad Request", client_ip);
+
+  return finish(request, router_.handle_request(request), client_ip);
+}
+
+session::OutgoingResponse session::reject(const Request& request, int status,
+                                          const std::string& body,
+                                          const std::string& client_ip) {
+  // Whatever follows on the connection can't be framed, so it's closed
+  closing_ = true;
+  Response response("HTTP/1.1", status, "text/plain", body.size(), "close", body);
+  Logger::log_request(client_ip, std::string(request.get_method()),
+                      std::string(request.get_url()), status, response.get_handler_type());
+  return OutgoingResponse{response.to_string()};
+}
 
-    //Early 400 on malformed syntax
-    if (!request.is_valid()) {
-        Response bad_response("HTTP/1.1", 400, "text/plain", /*content len=*/11, "close", "Bad Request"
-        );    
-        Logger::log_request(client_ip, request.get_method(), request.get_url(), 400, bad_response.get_handler_type());
-        boost::asio::async_write(
-        socket_,
-        boost::asio::buffer(bad_response.to_string()),
-        boost::bind(&session::handle_write, self,
-                    boost::asio::placeholders::error));
-        return;
+void session::offload(const Request& request, const std::string& client_ip) {
+  pending_ = true;
+  auto self = shared_from_this();
+  // The request outlives this read, in_buf_ doesn't keep its bytes
+  boost::asio::post(*options_.handler_pool, [self, request = request.Detach(), client_ip]() {
+    std::shared_ptr<Response> response;
+    try {
+      response = std::make_shared<Response>(self->router_.handle_request(request));
+    } catch (const std::exception& e) {
+      // Nothing above this thread would catch it
+      Logger::log_error("Blocking handler failed: " + std::string(e.what()));
+      std::string body = "500 Internal Server Error";
+      response = std::make_shared<Response>(request.get_version(), 500, "text/plain",
+                                            body.size(), "close", body);
     }
+    // Back on the strand, so this can't overlap the rest of the session's
+    // handlers, such as a timeout or the tail of process_requests
+    boost::asio::post(self->strand_, [self, request, response, client_ip]() {
+      self->resume(request, std::move(*response), client_ip);
+    });
+  });
+}
+
+void session::start_async(const Request& request, const std::string& client_ip) {
+  pending_ = true;
+  auto self = shared_from_this();
+  // The request outlives this read, in_buf_ doesn't keep its bytes
+  auto detached = std::make_shared<const Request>(request.Detach());
+  auto done = [self, detached, client_ip](Response response) {
+    // Posted to the strand, whichever thread answers: a handler answering
+    // straight away doesn't re-enter process_requests, and one answering
+    // from its own timer can't overlap the session's other handlers
+    auto shared = std::make_shared<Response>(std::move(response));
+    boost::asio::post(self->strand_, [self, detached, shared, client_ip]() {
+      self->resume(*detached, std::move(*shared), client_ip);
+    });
+  };
+  try {
+    router_.async_handle_request(*detached, io_service_, done);
+  } catch (const std::exception& e) {
+    Logger::log_error("Async handler failed: " + std::string(e.what()));
+    std::string body = "500 Internal Server Error";
+    done(Response(detached->get_version(), 500, "text/plain", body.size(), "close", body));
+  }
+}
 
-  Response response = router_.handle_request(request);
+void session::resume(const Request& request, Response response, const std::string& client_ip) {
+  pending_ = false;
+  write_queue_.push_back(finish(request, std::move(response), client_ip));
+  start_write();
+}
+
+session::OutgoingResponse session::finish(const Request& request, Response response,
+                                          const std::string& client_ip) {
+  ++requests_dispatched_;
+
+  // Keep the connection if the client wants it, keep-alive isn't disabled
+  // and this isn't the last request allowed on the connection
+  bool keep_alive = request.keep_alive() &&
+                    options_.keepalive_timeout > 0 &&
+                    requests_dispatched_ < options_.keepalive_requests;
+  if (!keep_alive) closing_ = true;
+  response.set_connection(keep_alive ? "keep-alive" : "close");
 
     // Log actual status code (200, 404, etc.)
     int code = response.get_status_code();
     Logger::log_request(
         client_ip,
-        request.get_method(),
-        request.get_url(),
+        std::string(request.get_method()),
+        std::string(request.get_url()),
         code,
         response.get_handler_type()
     );
 
-  out_buf_ = response.to_string();
+  OutgoingResponse out;
+  out.data = take_buffer();
+
+  // HEAD gets the headers GET would, Content-Length included, but never a
+  // body, which the client would take for the start of the next response
+  if (request.get_method() == "HEAD") {
+    response.append_header_string(out.data);
+    return out;
+  }
+
+  // Prebuilt, file and shared bodies are written after the headers without
+  // copying
+  if (response.get_prebuilt_owner()) {
+    if (response.get_prebuilt_head().empty()) response.append_header_string(out.data);
+    else response.append_header_tail(out.data);
+    out.owner = response.get_prebuilt_owner();
+    out.head = response.get_prebuilt_head();
+    out.prebuilt_body = response.get_prebuilt_body();
+    return out;
+  }
+  if (!response.get_file_slices().empty() || response.get_shared_body()) {
+    response.append_header_string(out.data);
+    out.body = response.get_shared_body();
+    out.slices = response.get_file_slices();
+    out.tail = response.get_file_tail();
+    return out;
+  }
+  response.append_to(out.data);
+  return out;
+}
+
+std::string session::take_buffer() {
+  if (spare_buffers_.empty()) return std::string();
+  std::string buffer = std::move(spare_buffers_.back());
+  spare_buffers_.pop_back();
+  buffer.clear();
+  return buffer;
+}
+
+void session::start_write() {
+  auto self = shared_from_this();
+
+  // Coalesce queued responses into one gathered write, in request order. A
+  // streamed file ends the batch: the file must follow its headers before
+  // anything queued behind it.
+  while (!write_queue_.empty()) {
+    writing_.push_back(std::move(write_queue_.front()));
+    write_queue_.pop_front();
+    if (writing_.back().streams_file()) break;
+  }
+  std::vector<boost::asio::const_buffer>& buffers = write_buffers_;
+  buffers.clear();
+  for (const auto& r : writing_) {
+    if (r.owner) buffers.push_back(boost::asio::buffer(r.head.data(), r.head.size()));
+    buffers.push_back(boost::asio::buffer(r.data));
+    if (r.body) buffers.push_back(boost::asio::buffer(*r.body));
+    if (r.owner) {
+      buffers.push_back(boost::asio::buffer(r.prebuilt_body.data(), r.prebuilt_body.size()));
+    }
+    if (r.slices.empty() || r.streams_file()) continue;
+    // Written straight out of the mappings
+    for (const auto& slice : r.slices) {
+      if (!slice.lead.empty()) buffers.push_back(boost::asio::buffer(slice.lead));
+      buffers.push_back(boost::asio::buffer(slice.mapping->data() + slice.offset, slice.length));
+    }
+    if (!r.tail.empty()) buffers.push_back(boost::asio::buffer(r.tail));
+  }
+  // The first slice's lead rides along with its headers
+  bool streams = writing_.back().streams_file();
+  if (streams) {
+    buffers.push_back(boost::asio::buffer(writing_.back().slices.front().lead));
+  }
+
+  boost::asio::async_write(
+      socket_,
+      BufferView{&buffers},
+      MakeMemoryHandler(write_memory_, [self, streams](const boost::system::error_code& err,
+                                                       std::size_t) {
+          if (err || !streams) {
+            self->handle_write(err);
+            return;
+          }
+          self->slice_index_ = 0;
+          self->continue_slices();
+      }));
+}
+
+void session::continue_slices() {
+  const OutgoingResponse& out = writing_.back();
+  if (slice_index_ == out.slices.size()) {
+    handle_write(boost::system::error_code());
+    return;
+  }
+  file_offset_ = out.slices[slice_index_].offset;
+  file_remaining_ = out.slices[slice_index_].length;
+  if (options_.file_io) read_file_chunk();
+  else send_file();
+}
+
+void session::read_file_chunk() {
+  if (file_remaining_ == 0) {
+    finish_slice();
+    return;
+  }
+  std::size_t length = std::min<std::size_t>(file_remaining_, file_chunk_length);
+  if (file_buf_.size() < length) file_buf_.resize(length);
+
+  auto self = shared_from_this();
+  options_.file_io->Read(
+      writing_.back().slices[slice_index_].file, file_offset_, file_buf_.data(), length,
+      [self](const boost::system::error_code& err, std::size_t n) {
+        // Reads complete on the io_service, so hop onto the strand first
+        boost::asio::post(self->strand_, [self, err, n]() {
+          if (err || n == 0) {
+            // Read error or the file shrank, as in send_file
+            Logger::log_warning("Aborting file response with " +
+                                std::to_string(self->file_remaining_) + " bytes unsent");
+            boost::system::error_code ec;
+            self->socket_.shutdown(tcp::socket::shutdown_both, ec);
+            self->socket_.close(ec);
+            return;
+          }
+          self->file_offset_ += n;
+          self->file_remaining_ -= n;
+          boost::asio::async_write(
+              self->socket_,
+              boost::asio::buffer(self->file_buf_.data(), n),
+              [self](const boost::system::error_code& err, std::size_t) {
+                if (err) self->handle_write(err);
+                else self->read_file_chunk();
+              });
+        });
+      });
+}
+
+void session::finish_slice() {
+  const OutgoingResponse& out = writing_.back();
+  ++slice_index_;
+  const std::string& between =
+      slice_index_ < out.slices.size() ? out.slices[slice_index_].lead : out.tail;
+  if (between.empty()) {
+    continue_slices();
+    return;
+  }
+  auto self = shared_from_this();
   boost::asio::async_write(
       socket_,
-      boost::asio::buffer(out_buf_),
+      boost::asio::buffer(between),
       [self](const boost::system::error_code& err, std::size_t) {
-          self->handle_write(err);
+          if (err) self->handle_write(err);
+          else self->continue_slices();
       });
 }
 
-void session::handle_write(const boost::system::error_code& error) {
-  // We’re done with this connection—close it either way.
-}
-
-bool session::request_complete() {
-  // Simple heuristic: headers end with a blank line (\r\n\r\n).
-  // Added || for \n\n termination for the netcat terminal, since their newline doesn't produce \r\n but \n instead.
-  auto header_end_pos = in_buf_.find("\r\n\r\n");
-  auto body_start_pos = header_end_pos;
-  if (header_end_pos != std::string::npos)
-    body_start_pos = header_end_pos + 4;
-  else {
-    header_end_pos = in_buf_.find("\n\n");
-    if (header_end_pos != std::string::npos) 
-      body_start_pos = header_end_pos + 2;
-    else // header not completed yet
-      return false;
-  }
-
-  // After headers, there may or may not be a body
-  // Expect a Content-Length header if request has a body
-  auto header = in_buf_.substr(0, body_start_pos);
-  std::size_t content_length = 0;
-  std::istringstream stream(header);
-  std::string line;
-  bool content_length_found = false;
-  while (std::getline(stream, line)) {
-    auto content_length_pos = line.find("Content-Length:");
-    if (content_length_pos != std::string::npos) {
-      content_length = std::stoull(line.substr(content_length_pos + 15));
-      content_length_found = true;
-      break;
+void session::send_file() {
+  const FileBody& file = *writing_.back().slices[slice_index_].file;
+  // sendfile on a blocking socket would stall this io thread
+  boost::system::error_code ec;
+  socket_.native_non_blocking(true, ec);
+
+  while (file_remaining_ > 0) {
+    off_t offset = static_cast<off_t>(file_offset_);
+    ssize_t n = ::sendfile(socket_.native_handle(), file.fd(), &offset, file_remaining_);
+    if (n > 0) {
+      file_offset_ += static_cast<std::size_t>(n);
+      file_remaining_ -= static_cast<std::size_t>(n);
+      continue;
+    }
+    if (n < 0 && errno == EINTR) continue;
+    if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+      auto self = shared_from_this();
+      socket_.async_wait(tcp::socket::wait_write,
+                         [self](const boost::system::error_code& err) {
+                           if (err) self->handle_write(err);
+                           else self->send_file();
+                         });
+      return;
     }
+
+    // The file shrank since it was opened or the peer went away. The
+    // Content-Length already sent can't be honoured, so drop the connection.
+    Logger::log_warning("Aborting file response with " + std::to_string(file_remaining_) +
+                        " bytes unsent");
+    socket_.shutdown(tcp::socket::shutdown_both, ec);
+    socket_.close(ec);
+    return;
+  }
+  finish_slice();
+}
+
+void session::handle_write(const boost::system::error_code& error) {
+  if (error) return;
+  // Keeps the serialized responses' storage for the next ones, as many as
+  // can be queued at once
+  for (auto& r : writing_) {
+    if (spare_buffers_.size() >= options_.pipeline_depth) break;
+    if (r.data.capacity() <= max_retained_buffer) spare_buffers_.push_back(std::move(r.data));
   }
-  // If Content-Length header not found, assumes that there is no body and simply returns that request is complete
-  // It is possible that a body still exists, however if there is no Content-Length header the session will remove
-  // anything following \r\n\r\n
-  if (!content_length_found) {
-    in_buf_.resize(in_buf_.size() - (in_buf_.size() - body_start_pos));
-    return true;
+  writing_.clear();
+
+  // Responses queued behind a file body
+  if (!write_queue_.empty()) {
+    start_write();
+    return;
   }
+  // Resumed when the pending handler's response is queued
+  if (pending_) return;
 
-  // If the Content-Length header exists and received body is shorter than expected, need to keep receiving
-  // If received body is larger than expected, stop receiving and resize to match expected length
-  auto body = in_buf_.substr(body_start_pos);
-  auto body_size = body.size();
-  if (body_size < content_length) return false;
-  else if (body_size > content_length) {
-    in_buf_.resize(in_buf_.size() - (body_size - content_length));
+  if (closing_) {
+    // Client asked to close, the request was malformed or the limit was reached
+    boost::system::error_code ec;
+    socket_.shutdown(tcp::socket::shutdown_both, ec);
+    socket_.close(ec);
+    return;
   }
-  return true;
+
+  // Requests held back because the pipeline depth was reached
+  process_requests();
+  if (!write_queue_.empty()) {
+    start_write();
+    return;
+  }
+  if (pending_) return;
+
+  // Wait for the next request on this connection
+  start_timer(std::chrono::seconds(in_buf_.empty() ? options_.keepalive_timeout
+                                                   : static_cast<unsigned int>(request_timeout)));
+  do_read();
 }
 
-void session::start_timer() {
+void session::recycle() {
+  boost::system::error_code ec;
+  socket_.close(ec);
+  timer_.cancel(ec);
+  closing_ = false;
+  requests_dispatched_ = 0;
+  pending_ = false;
+  parser_.Reset();
+  write_queue_.clear();
+  slice_index_ = 0;
+  file_offset_ = 0;
+  file_remaining_ = 0;
+
+  // Emptied either way, and freed if a large request or pipeline grew them
+  in_buf_.clear();
+  if (in_buf_.capacity() > max_retained_buffer) std::string().swap(in_buf_);
+  writing_.clear();
+  if (writing_.capacity() * sizeof(OutgoingResponse) > max_retained_buffer) {
+    std::vector<OutgoingResponse>().swap(writing_);
+  }
+  if (file_buf_.size() > max_retained_buffer) std::vector<char>().swap(file_buf_);
+  // One spare serialization buffer is enough for a new connection's first
+  // response
+  if (spare_buffers_.size() > 1) spare_buffers_.resize(1);
+  write_buffers_.clear();
+  if (write_buffers_.capacity() * sizeof(boost::asio::const_buffer) > max_retained_buffer) {
+    std::vector<boost::asio::const_buffer>().swap(write_buffers_);
+  }
+}
+
+void session::start_timer(std::chrono::seconds timeout) {
   auto self = shared_from_this();
-  // Session waits 5 seconds to read more data, times out if nothing new received
-  timer_.expires_after(std::chrono::seconds(5));
+  // Session waits for timeout to read more data, times out if nothing new received
+  timer_.expires_after(timeout);
   timer_.async_wait([self](const boost::system::error_code& error) {
       self->handle_timeout(error);
   });
@@ -170,10 +520,15 @@ void session::stop_timer() {
 
 void session::handle_timeout(const boost::system::error_code& error) {
   if (!error) {
-    Logger::log_warning("Session timed out before receiving a complete request");
+    if (in_buf_.empty() && requests_dispatched_ > 0) {
+      Logger::log_info("Closing idle keep-alive connection after " +
+                       std::to_string(requests_dispatched_) + " requests");
+    } else {
+      Logger::log_warning("Session timed out before receiving a complete request");
+    }
     boost::system::error_code ec;
     timer_.cancel(ec);
     socket_.shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
     socket_.close(ec);
   }
-}
\ No newline at end of file
+}
@@ -0,0 +1,68 @@
+#include "session_pool.h"
+#include "router.h"
+
+boost::asio::execution_context::id SessionPool::id;
+
+SessionPool::SessionPool(boost::asio::execution_context& context)
+  : boost::asio::execution_context::service(context),
+    io_service_(static_cast<boost::asio::io_service&>(context)) {}
+
+SessionPool::~SessionPool() { shutdown(); }
+
+SessionPool& SessionPool::Of(boost::asio::io_service& io_service) {
+  return boost::asio::use_service<SessionPool>(io_service);
+}
+
+std::shared_ptr<session> SessionPool::Acquire(Router& router, const SessionOptions& options) {
+  std::unique_ptr<session> s;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = idle_.find(&router);
+    if (it != idle_.end() && !it->second.empty()) {
+      s = std::move(it->second.back());
+      it->second.pop_back();
+      --idle_count_;
+    }
+  }
+  if (s) {
+    ++reused_;
+    s->options_ = options;
+  } else {
+    ++created_;
+    s.reset(new session(io_service_, router, options));
+  }
+  std::size_t limit = options.session_pool;
+  return std::shared_ptr<session>(s.release(), [this, limit](session* released) {
+    Release(released, limit);
+  });
+}
+
+void SessionPool::Release(session* s, std::size_t limit) {
+  std::unique_ptr<session> owned(s);
+  owned->recycle();
+  std::lock_guard<std::mutex> lock(mutex_);
+  if (shut_down_ || idle_count_ >= limit) return;
+  idle_[&owned->router_].push_back(std::move(owned));
+  ++idle_count_;
+}
+
+SessionPool::Stats SessionPool::GetStats() const {
+  Stats stats;
+  stats.created = created_;
+  stats.reused = reused_;
+  std::lock_guard<std::mutex> lock(mutex_);
+  stats.idle = idle_count_;
+  return stats;
+}
+
+void SessionPool::shutdown() {
+  // Sessions released from now on, by handlers the io_service destroys,
+  // are deleted straight away
+  std::unordered_map<Router*, std::vector<std::unique_ptr<session>>> idle;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shut_down_ = true;
+    idle.swap(idle_);
+    idle_count_ = 0;
+  }
+}
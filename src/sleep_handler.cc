@@ -1,6 +1,6 @@
 #include "sleep_handler.h"
 #include "logger.h"
-#include <thread>
+#include <memory>
 #include <chrono>
 
 // define the kName symbol
@@ -28,16 +28,19 @@ RequestHandler* SleepHandler::Init(
 SleepHandler::SleepHandler(std::string location, int sleep_seconds)
     : prefix_(std::move(location)), sleep_duration_(std::max(0, sleep_seconds)) {}
 
-// Handles requests by sleeping for the configured duration
-Response SleepHandler::handle_request(const Request& request) {
+// Answers once a timer on io expires, holding no thread meanwhile
+void SleepHandler::async_handle_request(const Request& request, boost::asio::io_service& io,
+                                        Callback done) {
     Logger::log_info("SleepHandler: Starting sleep for " + std::to_string(sleep_duration_) + " seconds");
-    
-    // Sleep for the configured duration
-    std::this_thread::sleep_for(std::chrono::seconds(sleep_duration_));
-    
-    Logger::log_info("SleepHandler: Finished sleeping");
-    
-    // Returns response
-    std::string body = "Slept for " + std::to_string(sleep_duration_) + " seconds";
-    return Response(request.get_version(), 200, "text/plain", body.length(), "close", body, SleepHandler::kName);
-}
\ No newline at end of file
+
+    // The timer keeps itself alive through its own completion handler
+    auto timer = std::make_shared<boost::asio::steady_timer>(io, std::chrono::seconds(sleep_duration_));
+    timer->async_wait([timer, version = std::string(request.get_version()),
+                       seconds = sleep_duration_, done = std::move(done)](const boost::system::error_code&) {
+        Logger::log_info("SleepHandler: Finished sleeping");
+
+        // Returns response
+        std::string body = "Slept for " + std::to_string(seconds) + " seconds";
+        done(Response(version, 200, "text/plain", body.length(), "close", body, SleepHandler::kName));
+    });
+}
@@ -0,0 +1,96 @@
+#include "static_file_cache.h"
+
+#include <algorithm>
+#include <functional>
+
+// Files above this are streamed with sendfile even if they'd fit, so one
+// large asset can't flush every small one
+static const std::size_t kMaxEntryBytes = 1024 * 1024;
+
+StaticFileCache::StaticFileCache(std::size_t capacity_bytes, std::size_t shards)
+  : shard_capacity_(capacity_bytes / std::max<std::size_t>(shards, 1)) {
+  for (std::size_t i = 0; i < std::max<std::size_t>(shards, 1); ++i) {
+    shards_.push_back(std::make_unique<Shard>());
+  }
+}
+
+std::size_t StaticFileCache::Cost(const std::string& path, const Entry& entry) {
+  return path.size() + entry.body->size() + entry.headers->size() + entry.mime_type.size();
+}
+
+StaticFileCache::Shard& StaticFileCache::ShardFor(const std::string& path) {
+  return *shards_[std::hash<std::string>()(path) % shards_.size()];
+}
+
+std::size_t StaticFileCache::max_entry_bytes() const {
+  return std::min(kMaxEntryBytes, shard_capacity_);
+}
+
+std::shared_ptr<const StaticFileCache::Entry>
+StaticFileCache::Lookup(const std::string& path, const FileStat& current) {
+  Shard& shard = ShardFor(path);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  auto it = shard.index.find(path);
+  if (it == shard.index.end()) {
+    ++misses_;
+    return nullptr;
+  }
+
+  auto node = it->second;
+  if (!node->second->stat.SameFile(current)) {
+    // Modified or replaced on disk since it was cached
+    shard.bytes -= Cost(path, *node->second);
+    shard.lru.erase(node);
+    shard.index.erase(it);
+    ++misses_;
+    return nullptr;
+  }
+
+  shard.lru.splice(shard.lru.begin(), shard.lru, node);
+  ++hits_;
+  return node->second;
+}
+
+bool StaticFileCache::Insert(const std::string& path, std::shared_ptr<const Entry> entry) {
+  if (entry->body->size() > max_entry_bytes()) return false;
+  std::size_t cost = Cost(path, *entry);
+  if (cost > shard_capacity_) return false;
+
+  Shard& shard = ShardFor(path);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  // Another thread may have cached the same file meanwhile, keep the newest
+  auto it = shard.index.find(path);
+  if (it != shard.index.end()) {
+    shard.bytes -= Cost(path, *it->second->second);
+    shard.lru.erase(it->second);
+    shard.index.erase(it);
+  }
+
+  while (shard.bytes + cost > shard_capacity_ && !shard.lru.empty()) {
+    auto& victim = shard.lru.back();
+    shard.bytes -= Cost(victim.first, *victim.second);
+    shard.index.erase(victim.first);
+    shard.lru.pop_back();
+    ++evictions_;
+  }
+
+  shard.lru.emplace_front(path, std::move(entry));
+  shard.index[path] = shard.lru.begin();
+  shard.bytes += cost;
+  return true;
+}
+
+StaticFileCache::Stats StaticFileCache::GetStats() const {
+  Stats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.evictions = evictions_;
+  for (const auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    stats.entries += shard->lru.size();
+    stats.bytes += shard->bytes;
+  }
+  return stats;
+}
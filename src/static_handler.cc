@@ -1,7 +1,14 @@
 // src/static_handler.cc
 #include "static_handler.h"
-#include <fstream>
-#include <iterator>
+#include "byte_ranges.h"
+#include "file_body.h"
+#include "logger.h"
+#include "mime_types.h"
+#include "real_filesystem.h"
+#include "validators.h"
+#include <algorithm>
+#include <chrono>
+#include <cctype>
 #include <cstring>
 
 // define the kName symbol
@@ -23,85 +30,476 @@ RequestHandler* StaticHandler::Init(
     ? fs::canonical(cfg)
     : fs::weakly_canonical(fs::read_symlink("/proc/self/exe").parent_path() / cfg);
 
-  return new StaticHandler(location, abs_root.string());
+  // optional in-memory cache of small files
+  std::size_t cache_mb = 0;
+  auto cache_it = params.find("cache_size_mb");
+  if (cache_it != params.end()) {
+    const std::string& v = cache_it->second;
+    if (v.empty() || v.size() > 6 ||
+        !std::all_of(v.begin(), v.end(), [](unsigned char c) { return std::isdigit(c); })) {
+      throw std::runtime_error(
+        "StaticHandler 'cache_size_mb' must be a number for location " + location);
+    }
+    cache_mb = std::stoul(v);
+    if (cache_mb > 0) {
+      Logger::log_info("StaticHandler caching up to " + v + " MB for location " + location);
+    }
+  }
+
+  // optional precompressed siblings
+  bool precompressed = false;
+  auto pre_it = params.find("precompressed");
+  if (pre_it != params.end()) {
+    if (pre_it->second != "on" && pre_it->second != "off") {
+      throw std::runtime_error(
+        "StaticHandler 'precompressed' must be on or off for location " + location);
+    }
+    precompressed = pre_it->second == "on";
+  }
+
+  // optional memory mapped serving
+  bool mmap = false;
+  auto mmap_it = params.find("mmap");
+  if (mmap_it != params.end()) {
+    if (mmap_it->second != "on" && mmap_it->second != "off") {
+      throw std::runtime_error(
+        "StaticHandler 'mmap' must be on or off for location " + location);
+    }
+    mmap = mmap_it->second == "on";
+  }
+  MappedFile::Advice advice = MappedFile::ADVICE_NORMAL;
+  auto advice_it = params.find("mmap_advice");
+  if (advice_it != params.end() && !MappedFile::ParseAdvice(advice_it->second, advice)) {
+    throw std::runtime_error(
+      "StaticHandler 'mmap_advice' must be normal, sequential, random or willneed for location " +
+      location);
+  }
+  if (mmap && cache_mb > 0) {
+    // Both keep the bytes in memory, the mappings without a copy
+    throw std::runtime_error(
+      "StaticHandler 'mmap' can't be combined with 'cache_size_mb' for location " + location);
+  }
+
+  // optional preloading of the whole root
+  bool preload = false;
+  auto preload_it = params.find("preload");
+  if (preload_it != params.end()) {
+    if (preload_it->second != "on" && preload_it->second != "off") {
+      throw std::runtime_error(
+        "StaticHandler 'preload' must be on or off for location " + location);
+    }
+    preload = preload_it->second == "on";
+  }
+  if (preload && precompressed) {
+    // Prebuilt responses have a single representation
+    throw std::runtime_error(
+      "StaticHandler 'preload' can't be combined with 'precompressed' for location " + location);
+  }
+
+  // directory URLs
+  std::string index = "index.html";
+  auto index_it = params.find("index");
+  if (index_it != params.end()) {
+    index = index_it->second == "off" ? "" : index_it->second;
+    if (index_it->second.empty() || index.find('/') != std::string::npos || index == "." ||
+        index == "..") {
+      throw std::runtime_error(
+        "StaticHandler 'index' must be a file name or off for location " + location);
+    }
+  }
+  bool autoindex = false;
+  auto autoindex_it = params.find("autoindex");
+  if (autoindex_it != params.end()) {
+    if (autoindex_it->second != "on" && autoindex_it->second != "off") {
+      throw std::runtime_error(
+        "StaticHandler 'autoindex' must be on or off for location " + location);
+    }
+    autoindex = autoindex_it->second == "on";
+  }
+
+  return new StaticHandler(location, abs_root.string(), cache_mb * 1024 * 1024, precompressed,
+                           mmap, advice, preload, index, autoindex);
 }
 
-// Constructor saves both pieces of information
-StaticHandler::StaticHandler(std::string url_prefix, std::string filesystem_root)
+// Constructor saves both pieces of information, plus the cache budget,
+// sibling lookup, mapping, preload and directory settings
+StaticHandler::StaticHandler(std::string url_prefix, std::string filesystem_root,
+                             std::size_t cache_bytes, bool precompressed,
+                             bool mmap, MappedFile::Advice advice, bool preload,
+                             std::string index, bool autoindex)
   : prefix_(std::move(url_prefix)),
-    fs_root_(std::move(filesystem_root)) {}
+    fs_root_(std::move(filesystem_root)),
+    resolver_(prefix_, fs_root_),
+    fs_(RealFileSystem::Default()),
+    cache_(cache_bytes > 0 ? std::make_unique<StaticFileCache>(cache_bytes) : nullptr),
+    precompressed_(precompressed ? std::make_unique<PrecompressedIndex>() : nullptr),
+    mapped_(mmap ? std::make_unique<MappedFileTable>() : nullptr),
+    mmap_advice_(advice),
+    index_(std::move(index)),
+    listings_(autoindex ? std::make_unique<DirectoryListingCache>() : nullptr) {
+  if (!preload) return;
+  auto start = std::chrono::steady_clock::now();
+  preloaded_ = PreloadedRoot::Load(
+      prefix_, fs_root_, [this](const std::string& path) { return get_content_type(path); });
+  auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start).count();
+  Logger::log_info("StaticHandler preloaded " + std::to_string(preloaded_->size()) +
+                   " files (" + std::to_string(preloaded_->bytes()) + " bytes, " +
+                   (preloaded_->pinned() ? "pinned" : "not pinned") + ") in " +
+                   std::to_string(ms) + " ms for location " + prefix_);
+}
+
+const StaticFileCache* StaticHandler::cache() const { return cache_.get(); }
+
+const PrecompressedIndex* StaticHandler::precompressed() const { return precompressed_.get(); }
+
+const MappedFileTable* StaticHandler::mapped() const { return mapped_.get(); }
+
+const PreloadedRoot* StaticHandler::preloaded() const { return preloaded_.get(); }
+
+const DirectoryListingCache* StaticHandler::listings() const { return listings_.get(); }
+
+// Build the real filesystem path, guard against traversal. Throws
+// std::runtime_error for paths outside the mount or the root. The query
+// string isn't part of the path.
+std::string StaticHandler::resolve_path(const std::string& url_path) const {
+  return resolver_.Resolve(std::string_view(url_path).substr(0, url_path.find('?')));
+}
 
-// Extract file extension (including the dot), or "" if none
-std::string StaticHandler::get_extension(const std::string& path) const {
-  auto pos = path.find_last_of('.');
-  return (pos == std::string::npos ? "" : path.substr(pos));
+// MIME type for path, with a charset for text types
+std::string StaticHandler::get_content_type(const std::string& path) const {
+  return mime_types::ContentType(path);
 }
 
-// A small static table; falls back to octet-stream
-std::string StaticHandler::get_mime_type(const std::string& ext) const {
-  static const std::unordered_map<std::string, std::string> m = {
-    {".html","text/html"},{".htm","text/html"},{".txt","text/plain"},
-    {".css","text/css"},{".js","application/javascript"},
-    {".json","application/json"},{".jpg","image/jpeg"},
-    {".jpeg","image/jpeg"},{".png","image/png"},{".gif","image/gif"},
-    {".svg","image/svg+xml"},{".zip","application/zip"},
-    {".pdf","application/pdf"}, {".md", "text/markdown"},
-    {".log", "text/plain"}
-  };
-  auto it = m.find(ext);
-  return it==m.end() ? "application/octet-stream" : it->second;
+// The file at path (whose metadata is st) or the best precompressed
+// sibling the client accepts. Sibling metadata comes from the index, so
+// this never stat()s.
+StaticHandler::Representation StaticHandler::choose_representation(
+    const Request& request, const std::string& path, const FileStat& st) const {
+  Representation rep{path, st};
+  if (!precompressed_) return rep;
+
+  auto siblings = precompressed_->Lookup(path, st);
+  if (siblings.available == 0) return rep;
+  rep.varies = true;
+  rep.coding = content_encoding::Choose(
+      content_encoding::Accepted(request.get_header("Accept-Encoding")), siblings.available);
+  if (rep.coding != content_encoding::IDENTITY) {
+    rep.path = path + content_encoding::Suffix(rep.coding);
+    rep.stat = siblings.stat[rep.coding];
+  }
+  return rep;
 }
 
-// Build the real filesystem path, guard against traversal
-std::string StaticHandler::resolve_path(const std::string& url_path) const {
-  // strip off the URL prefix
-  if (url_path.rfind(prefix_,0)!=0) {
-    throw std::runtime_error("No static mount for this path");
+// Content-Encoding and Vary, which depend on the representation chosen
+static void addRepresentationHeaders(Response& response, content_encoding::Coding coding,
+                                     bool varies) {
+  if (coding != content_encoding::IDENTITY) {
+    response.add_header("Content-Encoding", content_encoding::Name(coding));
+  }
+  if (varies) response.add_header("Vary", "Accept-Encoding");
+}
+
+// Multipart boundary for ranges of a file with the given ETag. It changes
+// with the ETag, so a boundary that happens to occur in one version
+// doesn't stick.
+static std::string rangeBoundary(const std::string& etag) {
+  return "byteranges-" + etag.substr(1, etag.size() - 2);
+}
+
+// Bytes ahead of range in a multipart/byteranges body of a file of size
+// bytes: the delimiter and the part's headers
+static std::string partLead(bool first, const std::string& boundary,
+                            const std::string& content_type, const byte_ranges::Range& range,
+                            std::size_t size) {
+  return std::string(first ? "" : "\r\n") + "--" + boundary + "\r\n" +
+         "Content-Type: " + content_type + "\r\n" +
+         "Content-Range: " + byte_ranges::ContentRange(range, size) + "\r\n\r\n";
+}
+
+// Body of a 206: the single range as is, or every range as a part of a
+// multipart/byteranges body delimited by boundary. whole is the entire file,
+// open or mapped; either way only the requested ranges are written and
+// nothing is read into memory here.
+static void setRangeBody(Response& response, const FileSlice& whole,
+                         const std::vector<byte_ranges::Range>& ranges,
+                         const std::string& content_type, const std::string& boundary) {
+  std::vector<FileSlice> slices;
+  for (const auto& range : ranges) {
+    FileSlice part = whole;
+    part.offset = range.first;
+    part.length = range.length;
+    if (ranges.size() > 1) {
+      part.lead = partLead(slices.empty(), boundary, content_type, range, whole.length);
+    }
+    slices.push_back(std::move(part));
   }
-  std::string rest = url_path.substr(prefix_.size());
-  if (!rest.empty() && rest[0]=='/') rest.erase(0,1);
+  if (ranges.size() == 1) {
+    response.add_header("Content-Range", byte_ranges::ContentRange(ranges[0], whole.length));
+    response.set_file_slices(std::move(slices));
+    return;
+  }
+  response.set_file_slices(std::move(slices), "\r\n--" + boundary + "--\r\n");
+}
 
-  // canonicalize base and candidate
-  fs::path base = fs::canonical(fs_root_);
-  fs::path full = fs::weakly_canonical(base / rest);
+// Serve a preloaded file, a 304 or ranges of it, all from the copy taken
+// at startup so every response for the URL agrees on the version. A plain
+// HTTP/1.1 response for the whole file goes out with its prebuilt head.
+// Returns false for a URL that isn't preloaded verbatim (e.g.
+// percent-encoded), which needs the regular path.
+bool StaticHandler::serve_preloaded(const Request& request, Response& response) const {
+  const PreloadedRoot::File* file = preloaded_->Find(request.get_url());
+  if (!file) return false;
 
-  // ensure full stays under base
-  if (full.generic_string().rfind(base.generic_string(),0)!=0) {
-    throw std::runtime_error("Path traversal attempt detected");
+  if (validators::IsNotModified(request, file->etag, file->last_modified)) {
+    response = Response(request.get_version(), 304, "", 0, "close", "", StaticHandler::kName);
+    response.add_header("ETag", file->etag);
+    response.add_header("Last-Modified", validators::HttpDate(file->last_modified));
+    return true;
   }
-  return full.string();
+
+  // A stale If-Range gets the whole file instead of the ranges
+  std::vector<byte_ranges::Range> ranges;
+  byte_ranges::Result ranged = byte_ranges::RANGE_NONE;
+  if (request.get_method() == "GET" && !request.get_header("Range").empty() &&
+      validators::IfRangeMatches(request, file->etag, file->last_modified)) {
+    ranged = byte_ranges::Parse(request.get_header("Range"), file->body.size(), ranges);
+  }
+  if (ranged == byte_ranges::RANGE_UNSATISFIABLE) {
+    std::string b = "416 Error: Range not satisfiable";
+    response = Response(request.get_version(), 416, "text/plain", b.size(), "close", b,
+                        StaticHandler::kName);
+    response.add_header("Content-Range", byte_ranges::UnsatisfiedRange(file->body.size()));
+    return true;
+  }
+
+  if (ranged == byte_ranges::RANGE_NONE && request.get_version() == "HTTP/1.1") {
+    response = Response(request.get_version(), 200, "", 0, "close", "", StaticHandler::kName);
+    response.set_prebuilt(preloaded_, file->head, file->body);
+    return true;
+  }
+
+  // Other versions and ranges get headers of their own around arena bytes
+  std::string content_type = get_content_type(std::string(file->url));
+  std::string boundary;
+  if (ranges.size() > 1) boundary = rangeBoundary(file->etag);
+  response = Response(request.get_version(),
+                      ranged == byte_ranges::RANGE_SATISFIABLE ? 206 : 200,
+                      boundary.empty() ? content_type
+                                       : "multipart/byteranges; boundary=" + boundary,
+                      0, "close", "", StaticHandler::kName);
+  response.add_header("ETag", file->etag);
+  response.add_header("Last-Modified", validators::HttpDate(file->last_modified));
+  response.add_header("Accept-Ranges", "bytes");
+  if (ranges.size() == 1) {
+    response.add_header("Content-Range",
+                        byte_ranges::ContentRange(ranges[0], file->body.size()));
+    response.set_prebuilt(preloaded_, "", file->body.substr(ranges[0].first, ranges[0].length));
+  } else if (ranges.size() > 1) {
+    // Several ranges of one file are rare, their parts are copied
+    std::string body;
+    for (const auto& range : ranges) {
+      body += partLead(body.empty(), boundary, content_type, range, file->body.size());
+      body += file->body.substr(range.first, range.length);
+    }
+    body += "\r\n--" + boundary + "--\r\n";
+    response.set_body(std::move(body));
+  } else {
+    response.set_prebuilt(preloaded_, "", file->body);
+  }
+  return true;
+}
+
+// path names a directory. Sends URLs without a trailing slash to the one
+// with it, so relative links in the page resolve inside the directory.
+// Otherwise points path and st at the index file if there is one, or
+// fills response with the autoindex listing. Returns true if response is
+// ready, false if the index file is to be served or there's nothing to
+// serve (st.regular tells which).
+bool StaticHandler::serve_directory(const Request& request, std::string& path, FileStat& st,
+                                    Response& response) const {
+  std::string_view url = request.get_url();
+  std::string_view query;
+  if (auto q = url.find('?'); q != std::string_view::npos) {
+    query = url.substr(q);
+    url = url.substr(0, q);
+  }
+  if (url.empty() || url.back() != '/') {
+    response = Response(request.get_version(), 301, "", 0, "close", "", StaticHandler::kName);
+    response.add_header("Location", std::string(url) + "/" + std::string(query));
+    return true;
+  }
+
+  if (!index_.empty()) {
+    std::string index = (fs::path(path) / index_).string();
+    if (fs_->stat_file(index, st)) {
+      path = std::move(index);
+      return false;
+    }
+  }
+  st = FileStat();
+  if (!listings_) return false;
+
+  FileStat dir;
+  if (!FileStat::Load(path, dir)) return false;
+  auto html = listings_->Get(path, dir, std::string(url));
+  if (!html) return false;
+  response = Response(request.get_version(), 200, "text/html; charset=utf-8", 0, "close", "",
+                      StaticHandler::kName);
+  response.set_shared_body(std::move(html));
+  return true;
+}
+
+// Serve rep from cache_, filling it on a miss. rep.stat is the file's
+// current metadata. Returns false if the file has to be streamed instead
+// (too big, or it changed while being read).
+bool StaticHandler::serve_cached(const Representation& rep, const std::string& content_type,
+                                 Response& response) const {
+  const std::string& path = rep.path;
+  const FileStat& st = rep.stat;
+  auto entry = cache_->Lookup(path, st);
+  if (!entry) {
+    if (st.size > cache_->max_entry_bytes()) return false;
+    auto file = fs_->open_file(path);
+    if (!file) return false;
+
+    auto body = std::make_shared<std::string>(file->Read(0, file->size()));
+    if (body->size() != file->size()) return false;
+
+    auto fresh = std::make_shared<StaticFileCache::Entry>();
+    fresh->mime_type = content_type;
+    fresh->headers = std::make_shared<const std::string>(
+        "Content-Type: " + fresh->mime_type + "\r\n" +
+        "Content-Length: " + std::to_string(body->size()) + "\r\n" +
+        "ETag: " + validators::ETag(file->stat()) + "\r\n" +
+        "Last-Modified: " + validators::HttpDate(validators::LastModified(file->stat())) + "\r\n" +
+        "Accept-Ranges: bytes\r\n");
+    fresh->body = std::move(body);
+    fresh->stat = file->stat();
+    cache_->Insert(path, fresh);
+    entry = std::move(fresh);
+  }
+
+  response.set_header_block(entry->headers);
+  response.set_shared_body(entry->body);
+  addRepresentationHeaders(response, rep.coding, rep.varies);
+  return true;
 }
 
 // The actual request handler
 Response StaticHandler::handle_request(const Request& request) {
+  if (preloaded_) {
+    Response response(request.get_version(), 200, "", 0, "close", "", StaticHandler::kName);
+    if (serve_preloaded(request, response)) return response;
+  }
+
   try {
-    auto path = resolve_path(request.get_url());
-    std::ifstream in(path, std::ios::binary);
-    if (!in) {
+    auto path = resolve_path(std::string(request.get_url()));
+
+    // Metadata alone answers conditional requests, the file isn't opened
+    FileStat st;
+    if (!fs_->stat_file(path, st) && fs_->is_directory(path)) {
+      Response response(request.get_version(), 200, "", 0, "close", "", StaticHandler::kName);
+      if (serve_directory(request, path, st, response)) return response;
+    }
+    if (!st.regular) {
       // 404 Not Found
       std::string b = "404 Error: File not found";
       return Response(request.get_version(), 404, "text/plain", b.size(), "close", b, StaticHandler::kName);
     }
 
-    // slurp the file
-    std::string body{ std::istreambuf_iterator<char>(in),
-                      std::istreambuf_iterator<char>() };
+    // Siblings have validators of their own, so pick one before
+    // checking them
+    Representation rep = choose_representation(request, path, st);
+    std::string content_type = get_content_type(path);
 
-    auto ext = get_extension(path);
-    auto mime = get_mime_type(ext);
+    std::string etag = validators::ETag(rep.stat);
+    std::int64_t last_modified = validators::LastModified(rep.stat);
+    if (validators::IsNotModified(request, etag, last_modified)) {
+      Response response(request.get_version(), 304, "", 0, "close", "", StaticHandler::kName);
+      response.add_header("ETag", etag);
+      response.add_header("Last-Modified", validators::HttpDate(last_modified));
+      if (rep.varies) response.add_header("Vary", "Accept-Encoding");
+      return response;
+    }
+
+    // Partial responses are streamed from the file rather than cut out of a
+    // cached copy
+    bool wants_range = request.get_method() == "GET" && !request.get_header("Range").empty();
+    if (cache_ && !wants_range) {
+      Response response(request.get_version(), 200, "", 0, "close", "", StaticHandler::kName);
+      if (serve_cached(rep, content_type, response)) return response;
+    }
+
+    // A mapping of this version of the file needs no open at all
+    std::shared_ptr<const MappedFile> mapping;
+    if (mapped_) mapping = mapped_->Lookup(rep.path, rep.stat);
+
+    std::shared_ptr<const FileBody> file;
+    if (!mapping) {
+      file = fs_->open_file(rep.path);
+      if (!file && rep.coding != content_encoding::IDENTITY) {
+        // The sibling went away since it was indexed, fall back to the file
+        precompressed_->Invalidate(path);
+        rep.path = path;
+        rep.coding = content_encoding::IDENTITY;
+        file = fs_->open_file(path);
+      }
+      if (!file) {
+        // 404 Not Found
+        std::string b = "404 Error: File not found";
+        return Response(request.get_version(), 404, "text/plain", b.size(), "close", b, StaticHandler::kName);
+      }
+      // A file that can't be mapped is streamed instead
+      if (mapped_) mapping = MappedFile::Map(*file, mmap_advice_);
+      if (mapping) mapped_->Insert(rep.path, mapping);
+    }
+
+    // Validators describe the file as opened, which may be newer than st
+    const FileStat& opened = mapping ? mapping->stat() : file->stat();
+    etag = validators::ETag(opened);
+    last_modified = validators::LastModified(opened);
 
-    // Update mime only for .txt and .html for UTF-8 encoding
-    if(ext == ".html"){
-      mime = "text/html; charset=utf-8";
-    } else if (ext == ".txt"){
-      mime = "text/plain; charset=utf-8";
+    // A stale If-Range gets the whole file instead of the ranges
+    std::vector<byte_ranges::Range> ranges;
+    byte_ranges::Result ranged = byte_ranges::RANGE_NONE;
+    if (wants_range && validators::IfRangeMatches(request, etag, last_modified)) {
+      ranged = byte_ranges::Parse(request.get_header("Range"), opened.size, ranges);
+    }
+    if (ranged == byte_ranges::RANGE_UNSATISFIABLE) {
+      std::string b = "416 Error: Range not satisfiable";
+      Response response(request.get_version(), 416, "text/plain", b.size(), "close", b,
+                        StaticHandler::kName);
+      response.add_header("Content-Range", byte_ranges::UnsatisfiedRange(opened.size));
+      return response;
     }
 
-    return Response(request.get_version(), 200, mime, body.size(), "close", body, StaticHandler::kName);
+    // The session streams the file with sendfile(2) or writes it straight
+    // from the mapping, it's never read here
+    std::string boundary;
+    if (ranges.size() > 1) boundary = rangeBoundary(etag);
+    Response response(request.get_version(),
+                      ranged == byte_ranges::RANGE_SATISFIABLE ? 206 : 200,
+                      boundary.empty() ? content_type
+                                       : "multipart/byteranges; boundary=" + boundary,
+                      0, "close", "", StaticHandler::kName);
+    response.add_header("ETag", etag);
+    response.add_header("Last-Modified", validators::HttpDate(last_modified));
+    response.add_header("Accept-Ranges", "bytes");
+    addRepresentationHeaders(response, rep.coding, rep.varies);
+    if (ranged == byte_ranges::RANGE_SATISFIABLE) {
+      FileSlice whole{"", mapping ? nullptr : file, 0, opened.size, mapping};
+      setRangeBody(response, whole, ranges, content_type, boundary);
+    } else if (mapping) {
+      response.set_mapped_body(std::move(mapping));
+    } else {
+      response.set_file_body(std::move(file));
+    }
+    return response;
   }
   catch (const std::runtime_error& e) {
     // 404 Not Found on traversal or bad mount to obscure file structure
     std::string msg = e.what();
     return Response(request.get_version(), 404, "text/plain", msg.size(), "close", msg, StaticHandler::kName);
   }
-}
\ No newline at end of file
+}
@@ -0,0 +1,121 @@
+#include "validators.h"
+
+#include <cstdio>
+#include <ctime>
+
+namespace validators {
+
+static const char* const kDays[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+static const char* const kMonths[] = {"Jan", "Feb", "Mar", "Apr", "May", "Jun",
+                                      "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"};
+
+// Parses exactly count digits at text[pos]
+static bool parseDigits(std::string_view text, std::size_t pos, std::size_t count, int& out) {
+  if (pos + count > text.size()) return false;
+  out = 0;
+  for (std::size_t i = pos; i < pos + count; ++i) {
+    if (text[i] < '0' || text[i] > '9') return false;
+    out = out * 10 + (text[i] - '0');
+  }
+  return true;
+}
+
+static std::string_view trim(std::string_view s) {
+  while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+  while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+  return s;
+}
+
+std::string ETag(const FileStat& stat) {
+  char buf[64];
+  std::snprintf(buf, sizeof(buf), "\"%llx-%llx-%llx\"",
+                static_cast<unsigned long long>(stat.inode),
+                static_cast<unsigned long long>(stat.size),
+                static_cast<unsigned long long>(stat.mtime_ns));
+  return buf;
+}
+
+std::int64_t LastModified(const FileStat& stat) {
+  return stat.mtime_ns / 1000000000;
+}
+
+std::string HttpDate(std::int64_t seconds) {
+  std::time_t t = static_cast<std::time_t>(seconds);
+  std::tm tm;
+  gmtime_r(&t, &tm);
+  // Names are spelled out rather than left to strftime, which is locale
+  // dependent
+  char buf[40];
+  std::snprintf(buf, sizeof(buf), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+                kDays[tm.tm_wday], tm.tm_mday, kMonths[tm.tm_mon], tm.tm_year + 1900,
+                tm.tm_hour, tm.tm_min, tm.tm_sec);
+  return buf;
+}
+
+bool ParseHttpDate(std::string_view text, std::int64_t& seconds) {
+  // "Sun, 06 Nov 1994 08:49:37 GMT"
+  text = trim(text);
+  if (text.size() != 29 || text.substr(3, 2) != ", " || text.substr(25) != " GMT") return false;
+  if (text[7] != ' ' || text[11] != ' ' || text[16] != ' ' || text[19] != ':' ||
+      text[22] != ':') return false;
+
+  std::tm tm = {};
+  int month = -1;
+  for (int i = 0; i < 12; ++i) {
+    if (text.substr(8, 3) == kMonths[i]) month = i;
+  }
+  if (month < 0) return false;
+  int year;
+  if (!parseDigits(text, 5, 2, tm.tm_mday) || !parseDigits(text, 12, 4, year) ||
+      !parseDigits(text, 17, 2, tm.tm_hour) || !parseDigits(text, 20, 2, tm.tm_min) ||
+      !parseDigits(text, 23, 2, tm.tm_sec)) return false;
+  if (tm.tm_mday < 1 || tm.tm_mday > 31 || tm.tm_hour > 23 || tm.tm_min > 59 ||
+      tm.tm_sec > 60) return false;
+  tm.tm_mon = month;
+  tm.tm_year = year - 1900;
+  seconds = static_cast<std::int64_t>(timegm(&tm));
+  return true;
+}
+
+// If-None-Match uses the weak comparison: W/ prefixes are ignored
+static bool etagListMatches(std::string_view list, std::string_view etag) {
+  if (trim(list) == "*") return true;
+  while (!list.empty()) {
+    std::size_t comma = list.find(',');
+    std::string_view item = trim(list.substr(0, comma));
+    if (item.substr(0, 2) == "W/") item.remove_prefix(2);
+    if (item == etag) return true;
+    if (comma == std::string_view::npos) break;
+    list.remove_prefix(comma + 1);
+  }
+  return false;
+}
+
+bool IsNotModified(const Request& request, std::string_view etag,
+                   std::int64_t last_modified) {
+  if (request.get_method() != "GET" && request.get_method() != "HEAD") return false;
+
+  std::string_view if_none_match = request.get_header("If-None-Match");
+  if (!if_none_match.empty()) return etagListMatches(if_none_match, etag);
+
+  std::int64_t since;
+  std::string_view if_modified_since = request.get_header("If-Modified-Since");
+  if (!if_modified_since.empty() && ParseHttpDate(if_modified_since, since)) {
+    return last_modified <= since;
+  }
+  return false;
+}
+
+bool IfRangeMatches(const Request& request, std::string_view etag,
+                    std::int64_t last_modified) {
+  std::string_view if_range = trim(request.get_header("If-Range"));
+  if (if_range.empty()) return true;
+
+  // Strong comparison, a weak tag never matches
+  if (if_range.front() == '"' || if_range.substr(0, 2) == "W/") return if_range == etag;
+
+  std::int64_t date;
+  return ParseHttpDate(if_range, date) && date == last_modified;
+}
+
+}  // namespace validators
@@ -0,0 +1,82 @@
+#include "worker_cpus.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <thread>
+
+namespace worker_cpus {
+
+// Quota over period in CPUs, 0 unless both are positive
+static double ratio(long long quota, long long period) {
+  return quota > 0 && period > 0 ? static_cast<double>(quota) / period : 0;
+}
+
+unsigned int Available() {
+  unsigned int cpus = static_cast<unsigned int>(Allowed().size());
+  if (cpus == 0) cpus = std::max(1u, std::thread::hardware_concurrency());
+  double quota = CgroupQuota();
+  if (quota > 0) cpus = std::min(cpus, static_cast<unsigned int>(std::ceil(quota)));
+  return std::max(1u, cpus);
+}
+
+double CgroupQuota(const std::string& root) {
+  // cgroup v2: "<quota> <period>" or "max <period>"
+  std::ifstream v2(root + "/cpu.max");
+  if (v2) {
+    std::string quota;
+    long long period = 0;
+    if (!(v2 >> quota >> period) || quota == "max") return 0;
+    try {
+      return ratio(std::stoll(quota), period);
+    } catch (const std::exception&) {
+      return 0;
+    }
+  }
+  // cgroup v1: a quota of -1 means none
+  std::ifstream quota_file(root + "/cpu/cpu.cfs_quota_us");
+  std::ifstream period_file(root + "/cpu/cpu.cfs_period_us");
+  long long quota = 0, period = 0;
+  if (!(quota_file >> quota) || !(period_file >> period)) return 0;
+  return ratio(quota, period);
+}
+
+std::vector<unsigned int> Allowed() {
+  std::vector<unsigned int> cpus;
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) != 0) return cpus;
+  for (unsigned int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &set)) cpus.push_back(cpu);
+  }
+  return cpus;
+}
+
+std::vector<unsigned int> FromMask(const std::string& mask) {
+  std::vector<unsigned int> cpus;
+  if (mask.size() > CPU_SETSIZE) return cpus;
+  for (std::size_t i = 0; i < mask.size(); ++i) {
+    char digit = mask[mask.size() - 1 - i];
+    if (digit != '0' && digit != '1') return {};
+    if (digit == '1') cpus.push_back(static_cast<unsigned int>(i));
+  }
+  return cpus;
+}
+
+bool PinCurrentThread(const std::vector<unsigned int>& cpus) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (unsigned int cpu : cpus) {
+    if (cpu >= CPU_SETSIZE) return false;
+    CPU_SET(cpu, &set);
+  }
+  return !cpus.empty() && pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+void NameCurrentThread(const std::string& name) {
+  pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+}
+
+}  // namespace worker_cpus
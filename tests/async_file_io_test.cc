@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include "async_file_io.h"
+#include "temp_dir.h"
+
+namespace fs = std::filesystem;
+
+// ----------  AsyncFileIOTest Fixture  ---------------
+// Runs every test against both backends; the io_uring run is skipped where
+// the kernel doesn't allow it
+class AsyncFileIOTest : public ::testing::TestWithParam<bool> {
+  protected:
+    void SetUp() override {
+      dir_.Write("data.txt", "0123456789abcdef");
+      file_io_ = AsyncFileIO::Create(io_service_, GetParam(), 2);
+      if (GetParam() && file_io_->backend() != AsyncFileIO::BACKEND_URING) {
+        GTEST_SKIP() << "io_uring unavailable";
+      }
+    }
+
+    void TearDown() override { file_io_.reset(); }
+
+    // Runs the io_service until done is set, failing after a few seconds
+    void RunUntil(const bool& done) {
+      auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+      while (!done && std::chrono::steady_clock::now() < deadline) {
+        // Runs out of work while a thread pool read is still pending
+        if (io_service_.stopped()) io_service_.restart();
+        io_service_.run_one_for(std::chrono::milliseconds(50));
+      }
+      ASSERT_TRUE(done);
+    }
+
+    // Reads length bytes at offset of data.txt
+    std::string Read(std::size_t offset, std::size_t length, boost::system::error_code& ec) {
+      auto file = FileBody::Open((dir_.path() / "data.txt").string());
+      std::string buffer(length, '\0');
+      bool done = false;
+      file_io_->Read(file, offset, &buffer[0], length,
+                     [&](const boost::system::error_code& err, std::size_t n) {
+                       ec = err;
+                       buffer.resize(n);
+                       done = true;
+                     });
+      RunUntil(done);
+      return buffer;
+    }
+
+    TempDir dir_;
+    boost::asio::io_service io_service_;
+    std::unique_ptr<AsyncFileIO> file_io_;
+};
+
+// ----------------- AsyncFileIO unit tests -----------------
+TEST_P(AsyncFileIOTest, ReadsAtOffset) {
+  boost::system::error_code ec;
+  EXPECT_EQ(Read(0, 16, ec), "0123456789abcdef");
+  EXPECT_FALSE(ec);
+  EXPECT_EQ(Read(10, 4, ec), "abcd");
+  EXPECT_EQ(Read(12, 100, ec), "cdef");
+  EXPECT_EQ(Read(16, 8, ec), "");
+  EXPECT_FALSE(ec);
+}
+
+TEST_P(AsyncFileIOTest, ManyReadsInFlight) {
+  auto file = FileBody::Open((dir_.path() / "data.txt").string());
+  std::vector<char> buffers(16);
+  int completed = 0;
+  bool done = false;
+  for (std::size_t i = 0; i < 16; ++i) {
+    file_io_->Read(file, i, &buffers[i], 1,
+                   [&](const boost::system::error_code& err, std::size_t n) {
+                     EXPECT_FALSE(err);
+                     EXPECT_EQ(n, 1u);
+                     done = ++completed == 16;
+                   });
+  }
+  RunUntil(done);
+  EXPECT_EQ(std::string(buffers.begin(), buffers.end()), "0123456789abcdef");
+}
+
+TEST_P(AsyncFileIOTest, MoreReadsThanRingEntries) {
+  // Reads beyond what the ring holds wait for room instead of failing
+  file_io_ = AsyncFileIO::Create(io_service_, GetParam(), 2, /*uring_entries=*/2);
+  auto file = FileBody::Open((dir_.path() / "data.txt").string());
+  std::vector<char> buffers(256);
+  int completed = 0;
+  bool done = false;
+  for (std::size_t i = 0; i < buffers.size(); ++i) {
+    file_io_->Read(file, i % 16, &buffers[i], 1,
+                   [&](const boost::system::error_code& err, std::size_t n) {
+                     EXPECT_FALSE(err) << err.message();
+                     EXPECT_EQ(n, 1u);
+                     done = ++completed == 256;
+                   });
+  }
+  RunUntil(done);
+  for (std::size_t i = 0; i < buffers.size(); ++i) {
+    EXPECT_EQ(buffers[i], "0123456789abcdef"[i % 16]);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, AsyncFileIOTest, ::testing::Values(true, false),
+                         [](const ::testing::TestParamInfo<bool>& info) {
+                           return info.param ? "Uring" : "Threads";
+                         });
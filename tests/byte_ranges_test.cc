@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include "byte_ranges.h"
+
+using byte_ranges::Range;
+
+// ----------------- byte_ranges unit tests -----------------
+TEST(ByteRangesTest, SingleRanges) {
+  std::vector<Range> r;
+  ASSERT_EQ(byte_ranges::Parse("bytes=0-99", 1000, r), byte_ranges::RANGE_SATISFIABLE);
+  ASSERT_EQ(r.size(), 1u);
+  EXPECT_EQ(r[0].first, 0u);
+  EXPECT_EQ(r[0].length, 100u);
+
+  r.clear();
+  ASSERT_EQ(byte_ranges::Parse("bytes=900-", 1000, r), byte_ranges::RANGE_SATISFIABLE);
+  EXPECT_EQ(r[0].first, 900u);
+  EXPECT_EQ(r[0].length, 100u);
+
+  r.clear();
+  ASSERT_EQ(byte_ranges::Parse("bytes=-10", 1000, r), byte_ranges::RANGE_SATISFIABLE);
+  EXPECT_EQ(r[0].first, 990u);
+  EXPECT_EQ(r[0].length, 10u);
+}
+
+TEST(ByteRangesTest, ClampsToFile) {
+  std::vector<Range> r;
+  ASSERT_EQ(byte_ranges::Parse("bytes=500-5000", 1000, r), byte_ranges::RANGE_SATISFIABLE);
+  EXPECT_EQ(r[0].first, 500u);
+  EXPECT_EQ(r[0].length, 500u);
+
+  r.clear();
+  ASSERT_EQ(byte_ranges::Parse("bytes=-5000", 1000, r), byte_ranges::RANGE_SATISFIABLE);
+  EXPECT_EQ(r[0].first, 0u);
+  EXPECT_EQ(r[0].length, 1000u);
+}
+
+TEST(ByteRangesTest, MultipleRangesKeepOrder) {
+  std::vector<Range> r;
+  ASSERT_EQ(byte_ranges::Parse("bytes=500-599, 0-9,,-1", 1000, r),
+            byte_ranges::RANGE_SATISFIABLE);
+  ASSERT_EQ(r.size(), 3u);
+  EXPECT_EQ(r[0].first, 500u);
+  EXPECT_EQ(r[1].first, 0u);
+  EXPECT_EQ(r[2].first, 999u);
+  EXPECT_EQ(r[2].length, 1u);
+}
+
+TEST(ByteRangesTest, UnsatisfiableRangesDropped) {
+  std::vector<Range> r;
+  ASSERT_EQ(byte_ranges::Parse("bytes=2000-2100,0-0", 1000, r), byte_ranges::RANGE_SATISFIABLE);
+  ASSERT_EQ(r.size(), 1u);
+  EXPECT_EQ(r[0].length, 1u);
+
+  r.clear();
+  EXPECT_EQ(byte_ranges::Parse("bytes=1000-", 1000, r), byte_ranges::RANGE_UNSATISFIABLE);
+  EXPECT_EQ(byte_ranges::Parse("bytes=-0", 1000, r), byte_ranges::RANGE_UNSATISFIABLE);
+  EXPECT_EQ(byte_ranges::Parse("bytes=0-", 0, r), byte_ranges::RANGE_UNSATISFIABLE);
+  EXPECT_TRUE(r.empty());
+}
+
+TEST(ByteRangesTest, MalformedHeadersIgnored) {
+  std::vector<Range> r;
+  EXPECT_EQ(byte_ranges::Parse("", 1000, r), byte_ranges::RANGE_NONE);
+  EXPECT_EQ(byte_ranges::Parse("items=0-1", 1000, r), byte_ranges::RANGE_NONE);
+  EXPECT_EQ(byte_ranges::Parse("bytes=", 1000, r), byte_ranges::RANGE_NONE);
+  EXPECT_EQ(byte_ranges::Parse("bytes=5-1", 1000, r), byte_ranges::RANGE_NONE);
+  EXPECT_EQ(byte_ranges::Parse("bytes=a-b", 1000, r), byte_ranges::RANGE_NONE);
+  EXPECT_EQ(byte_ranges::Parse("bytes=0-1,x", 1000, r), byte_ranges::RANGE_NONE);
+  EXPECT_EQ(byte_ranges::Parse("bytes=99999999999999999999999-", 1000, r),
+            byte_ranges::RANGE_NONE);
+  EXPECT_TRUE(r.empty());
+  // The unit is case-insensitive
+  EXPECT_EQ(byte_ranges::Parse("Bytes=0-1", 1000, r), byte_ranges::RANGE_SATISFIABLE);
+}
+
+TEST(ByteRangesTest, TooManyRangesIgnored) {
+  std::string header = "bytes=0-0";
+  for (std::size_t i = 1; i < byte_ranges::kMaxRanges; ++i) header += ",0-0";
+  std::vector<Range> r;
+  EXPECT_EQ(byte_ranges::Parse(header, 1000, r), byte_ranges::RANGE_SATISFIABLE);
+  r.clear();
+  EXPECT_EQ(byte_ranges::Parse(header + ",0-0", 1000, r), byte_ranges::RANGE_NONE);
+}
+
+TEST(ByteRangesTest, FormatsContentRange) {
+  EXPECT_EQ(byte_ranges::ContentRange(Range{0, 100}, 1000), "bytes 0-99/1000");
+  EXPECT_EQ(byte_ranges::UnsatisfiedRange(1000), "bytes */1000");
+}
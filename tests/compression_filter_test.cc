@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "compression_filter.h"
+
+// ----------  CompressionFilterTest Fixture  ---------------
+class CompressionFilterTest : public ::testing::Test {
+  protected:
+    // A 200 with a compressible body well above the threshold
+    static Response MakeResponse(const std::string& type = "text/html",
+                                 const std::string& etag = "") {
+      std::string body;
+      for (int i = 0; i < 100; ++i) body += "<li>item " + std::to_string(i) + "</li>\n";
+      Response response("HTTP/1.1", 200, type, body.size(), "close", body);
+      if (!etag.empty()) response.add_header("ETag", etag);
+      return response;
+    }
+
+    static Request Accepting(const std::string& codings) {
+      return Request("GET / HTTP/1.1\r\nAccept-Encoding: " + codings + "\r\n\r\n");
+    }
+
+    CompressionFilter filter_{6, 256};
+};
+
+// ----------------- CompressionFilter unit tests -----------------
+TEST_F(CompressionFilterTest, CompressesAcceptedCoding) {
+  Response response = MakeResponse();
+  std::size_t original = response.get_body().size();
+  filter_.Apply(Accepting("gzip, deflate"), response);
+  EXPECT_EQ(response.get_header("Content-Encoding"), "gzip");
+  EXPECT_EQ(response.get_header("Vary"), "Accept-Encoding");
+  ASSERT_NE(response.get_shared_body(), nullptr);
+  EXPECT_LT(response.get_shared_body()->size(), original);
+  std::string s = response.to_string();
+  EXPECT_NE(s.find("Content-Length: " + std::to_string(response.get_shared_body()->size())),
+            std::string::npos);
+
+  Response lowercase = MakeResponse();
+  filter_.Apply(Request("GET / HTTP/1.1\r\naccept-encoding: gzip\r\n\r\n"), lowercase);
+  EXPECT_EQ(lowercase.get_header("Content-Encoding"), "gzip");
+
+  Response deflated = MakeResponse();
+  filter_.Apply(Accepting("deflate"), deflated);
+  EXPECT_EQ(deflated.get_header("Content-Encoding"), "deflate");
+}
+
+TEST_F(CompressionFilterTest, IdentityStillVaries) {
+  Response response = MakeResponse();
+  filter_.Apply(Request("GET / HTTP/1.1\r\n\r\n"), response);
+  EXPECT_EQ(response.get_header("Content-Encoding"), "");
+  EXPECT_EQ(response.get_header("Vary"), "Accept-Encoding");
+  EXPECT_EQ(response.get_shared_body(), nullptr);
+}
+
+TEST_F(CompressionFilterTest, SkipsSmallAndIncompressible) {
+  // Sent as is, but with the Vary and ETag any body of its type gets
+  Response small("HTTP/1.1", 200, "text/html", 5, "close", "hello");
+  small.add_header("ETag", "\"abc\"");
+  filter_.Apply(Accepting("gzip"), small);
+  EXPECT_EQ(small.get_header("Content-Encoding"), "");
+  EXPECT_EQ(small.get_header("Vary"), "Accept-Encoding");
+  EXPECT_EQ(small.get_header("ETag"), "W/\"abc\"");
+  EXPECT_EQ(small.get_body(), "hello");
+
+  Response image = MakeResponse("image/png");
+  filter_.Apply(Accepting("gzip"), image);
+  EXPECT_EQ(image.get_header("Content-Encoding"), "");
+
+  Response not_found("HTTP/1.1", 404, "text/html", 0, "close", std::string(1000, 'x'));
+  filter_.Apply(Accepting("gzip"), not_found);
+  EXPECT_EQ(not_found.get_header("Content-Encoding"), "");
+  EXPECT_EQ(not_found.get_header("Vary"), "");
+}
+
+// A 304 carries the Vary and ETag the 200 for the same request would
+TEST_F(CompressionFilterTest, NotModifiedMatchesOk) {
+  Response ok = MakeResponse("text/html", "\"abc\"");
+  filter_.Apply(Accepting("gzip"), ok);
+  Response not_modified("HTTP/1.1", 304, "text/html", 0, "close", "");
+  not_modified.add_header("ETag", "\"abc\"");
+  filter_.Apply(Accepting("gzip"), not_modified);
+  EXPECT_EQ(not_modified.get_header("ETag"), ok.get_header("ETag"));
+  EXPECT_EQ(not_modified.get_header("Vary"), "Accept-Encoding");
+  EXPECT_EQ(not_modified.get_header("Content-Encoding"), "");
+  EXPECT_EQ(not_modified.get_shared_body(), nullptr);
+
+  Response identity("HTTP/1.1", 304, "text/html", 0, "close", "");
+  identity.add_header("ETag", "\"abc\"");
+  filter_.Apply(Request("GET / HTTP/1.1\r\n\r\n"), identity);
+  EXPECT_EQ(identity.get_header("ETag"), "\"abc\"");
+  EXPECT_EQ(identity.get_header("Vary"), "Accept-Encoding");
+
+  // No type, e.g. a file's 304, which the filter never compresses
+  Response untyped("HTTP/1.1", 304, "", 0, "close", "");
+  untyped.add_header("ETag", "\"abc\"");
+  filter_.Apply(Accepting("gzip"), untyped);
+  EXPECT_EQ(untyped.get_header("ETag"), "\"abc\"");
+  EXPECT_EQ(untyped.get_header("Vary"), "");
+}
+
+// Bodies with a strong ETag are compressed once and then served from cache
+TEST_F(CompressionFilterTest, CachesByETag) {
+  for (int i = 0; i < 3; ++i) {
+    Response response = MakeResponse("text/html", "\"abc\"");
+    filter_.Apply(Accepting("gzip"), response);
+    EXPECT_EQ(response.get_header("ETag"), "W/\"abc\"");
+  }
+  auto stats = filter_.GetStats();
+  EXPECT_EQ(stats.compressed, 1u);
+  EXPECT_EQ(stats.cache_hits, 2u);
+  EXPECT_GT(stats.cache_bytes, 0u);
+
+  // Without an ETag every response is compressed afresh
+  for (int i = 0; i < 2; ++i) {
+    Response response = MakeResponse();
+    filter_.Apply(Accepting("gzip"), response);
+  }
+  EXPECT_EQ(filter_.GetStats().compressed, 3u);
+}
+
+TEST_F(CompressionFilterTest, CompressibleTypes) {
+  EXPECT_TRUE(CompressionFilter::IsCompressible("text/html; charset=utf-8"));
+  EXPECT_TRUE(CompressionFilter::IsCompressible("application/json"));
+  EXPECT_TRUE(CompressionFilter::IsCompressible("Application/Problem+JSON"));
+  EXPECT_TRUE(CompressionFilter::IsCompressible("image/svg+xml"));
+  EXPECT_FALSE(CompressionFilter::IsCompressible("image/jpeg"));
+  EXPECT_FALSE(CompressionFilter::IsCompressible("application/zip"));
+}
+
+TEST_F(CompressionFilterTest, FromParams) {
+  EXPECT_EQ(CompressionFilter::FromParams("/x", {}), nullptr);
+  EXPECT_EQ(CompressionFilter::FromParams("/x", {{"compress_level", "0"}}), nullptr);
+  EXPECT_NE(CompressionFilter::FromParams("/x", {{"compress_level", "9"}}), nullptr);
+  EXPECT_THROW(CompressionFilter::FromParams("/x", {{"compress_level", "10"}}),
+               std::runtime_error);
+  EXPECT_THROW(CompressionFilter::FromParams("/x", {{"compress_level", "5"},
+                                                    {"compress_min_length", "-1"}}),
+               std::runtime_error);
+}
@@ -66,6 +66,219 @@ TEST_F(NginxConfigTest, ExtractPortBadPortDirective) {
   EXPECT_FALSE(out_config.ExtractPort(port));
 }
 
+// NginxConfig keep-alive directive tests
+TEST_F(NginxConfigTest, ExtractKeepaliveDirectives) {
+  WriteConfig(R"(
+    port 80;
+    keepalive_timeout 15;
+    keepalive_requests 500;
+  )");
+  ASSERT_TRUE(parser.Parse(test_config_path.c_str(), &out_config));
+  unsigned int timeout = 0, requests = 0;
+  ASSERT_TRUE(out_config.ExtractKeepaliveTimeout(timeout));
+  ASSERT_TRUE(out_config.ExtractKeepaliveRequests(requests));
+  EXPECT_EQ(timeout, 15u);
+  EXPECT_EQ(requests, 500u);
+}
+
+TEST_F(NginxConfigTest, ExtractKeepaliveDirectivesMissingOrInvalid) {
+  WriteConfig(R"(
+    port 80;
+    keepalive_timeout -3;
+    keepalive_requests 0;
+  )");
+  ASSERT_TRUE(parser.Parse(test_config_path.c_str(), &out_config));
+  unsigned int timeout = 7, requests = 9;
+  EXPECT_FALSE(out_config.ExtractKeepaliveTimeout(timeout));
+  EXPECT_FALSE(out_config.ExtractKeepaliveRequests(requests));
+  EXPECT_EQ(timeout, 7u);
+  EXPECT_EQ(requests, 9u);
+}
+
+TEST_F(NginxConfigTest, ExtractUnsignedRejectsOverflow) {
+  WriteConfig(R"(
+    port 80;
+    keepalive_timeout 4294967296;
+    handler_threads 4294967295;
+  )");
+  ASSERT_TRUE(parser.Parse(test_config_path.c_str(), &out_config));
+  unsigned int timeout = 7, threads = 0;
+  EXPECT_FALSE(out_config.ExtractKeepaliveTimeout(timeout));
+  EXPECT_EQ(timeout, 7u);
+  ASSERT_TRUE(out_config.ExtractHandlerThreads(threads));
+  EXPECT_EQ(threads, 4294967295u);
+}
+
+TEST_F(NginxConfigTest, HasDirective) {
+  WriteConfig(R"(
+    port 80;
+    keepalive_timeout -3;
+    location /static StaticHandler {
+      keepalive_requests 5;
+    }
+  )");
+  ASSERT_TRUE(parser.Parse(test_config_path.c_str(), &out_config));
+  EXPECT_TRUE(out_config.HasDirective("keepalive_timeout"));
+  EXPECT_FALSE(out_config.HasDirective("keepalive_requests"));
+  EXPECT_FALSE(out_config.HasDirective("location"));
+}
+
+// NginxConfig open file cache directive tests
+TEST_F(NginxConfigTest, ExtractOpenFileCacheDirectives) {
+  WriteConfig(R"(
+    port 80;
+    open_file_cache 1000;
+    open_file_cache_inactive 30;
+    open_file_cache_valid 0;
+  )");
+  ASSERT_TRUE(parser.Parse(test_config_path.c_str(), &out_config));
+  unsigned int entries = 0, inactive = 0, valid = 9;
+  ASSERT_TRUE(out_config.ExtractOpenFileCache(entries));
+  ASSERT_TRUE(out_config.ExtractOpenFileCacheInactive(inactive));
+  ASSERT_TRUE(out_config.ExtractOpenFileCacheValid(valid));
+  EXPECT_EQ(entries, 1000u);
+  EXPECT_EQ(inactive, 30u);
+  EXPECT_EQ(valid, 0u);
+}
+
+TEST_F(NginxConfigTest, ExtractOpenFileCacheDirectivesMissingOrInvalid) {
+  WriteConfig(R"(
+    port 80;
+    open_file_cache_inactive 0;
+    open_file_cache_valid 5s;
+  )");
+  ASSERT_TRUE(parser.Parse(test_config_path.c_str(), &out_config));
+  unsigned int entries = 7, inactive = 8, valid = 9;
+  EXPECT_FALSE(out_config.ExtractOpenFileCache(entries));
+  EXPECT_FALSE(out_config.ExtractOpenFileCacheInactive(inactive));
+  EXPECT_FALSE(out_config.ExtractOpenFileCacheValid(valid));
+  EXPECT_EQ(entries, 7u);
+  EXPECT_EQ(inactive, 8u);
+  EXPECT_EQ(valid, 9u);
+}
+
+// NginxConfig aio directive tests
+TEST_F(NginxConfigTest, ExtractAioDirectives) {
+  WriteConfig(R"(
+    port 80;
+    aio threads;
+    aio_threads 8;
+  )");
+  ASSERT_TRUE(parser.Parse(test_config_path.c_str(), &out_config));
+  std::string mode;
+  unsigned int threads = 0;
+  ASSERT_TRUE(out_config.ExtractAio(mode));
+  ASSERT_TRUE(out_config.ExtractAioThreads(threads));
+  EXPECT_EQ(mode, "threads");
+  EXPECT_EQ(threads, 8u);
+}
+
+TEST_F(NginxConfigTest, ExtractAioDirectivesMissingOrInvalid) {
+  WriteConfig(R"(
+    port 80;
+    aio uring;
+    aio_threads 0;
+  )");
+  ASSERT_TRUE(parser.Parse(test_config_path.c_str(), &out_config));
+  std::string mode = "off";
+  unsigned int threads = 4;
+  EXPECT_FALSE(out_config.ExtractAio(mode));
+  EXPECT_FALSE(out_config.ExtractAioThreads(threads));
+  EXPECT_EQ(mode, "off");
+  EXPECT_EQ(threads, 4u);
+}
+
+TEST_F(NginxConfigTest, ExtractHandlerThreads) {
+  WriteConfig("port 80;\nhandler_threads 0;\n");
+  ASSERT_TRUE(parser.Parse(test_config_path.c_str(), &out_config));
+  unsigned int threads = 8;
+  ASSERT_TRUE(out_config.ExtractHandlerThreads(threads));
+  EXPECT_EQ(threads, 0u);
+
+  WriteConfig("port 80;\nhandler_threads many;\n");
+  NginxConfig invalid;
+  ASSERT_TRUE(parser.Parse(test_config_path.c_str(), &invalid));
+  threads = 8;
+  EXPECT_FALSE(invalid.ExtractHandlerThreads(threads));
+  EXPECT_EQ(threads, 8u);
+}
+
+TEST_F(NginxConfigTest, ExtractReusePort) {
+  WriteConfig("port 80;\nreuseport on;\n");
+  ASSERT_TRUE(parser.Parse(test_config_path.c_str(), &out_config));
+  bool reuse_port = false;
+  ASSERT_TRUE(out_config.ExtractReusePort(reuse_port));
+  EXPECT_TRUE(reuse_port);
+
+  WriteConfig("port 80;\nreuseport yes;\n");
+  NginxConfig invalid;
+  ASSERT_TRUE(parser.Parse(test_config_path.c_str(), &invalid));
+  reuse_port = false;
+  EXPECT_FALSE(invalid.ExtractReusePort(reuse_port));
+  EXPECT_FALSE(reuse_port);
+}
+
+TEST_F(NginxConfigTest, ExtractSessionPool) {
+  WriteConfig("port 80;\nsession_pool 0;\n");
+  ASSERT_TRUE(parser.Parse(test_config_path.c_str(), &out_config));
+  unsigned int sessions = 256;
+  ASSERT_TRUE(out_config.ExtractSessionPool(sessions));
+  EXPECT_EQ(sessions, 0u);
+
+  WriteConfig("port 80;\nsession_pool lots;\n");
+  NginxConfig invalid;
+  ASSERT_TRUE(parser.Parse(test_config_path.c_str(), &invalid));
+  sessions = 256;
+  EXPECT_FALSE(invalid.ExtractSessionPool(sessions));
+  EXPECT_EQ(sessions, 256u);
+}
+
+TEST_F(NginxConfigTest, ExtractWorkerThreads) {
+  WriteConfig("port 80;\nworker_threads 6;\n");
+  ASSERT_TRUE(parser.Parse(test_config_path.c_str(), &out_config));
+  unsigned int threads = 0;
+  ASSERT_TRUE(out_config.ExtractWorkerThreads(threads));
+  EXPECT_EQ(threads, 6u);
+
+  WriteConfig("port 80;\nworker_threads auto;\n");
+  NginxConfig automatic;
+  ASSERT_TRUE(parser.Parse(test_config_path.c_str(), &automatic));
+  threads = 6;
+  ASSERT_TRUE(automatic.ExtractWorkerThreads(threads));
+  EXPECT_EQ(threads, 0u);
+
+  WriteConfig("port 80;\nworker_threads 0;\n");
+  NginxConfig invalid;
+  ASSERT_TRUE(parser.Parse(test_config_path.c_str(), &invalid));
+  threads = 6;
+  EXPECT_FALSE(invalid.ExtractWorkerThreads(threads));
+  EXPECT_EQ(threads, 6u);
+}
+
+TEST_F(NginxConfigTest, ExtractWorkerCpuAffinity) {
+  WriteConfig("port 80;\nworker_cpu_affinity 0011 1100;\n");
+  ASSERT_TRUE(parser.Parse(test_config_path.c_str(), &out_config));
+  std::vector<std::string> masks;
+  ASSERT_TRUE(out_config.ExtractWorkerCpuAffinity(masks));
+  EXPECT_EQ(masks, (std::vector<std::string>{"0011", "1100"}));
+
+  WriteConfig("port 80;\nworker_cpu_affinity auto;\n");
+  NginxConfig automatic;
+  ASSERT_TRUE(parser.Parse(test_config_path.c_str(), &automatic));
+  ASSERT_TRUE(automatic.ExtractWorkerCpuAffinity(masks));
+  EXPECT_EQ(masks, std::vector<std::string>{"auto"});
+
+  for (const char* bad : {"worker_cpu_affinity 0012;", "worker_cpu_affinity 0102;",
+                          "worker_cpu_affinity 0000;", "worker_cpu_affinity auto 01;"}) {
+    WriteConfig(std::string("port 80;\n") + bad + "\n");
+    NginxConfig invalid;
+    ASSERT_TRUE(parser.Parse(test_config_path.c_str(), &invalid));
+    masks.clear();
+    EXPECT_FALSE(invalid.ExtractWorkerCpuAffinity(masks)) << bad;
+    EXPECT_TRUE(masks.empty());
+  }
+}
+
 // NginxConfig ToString tests
 TEST_F(NginxConfigTest, ToString) {
   std::string config_text = "port 80;\nserver {\n  listen 80;\n}\n";
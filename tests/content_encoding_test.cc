@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+#include <zlib.h>
+#include "content_encoding.h"
+
+using namespace content_encoding;
+
+// ----------------- content_encoding unit tests -----------------
+TEST(ContentEncodingTest, ParsesAcceptEncoding) {
+  EXPECT_EQ(Accepted(""), 0u);
+  EXPECT_EQ(Accepted("gzip"), Bit(GZIP));
+  EXPECT_EQ(Accepted("gzip, deflate, br, zstd"),
+            Bit(GZIP) | Bit(DEFLATE) | Bit(BROTLI) | Bit(ZSTD));
+  EXPECT_EQ(Accepted(" GZIP ;q=0.8 , x-unknown"), Bit(GZIP));
+  EXPECT_EQ(Accepted("identity"), 0u);
+}
+
+TEST(ContentEncodingTest, ZeroQualityExcludes) {
+  EXPECT_EQ(Accepted("br;q=0, gzip;q=0.5"), Bit(GZIP));
+  EXPECT_EQ(Accepted("br;q=0.000"), 0u);
+  EXPECT_EQ(Accepted("br;q=0.001"), Bit(BROTLI));
+}
+
+TEST(ContentEncodingTest, Wildcard) {
+  EXPECT_EQ(Accepted("*"), Bit(GZIP) | Bit(DEFLATE) | Bit(BROTLI) | Bit(ZSTD));
+  // Explicitly listed codings override the wildcard
+  EXPECT_EQ(Accepted("br;q=0, *"), Bit(GZIP) | Bit(DEFLATE) | Bit(ZSTD));
+  EXPECT_EQ(Accepted("*;q=0, gzip"), Bit(GZIP));
+}
+
+TEST(ContentEncodingTest, ChoosesByServerPreference) {
+  unsigned all = Bit(GZIP) | Bit(BROTLI) | Bit(ZSTD);
+  EXPECT_EQ(Choose(all, all), BROTLI);
+  EXPECT_EQ(Choose(Bit(GZIP) | Bit(ZSTD), all), ZSTD);
+  EXPECT_EQ(Choose(all, Bit(GZIP)), GZIP);
+  EXPECT_EQ(Choose(Bit(BROTLI), Bit(GZIP)), IDENTITY);
+  EXPECT_EQ(Choose(0, all), IDENTITY);
+}
+
+TEST(ContentEncodingTest, NamesAndSuffixes) {
+  EXPECT_STREQ(Name(BROTLI), "br");
+  EXPECT_STREQ(Name(GZIP), "gzip");
+  EXPECT_STREQ(Suffix(ZSTD), ".zst");
+  EXPECT_STREQ(Suffix(IDENTITY), "");
+  EXPECT_STREQ(Name(DEFLATE), "deflate");
+  EXPECT_STREQ(Suffix(DEFLATE), "");
+}
+
+// Round trip through zlib, which inflates both formats with window bits 47
+static std::string inflateAny(const std::string& data) {
+  z_stream stream = {};
+  inflateInit2(&stream, 15 + 32);
+  std::string out(1 << 16, '\0');
+  stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+  stream.avail_in = static_cast<uInt>(data.size());
+  stream.next_out = reinterpret_cast<Bytef*>(&out[0]);
+  stream.avail_out = static_cast<uInt>(out.size());
+  int rc = inflate(&stream, Z_FINISH);
+  out.resize(stream.total_out);
+  inflateEnd(&stream);
+  return rc == Z_STREAM_END ? out : "inflate failed";
+}
+
+TEST(ContentEncodingTest, CompressesGzipAndDeflate) {
+  std::string text;
+  for (int i = 0; i < 200; ++i) text += "<p>compressible markup</p>\n";
+
+  std::string gz = Compress(text, GZIP, 6);
+  ASSERT_GE(gz.size(), 2u);
+  EXPECT_EQ(static_cast<unsigned char>(gz[0]), 0x1f);  // gzip magic
+  EXPECT_EQ(static_cast<unsigned char>(gz[1]), 0x8b);
+  EXPECT_LT(gz.size(), text.size() / 4);
+  EXPECT_EQ(inflateAny(gz), text);
+
+  std::string zlib = Compress(text, DEFLATE, 1);
+  EXPECT_EQ(static_cast<unsigned char>(zlib[0]) & 0x0f, 8);  // zlib header, deflate method
+  EXPECT_EQ(inflateAny(zlib), text);
+
+  EXPECT_EQ(inflateAny(Compress("", GZIP, 9)), "");
+  EXPECT_FALSE(CanCompress(BROTLI));
+  EXPECT_THROW(Compress(text, BROTLI, 6), std::runtime_error);
+}
@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <string>
+#include "directory_listing.h"
+#include "temp_dir.h"
+
+namespace fs = std::filesystem;
+
+// ----------  DirectoryListingTest Fixture  ---------------
+class DirectoryListingTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+      fs::create_directories(dir_.path() / "b_dir");
+      dir_.Write("a.txt", "12345");
+      dir_.Write(".hidden", "secret");
+    }
+
+    FileStat Stat() {
+      FileStat stat;
+      FileStat::Load(dir_.path().string(), stat);
+      return stat;
+    }
+
+    TempDir dir_;
+};
+
+// ----------------- DirectoryListingCache unit tests -----------------
+TEST_F(DirectoryListingTest, RendersDirectoriesFirstWithoutHidden) {
+  std::string html = DirectoryListingCache::Render(dir_.path().string(), "/files/");
+  EXPECT_NE(html.find("<h1>Index of /files/</h1>"), std::string::npos);
+  EXPECT_NE(html.find("<a href=\"../\">../</a>"), std::string::npos);
+  auto dir = html.find("<a href=\"b_dir/\">b_dir/</a>");
+  auto file = html.find("<a href=\"a.txt\">a.txt</a>");
+  ASSERT_NE(dir, std::string::npos);
+  ASSERT_NE(file, std::string::npos);
+  EXPECT_LT(dir, file);
+  EXPECT_NE(html.find(" 5\n", file), std::string::npos);
+  EXPECT_EQ(html.find(".hidden"), std::string::npos);
+
+  EXPECT_EQ(DirectoryListingCache::Render(dir_.path().string(), "/").find("../"), std::string::npos);
+}
+
+TEST_F(DirectoryListingTest, CachedPerVersionAndUrl) {
+  DirectoryListingCache cache(8, 2);
+  FileStat stat = Stat();
+  auto first = cache.Get(dir_.path().string(), stat, "/files/");
+  ASSERT_NE(first, nullptr);
+  EXPECT_EQ(cache.Get(dir_.path().string(), stat, "/files/"), first);
+
+  // A different mount of the same directory gets its own title
+  auto other = cache.Get(dir_.path().string(), stat, "/other/");
+  EXPECT_NE(other->find("Index of /other/"), std::string::npos);
+
+  // The caller's stat shows a new version
+  FileStat changed = stat;
+  changed.mtime_ns += 1;
+  dir_.Write("c.txt", "new");
+  auto rebuilt = cache.Get(dir_.path().string(), changed, "/other/");
+  EXPECT_NE(rebuilt->find("c.txt"), std::string::npos);
+
+  auto stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 3u);
+  EXPECT_EQ(stats.entries, 1u);
+}
+
+TEST_F(DirectoryListingTest, UnreadableDirectory) {
+  DirectoryListingCache cache;
+  EXPECT_EQ(cache.Get((dir_.path() / "missing").string(), FileStat(), "/x/"), nullptr);
+  EXPECT_THROW(DirectoryListingCache::Render((dir_.path() / "missing").string(), "/x/"),
+               fs::filesystem_error);
+}
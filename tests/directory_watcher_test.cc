@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+#include "directory_watcher.h"
+#include "temp_dir.h"
+
+namespace fs = std::filesystem;
+
+// ----------  DirectoryWatcherTest Fixture  ---------------
+class DirectoryWatcherTest : public ::testing::Test {
+  protected:
+    void SetUp() override { fs::create_directories(dir_.path() / "sub"); }
+
+    // Polls until the generation moves past before, up to two seconds
+    static bool WaitForChange(const DirectoryWatcher& watcher, std::uint64_t before) {
+      for (int i = 0; i < 200; ++i) {
+        if (watcher.generation() != before) return true;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      }
+      return false;
+    }
+
+    TempDir dir_;
+};
+
+// ----------------- DirectoryWatcher unit tests -----------------
+TEST_F(DirectoryWatcherTest, CountsChangesInSubdirectories) {
+  DirectoryWatcher watcher(dir_.path().string());
+  ASSERT_TRUE(watcher.healthy());
+  EXPECT_TRUE(watcher.symlink_free());
+
+  std::uint64_t before = watcher.generation();
+  dir_.Write("sub/a.txt", "a");
+  EXPECT_TRUE(WaitForChange(watcher, before));
+
+  // Directories created later are watched too
+  before = watcher.generation();
+  fs::create_directories(dir_.path() / "sub" / "new");
+  ASSERT_TRUE(WaitForChange(watcher, before));
+  before = watcher.generation();
+  dir_.Write("sub/new/b.txt", "b");
+  EXPECT_TRUE(WaitForChange(watcher, before));
+}
+
+TEST_F(DirectoryWatcherTest, NoticesSymlinks) {
+  fs::create_symlink(dir_.path() / "sub", dir_.path() / "existing");
+  DirectoryWatcher with_link(dir_.path().string());
+  EXPECT_FALSE(with_link.symlink_free());
+  fs::remove(dir_.path() / "existing");
+
+  DirectoryWatcher watcher(dir_.path().string());
+  ASSERT_TRUE(watcher.symlink_free());
+  std::uint64_t before = watcher.generation();
+  fs::create_symlink("/tmp", dir_.path() / "sub" / "later");
+  ASSERT_TRUE(WaitForChange(watcher, before));
+  EXPECT_FALSE(watcher.symlink_free());
+}
+
+TEST_F(DirectoryWatcherTest, MissingDirectoryIsUnhealthy) {
+  DirectoryWatcher watcher((dir_.path() / "missing").string());
+  EXPECT_FALSE(watcher.healthy());
+}
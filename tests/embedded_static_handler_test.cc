@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include "embedded_static_handler.h"
+#include "request.h"
+#include "validators.h"
+#include <string>
+
+// tests/embedded_www, compiled in by embed_assets
+EmbeddedAssetTable EmbeddedTestAssets();
+
+class EmbeddedStaticHandlerTest : public ::testing::Test {
+protected:
+    EmbeddedStaticHandler handler_{"/assets/", EmbeddedTestAssets()};
+
+    Response Get(const std::string& url, const std::string& headers = "",
+                 const std::string& version = "HTTP/1.1") {
+        return handler_.handle_request(Request("GET " + url + " " + version + "\r\n" +
+                                               headers + "\r\n"));
+    }
+};
+
+// Value of header name in a serialized response, "" if absent
+static std::string headerValue(const std::string& resp, const std::string& name) {
+    auto pos = resp.find("\r\n" + name + ": ");
+    if (pos == std::string::npos) return "";
+    pos += name.size() + 4;
+    return resp.substr(pos, resp.find("\r\n", pos) - pos);
+}
+
+// The generated table is sorted by path and carries prebuilt heads
+TEST_F(EmbeddedStaticHandlerTest, GeneratedTable) {
+    EmbeddedAssetTable assets = EmbeddedTestAssets();
+    ASSERT_EQ(assets.count, 3u);
+    EXPECT_EQ(handler_.size(), 3u);
+    EXPECT_EQ(assets.assets[0].path, "/css/app.css");
+    EXPECT_EQ(assets.assets[1].path, "/index.html");
+    EXPECT_EQ(assets.assets[2].path, "/raw.bin");
+
+    const EmbeddedAsset& css = assets.assets[0];
+    EXPECT_EQ(css.body, "body { margin: 0; }\n");
+    EXPECT_EQ(css.content_type, "text/css");
+    EXPECT_EQ(css.head, "HTTP/1.1 200 OK\r\nContent-Type: text/css\r\nContent-Length: 20\r\n"
+                        "ETag: " + std::string(css.etag) + "\r\nLast-Modified: " +
+                        validators::HttpDate(css.last_modified) + "\r\n");
+    EXPECT_EQ(assets.assets[2].body, std::string_view("a\"b\\c\0d?\377\n", 10));
+}
+
+TEST_F(EmbeddedStaticHandlerTest, ServesPrebuilt) {
+    Response response = Get("/assets/index.html?v=1");
+    EXPECT_EQ(response.get_status_code(), 200);
+    EXPECT_NE(response.get_prebuilt_owner(), nullptr);
+    std::string s = response.to_string();
+    EXPECT_EQ(headerValue(s, "Content-Type"), "text/html; charset=utf-8");
+    EXPECT_EQ(s.substr(s.find("\r\n\r\n") + 4), "<!doctype html><title>embedded</title>\n");
+
+    Response missing = Get("/assets/nope.html");
+    EXPECT_EQ(missing.get_status_code(), 404);
+    EXPECT_EQ(Get("/index.html").get_status_code(), 404);
+}
+
+// ETags come from the bytes, so they hold across rebuilds
+TEST_F(EmbeddedStaticHandlerTest, NotModified) {
+    std::string etag = headerValue(Get("/assets/css/app.css").to_string(), "ETag");
+    ASSERT_FALSE(etag.empty());
+    Response response = Get("/assets/css/app.css", "If-None-Match: " + etag + "\r\n");
+    EXPECT_EQ(response.get_status_code(), 304);
+    EXPECT_EQ(headerValue(response.to_string(), "ETag"), etag);
+}
+
+// HTTP/1.0 gets its own status line and headers around the embedded body,
+// which is still not copied
+TEST_F(EmbeddedStaticHandlerTest, Http10SharesBody) {
+    Response response = Get("/assets/raw.bin", "", "HTTP/1.0");
+    EXPECT_EQ(response.get_status_code(), 200);
+    EXPECT_NE(response.get_prebuilt_owner(), nullptr);
+    EXPECT_EQ(response.get_prebuilt_head(), "");
+    EXPECT_EQ(response.get_body(), "");
+    std::string s = response.to_string();
+    EXPECT_EQ(s.rfind("HTTP/1.0 200", 0), 0u);
+    EXPECT_EQ(headerValue(s, "Content-Type"), "application/octet-stream");
+    EXPECT_EQ(headerValue(s, "Content-Length"), "10");
+    EXPECT_EQ(s.substr(s.find("\r\n\r\n") + 4), std::string("a\"b\\c\0d?\377\n", 10));
+}
+
+// HEAD is answered from the prebuilt head without copying the body
+TEST_F(EmbeddedStaticHandlerTest, HeadSharesBody) {
+    Response response = handler_.handle_request(
+        Request("HEAD /assets/css/app.css HTTP/1.1\r\n\r\n"));
+    EXPECT_EQ(response.get_status_code(), 200);
+    EXPECT_NE(response.get_prebuilt_owner(), nullptr);
+    EXPECT_EQ(response.get_body(), "");
+    EXPECT_EQ(headerValue(response.header_string(), "Content-Length"), "20");
+}
+
+// The unit test binary embeds nothing as EmbeddedAssets()
+TEST_F(EmbeddedStaticHandlerTest, InitWithoutAssetsThrows) {
+    EXPECT_THROW(EmbeddedStaticHandler::Init("/assets", {}), std::runtime_error);
+}
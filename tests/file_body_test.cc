@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <unistd.h>
+#include "file_body.h"
+#include "temp_dir.h"
+
+namespace fs = std::filesystem;
+
+// ----------  FileBodyTest Fixture  ---------------
+class FileBodyTest : public ::testing::Test {
+  protected:
+    void SetUp() override { dir_.Write("hello.txt", "hello world"); }
+
+    TempDir dir_;
+};
+
+// ----------------- FileBody unit tests -----------------
+TEST_F(FileBodyTest, OpensRegularFile) {
+  auto file = FileBody::Open((dir_.path() / "hello.txt").string());
+  ASSERT_NE(file, nullptr);
+  EXPECT_GE(file->fd(), 0);
+  EXPECT_EQ(file->size(), 11u);
+}
+
+TEST_F(FileBodyTest, MissingFileReturnsNull) {
+  EXPECT_EQ(FileBody::Open((dir_.path() / "missing.txt").string()), nullptr);
+}
+
+TEST_F(FileBodyTest, DirectoryReturnsNull) {
+  EXPECT_EQ(FileBody::Open(dir_.path().string()), nullptr);
+}
+
+TEST_F(FileBodyTest, ReadsAtOffsets) {
+  auto file = FileBody::Open((dir_.path() / "hello.txt").string());
+  ASSERT_NE(file, nullptr);
+  EXPECT_EQ(file->Read(0, 5), "hello");
+  EXPECT_EQ(file->Read(6, 5), "world");
+  // Reads are positional, so they don't depend on each other
+  EXPECT_EQ(file->Read(0, 11), "hello world");
+  // Past the end returns only what exists
+  EXPECT_EQ(file->Read(6, 100), "world");
+}
+
+TEST_F(FileBodyTest, OutlivesUnlink) {
+  auto file = FileBody::Open((dir_.path() / "hello.txt").string());
+  ASSERT_NE(file, nullptr);
+  fs::remove(dir_.path() / "hello.txt");
+  EXPECT_EQ(file->Read(0, 11), "hello world");
+}
@@ -86,6 +86,62 @@ TEST(HandlerRegistryTest, CreateHandlerUnknownNameThrows) {
   );
 }
 
+// -----------------------------------------------------------------------------
+// Sharing tests
+// -----------------------------------------------------------------------------
+
+// Handlers registered without a sharing mode keep per-request instances.
+TEST(HandlerRegistryTest, SharingDefaultsToPerRequest) {
+  ASSERT_TRUE(HandlerRegistry::RegisterHandler(
+      "DefaultSharing",
+      [](const std::string&, const std::unordered_map<std::string, std::string>&) {
+        return new DummyHandler();
+      }));
+  EXPECT_EQ(HandlerRegistry::GetSharing("DefaultSharing"), HandlerRegistry::PER_REQUEST);
+}
+
+// The declared sharing mode is returned as registered.
+TEST(HandlerRegistryTest, SharingIsRecorded) {
+  ASSERT_TRUE(HandlerRegistry::RegisterHandler(
+      "ThreadSharing",
+      [](const std::string&, const std::unordered_map<std::string, std::string>&) {
+        return new DummyHandler();
+      },
+      HandlerRegistry::PER_THREAD));
+  EXPECT_EQ(HandlerRegistry::GetSharing("ThreadSharing"), HandlerRegistry::PER_THREAD);
+}
+
+// Looking up the sharing of an unknown handler name should throw.
+TEST(HandlerRegistryTest, GetSharingUnknownNameThrows) {
+  EXPECT_THROW(HandlerRegistry::GetSharing("DoesNotExist"), std::runtime_error);
+}
+
+// Stateless built-in handlers are shared by every thread.
+TEST(HandlerRegistryTest, BuiltinHandlersAreShared) {
+  EXPECT_EQ(HandlerRegistry::GetSharing(EchoHandler::kName), HandlerRegistry::SHARED);
+  EXPECT_EQ(HandlerRegistry::GetSharing(StaticHandler::kName), HandlerRegistry::SHARED);
+  EXPECT_EQ(HandlerRegistry::GetSharing(HealthHandler::kName), HandlerRegistry::SHARED);
+  EXPECT_EQ(HandlerRegistry::GetSharing(NotFoundHandler::kName), HandlerRegistry::SHARED);
+  EXPECT_EQ(HandlerRegistry::GetSharing(SleepHandler::kName), HandlerRegistry::SHARED);
+}
+
+// Handlers are non-blocking unless they say otherwise.
+TEST(HandlerRegistryTest, BlockingIsRecorded) {
+  auto factory = [](const std::string&, const std::unordered_map<std::string, std::string>&) {
+    return new DummyHandler();
+  };
+  ASSERT_TRUE(HandlerRegistry::RegisterHandler("DefaultBlocking", factory));
+  ASSERT_TRUE(HandlerRegistry::RegisterHandler("Blocking", factory, HandlerRegistry::SHARED,
+                                               HandlerRegistry::BLOCKING));
+  EXPECT_EQ(HandlerRegistry::GetBlocking("DefaultBlocking"), HandlerRegistry::NON_BLOCKING);
+  EXPECT_EQ(HandlerRegistry::GetBlocking("Blocking"), HandlerRegistry::BLOCKING);
+  EXPECT_THROW(HandlerRegistry::GetBlocking("DoesNotExist"), std::runtime_error);
+
+  EXPECT_EQ(HandlerRegistry::GetBlocking(SleepHandler::kName), HandlerRegistry::ASYNC);
+  EXPECT_EQ(HandlerRegistry::GetBlocking(StaticHandler::kName), HandlerRegistry::NON_BLOCKING);
+  EXPECT_EQ(HandlerRegistry::GetBlocking(EchoHandler::kName), HandlerRegistry::NON_BLOCKING);
+}
+
 // -----------------------------------------------------------------------------
 // Built-in handler registration
 // -----------------------------------------------------------------------------
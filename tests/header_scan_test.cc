@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+#include "header_scan.h"
+#include "request_parser.h"
+
+// ----------  HeaderScanTest Fixture  ---------------
+class HeaderScanTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+      original_ = header_scan::ActiveImpl();
+      impls_ = {header_scan::IMPL_SCALAR};
+      if (header_scan::IsSupported(header_scan::IMPL_SSE2)) impls_.push_back(header_scan::IMPL_SSE2);
+      if (header_scan::IsSupported(header_scan::IMPL_AVX2)) impls_.push_back(header_scan::IMPL_AVX2);
+    }
+
+    void TearDown() override {
+      header_scan::ForceImpl(original_);
+    }
+
+    // Offset of the first a or b in text, using impl
+    std::size_t Find(header_scan::Impl impl, const std::string& text, char a, char b) {
+      header_scan::ForceImpl(impl);
+      const char* begin = text.data();
+      return header_scan::FindEither(begin, begin + text.size(), a, b) - begin;
+    }
+
+    header_scan::Impl original_;
+    std::vector<header_scan::Impl> impls_;
+};
+
+// ----------------- header_scan unit tests -----------------
+TEST_F(HeaderScanTest, ScalarAlwaysSupported) {
+  EXPECT_TRUE(header_scan::IsSupported(header_scan::IMPL_SCALAR));
+  EXPECT_TRUE(header_scan::IsSupported(header_scan::ActiveImpl()));
+  EXPECT_STREQ(header_scan::ImplName(header_scan::IMPL_SCALAR), "scalar");
+}
+
+TEST_F(HeaderScanTest, EmptyRangeReturnsEnd) {
+  for (header_scan::Impl impl : impls_) {
+    EXPECT_EQ(Find(impl, "", '\n', ':'), 0u) << header_scan::ImplName(impl);
+  }
+}
+
+TEST_F(HeaderScanTest, EveryPositionAndLength) {
+  // Covers hits in the vector body and in tails shorter than 16 and 32 bytes
+  for (std::size_t length = 1; length <= 80; ++length) {
+    for (std::size_t hit = 0; hit <= length; ++hit) {
+      std::string text(length, 'x');
+      if (hit < length) text[hit] = (hit % 2) ? '\n' : ':';
+      for (header_scan::Impl impl : impls_) {
+        ASSERT_EQ(Find(impl, text, '\n', ':'), hit)
+            << header_scan::ImplName(impl) << " length " << length;
+      }
+    }
+  }
+}
+
+TEST_F(HeaderScanTest, RandomInputMatchesScalar) {
+  std::mt19937 rng(42);
+  const std::string alphabet = "abc: \r\n";
+  for (int round = 0; round < 500; ++round) {
+    std::string text(rng() % 300, ' ');
+    for (char& c : text) c = (rng() % 8 == 0) ? alphabet[rng() % alphabet.size()] : 'z';
+    std::size_t expected = Find(header_scan::IMPL_SCALAR, text, '\n', ':');
+    for (header_scan::Impl impl : impls_) {
+      ASSERT_EQ(Find(impl, text, '\n', ':'), expected) << header_scan::ImplName(impl);
+    }
+  }
+}
+
+TEST_F(HeaderScanTest, HighBytesDoNotMatch) {
+  // Signed char comparisons must not treat bytes >= 0x80 as special
+  std::string text(64, static_cast<char>(0x8a));
+  text[50] = ' ';
+  for (header_scan::Impl impl : impls_) {
+    EXPECT_EQ(Find(impl, text, '\n', ' '), 50u) << header_scan::ImplName(impl);
+  }
+}
+
+TEST_F(HeaderScanTest, ParserAgreesAcrossImpls) {
+  std::string buf = "GET /a/long/enough/path/to/cross/a/vector/boundary HTTP/1.1\r\n"
+                    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36\r\n"
+                    "Cookie: session=abcdefghijklmnopqrstuvwxyz0123456789; theme=dark\r\n"
+                    "Content-Length: 4\r\n\r\nbody";
+  for (header_scan::Impl impl : impls_) {
+    header_scan::ForceImpl(impl);
+    RequestParser parser;
+    ASSERT_EQ(parser.Parse(buf), RequestParser::COMPLETE) << header_scan::ImplName(impl);
+    const RequestLayout& layout = parser.layout();
+    EXPECT_TRUE(layout.request_line_ok);
+    EXPECT_TRUE(layout.headers_ok);
+    ASSERT_EQ(layout.headers.size(), 3u);
+    EXPECT_EQ(buf.substr(layout.headers[1].value.offset, layout.headers[1].value.length),
+              "session=abcdefghijklmnopqrstuvwxyz0123456789; theme=dark");
+    EXPECT_EQ(layout.content_length, 4u);
+    EXPECT_EQ(parser.request_length(), buf.size());
+  }
+}
@@ -2,6 +2,7 @@
 """End-to-end checks for the web-server with echo + static support."""
 from __future__ import annotations
 import os, signal, socket, subprocess, sys, tempfile, textwrap, time, json
+from email.utils import formatdate
 from dataclasses import dataclass
 from pathlib import Path
 from typing import Callable
@@ -128,16 +129,42 @@ def echo_200(port: int) -> str:
     return ( "HTTP/1.1 200 OK\n"
              "Content-Type: text/plain\n"
              f"Content-Length: {ln}\n"
-             "Connection: close\n"
+             "Connection: keep-alive\n"
              "\n" + req.replace("\r\n", "\n") )
 
-def file_200(body: str, ctype="text/plain") -> str:
+def validator_lines(path: Path) -> str:
+    # ETag and Last-Modified as the server derives them from stat()
+    st = path.stat()
+    etag = f'"{st.st_ino:x}-{st.st_size:x}-{st.st_mtime_ns:x}"'
+    return (f"ETag: {etag}\n"
+            f"Last-Modified: {formatdate(st.st_mtime_ns // 10**9, usegmt=True)}\n")
+
+def file_200(body: str, ctype="text/plain", path: Path | None = None,
+             accept_ranges=False) -> str:
     return ( "HTTP/1.1 200 OK\n"
              f"Content-Type: {ctype}\n"
              f"Content-Length: {len(body)}\n"
-             "Connection: close\n"
+             + (validator_lines(path) if path else "")
+             + ("Accept-Ranges: bytes\n" if accept_ranges else "") +
+             "Connection: keep-alive\n"
              "\n" + body )
 
+def partial_206(body: str, first: int, last: int, ctype: str, path: Path) -> str:
+    return ( "HTTP/1.1 206 Partial Content\n"
+             f"Content-Type: {ctype}\n"
+             f"Content-Length: {last - first + 1}\n"
+             + validator_lines(path) +
+             "Accept-Ranges: bytes\n"
+             f"Content-Range: bytes {first}-{last}/{len(body)}\n"
+             "Connection: close\n"
+             "\n" + body[first:last + 1] )
+
+def not_modified_304(path: Path) -> str:
+    return ( "HTTP/1.1 304 Not Modified\n"
+             + validator_lines(path) +
+             "Connection: keep-alive\n"
+             "\n" )
+
 BAD_REQUEST_400 = textwrap.dedent("""\
     HTTP/1.1 400 Bad Request
     Content-Type: text/plain
@@ -150,7 +177,7 @@ NOT_FOUND_404 = textwrap.dedent("""\
     HTTP/1.1 404 Not Found
     Content-Type: text/plain
     Content-Length: 72
-    Connection: close
+    Connection: keep-alive
 
     404 Not Found: The requested resource could not be found on this server.""").replace("\r\n", "\n")
 
@@ -158,7 +185,7 @@ BAD_REQUEST_404 = textwrap.dedent("""\
 HTTP/1.1 404 Not Found
 Content-Type: text/plain
 Content-Length: 25
-Connection: close
+Connection: keep-alive
 
 404 Error: File not found""").replace("\r\n", "\n")
 
@@ -166,7 +193,7 @@ OK_REQUEST_200 = textwrap.dedent("""\
     HTTP/1.1 200 OK
     Content-Type: text/plain
     Content-Length: 2
-    Connection: close
+    Connection: keep-alive
 
     OK""").replace("\r\n", "\n")
 
@@ -269,26 +296,44 @@ def main() -> int:
                      echo_200),
                 Case("static file",
                      lambda p: curl(f"http://127.0.0.1:{p}/static/hello.txt"),
-                     lambda _p: file_200(txt_body, ctype="text/plain; charset=utf-8")),
+                     lambda _p: file_200(txt_body, ctype="text/plain; charset=utf-8",
+                                         path=stat_root / "hello.txt", accept_ranges=True)),
+                Case("static file range",
+                     lambda p: raw(p,
+                       f"GET /static/hello.txt HTTP/1.1\r\nHost: 127.0.0.1:{p}\r\n"
+                       "Range: bytes=1-3\r\nConnection: close\r\n\r\n"),
+                     lambda _p: partial_206(txt_body, 1, 3, "text/plain; charset=utf-8",
+                                            stat_root / "hello.txt")),
+                Case("static file not modified",
+                     lambda p: raw(p,
+                       f"GET /static/hello.txt HTTP/1.1\r\nHost: 127.0.0.1:{p}\r\n"
+                       f"If-Modified-Since: {formatdate(time.time() + 60, usegmt=True)}\r\n"
+                       "Connection: close\r\n\r\n"),
+                     lambda _p: not_modified_304(stat_root / "hello.txt").replace(
+                       "Connection: keep-alive", "Connection: close")),
                 Case("bad verb",
                      lambda p: raw(p,
                        f"BAD / HTTP/1.1\r\nHost: 127.0.0.1:{p}\r\n\r\n"),
                      BAD_REQUEST_400),
                 Case("static HTML file",
                     lambda p: curl(f"http://127.0.0.1:{p}/static/index.html"),
-                    lambda _p: file_200(html_body, ctype="text/html; charset=utf-8")),
+                    lambda _p: file_200(html_body, ctype="text/html; charset=utf-8",
+                                        path=stat_root / "index.html", accept_ranges=True)),
                 Case("static JPG file",
                     lambda p: curl(f"http://127.0.0.1:{p}/static/image.jpg", binary=True),
                     lambda _p: (
                         b"HTTP/1.1 200 OK\r\n"
                         b"Content-Type: image/jpeg\r\n"
                         + f"Content-Length: {len(jpg_bytes)}\r\n".encode()
-                        + b"Connection: close\r\n\r\n"
+                        + validator_lines(stat_root / "image.jpg").replace("\n", "\r\n").encode()
+                        + b"Accept-Ranges: bytes\r\n"
+                        + b"Connection: keep-alive\r\n\r\n"
                         + jpg_bytes
                     )),
                 Case("static file from different route",
                     lambda p: curl(f"http://127.0.0.1:{p}/public/hello.txt"),
-                    lambda _p: file_200(txt_body, ctype="text/plain; charset=utf-8")),
+                    lambda _p: file_200(txt_body, ctype="text/plain; charset=utf-8",
+                                        path=stat_root / "hello.txt", accept_ranges=True)),
                 Case("unknown file",
                     lambda p: curl(f"http://127.0.0.1:{p}/static/missing"),
                     BAD_REQUEST_404),
@@ -297,10 +342,12 @@ def main() -> int:
                     "400 Bad Request: ID does not exist"), 
                 Case("markdown file",
                     lambda p: curl(f"http://127.0.0.1:{p}/markdown/test.md"),
-                    lambda _p: file_200(md_full_html, ctype="text/html; charset=utf-8")),
+                    lambda _p: file_200(md_full_html, ctype="text/html; charset=utf-8",
+                                        path=md_root / "test.md")),
                 Case("plain .log file without charset",
                     lambda p: curl(f"http://127.0.0.1:{p}/static/test.log"),
-                    lambda _p: file_200(log_body, ctype="text/plain")), # Test for same MIME type of "text/plain" but extension isn't .txt. Should return "text/plain" only with no charset=utf-8
+                    lambda _p: file_200(log_body, ctype="text/plain", path=stat_root / "test.log",
+                                        accept_ranges=True)), # Test for same MIME type of "text/plain" but extension isn't .txt. Should return "text/plain" only with no charset=utf-8
                 Case("health check",
                     lambda p: curl(f"http://127.0.0.1:{p}/health"),
                     OK_REQUEST_200),
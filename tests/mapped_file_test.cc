@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <string_view>
+#include "mapped_file.h"
+#include "temp_dir.h"
+
+namespace fs = std::filesystem;
+
+// ----------  MappedFileTest Fixture  ---------------
+class MappedFileTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+      path_ = (dir_.path() / "asset.js").string();
+      dir_.Write("asset.js", "console.log(1);");
+    }
+
+    std::shared_ptr<const MappedFile> MapPath(const std::string& path) {
+      auto file = FileBody::Open(path);
+      return file ? MappedFile::Map(*file, MappedFile::ADVICE_WILLNEED) : nullptr;
+    }
+
+    TempDir dir_;
+    std::string path_;
+};
+
+// ----------------- MappedFile unit tests -----------------
+TEST_F(MappedFileTest, MapsWholeFile) {
+  auto mapping = MapPath(path_);
+  ASSERT_NE(mapping, nullptr);
+  EXPECT_EQ(std::string_view(mapping->data(), mapping->size()), "console.log(1);");
+  EXPECT_TRUE(mapping->stat().regular);
+}
+
+TEST_F(MappedFileTest, EmptyFile) {
+  dir_.Write("empty.js", "");
+  auto mapping = MapPath((dir_.path() / "empty.js").string());
+  ASSERT_NE(mapping, nullptr);
+  EXPECT_EQ(mapping->size(), 0u);
+  EXPECT_EQ(mapping->data(), nullptr);
+}
+
+// The mapping outlives the file it was made from being replaced
+TEST_F(MappedFileTest, SurvivesReplacement) {
+  auto mapping = MapPath(path_);
+  dir_.Write("asset.js.new", "console.log(2);");
+  fs::rename(dir_.path() / "asset.js.new", path_);
+  EXPECT_EQ(std::string_view(mapping->data(), mapping->size()), "console.log(1);");
+}
+
+TEST_F(MappedFileTest, ParseAdvice) {
+  MappedFile::Advice advice = MappedFile::ADVICE_NORMAL;
+  EXPECT_TRUE(MappedFile::ParseAdvice("random", advice));
+  EXPECT_EQ(advice, MappedFile::ADVICE_RANDOM);
+  EXPECT_TRUE(MappedFile::ParseAdvice("sequential", advice));
+  EXPECT_EQ(advice, MappedFile::ADVICE_SEQUENTIAL);
+  EXPECT_FALSE(MappedFile::ParseAdvice("Random", advice));
+  EXPECT_FALSE(MappedFile::ParseAdvice("", advice));
+  EXPECT_EQ(advice, MappedFile::ADVICE_SEQUENTIAL);
+}
+
+// ----------------- MappedFileTable unit tests -----------------
+TEST_F(MappedFileTest, TableHitsUntilFileChanges) {
+  MappedFileTable table;
+  auto mapping = MapPath(path_);
+  FileStat st = mapping->stat();
+  EXPECT_EQ(table.Lookup(path_, st), nullptr);
+  table.Insert(path_, mapping);
+  EXPECT_EQ(table.Lookup(path_, st), mapping);
+
+  // Same path, other inode: the old mapping is dropped
+  dir_.Write("asset.js.new", "console.log(22);");
+  fs::rename(dir_.path() / "asset.js.new", path_);
+  FileStat current;
+  ASSERT_TRUE(FileStat::Load(path_, current));
+  EXPECT_EQ(table.Lookup(path_, current), nullptr);
+
+  auto stats = table.GetStats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 2u);
+  EXPECT_EQ(stats.entries, 0u);
+}
+
+TEST_F(MappedFileTest, TableBounded) {
+  MappedFileTable table(2, 1);
+  for (int i = 0; i < 3; ++i) {
+    std::string name = "f" + std::to_string(i);
+    dir_.Write(name, name);
+    table.Insert((dir_.path() / name).string(), MapPath((dir_.path() / name).string()));
+  }
+  auto stats = table.GetStats();
+  EXPECT_LE(stats.entries, 2u);
+  EXPECT_GE(stats.entries, 1u);
+}
@@ -219,4 +219,19 @@ TEST_F(MarkdownHandlerTest, BadMethod) {
     std::string resp_str = response.to_string();
 
     EXPECT_NE(resp_str.find("HTTP/1.1 400 Bad Request"), std::string::npos);
-}
\ No newline at end of file
+}
+
+// Rendered pages carry the source file's validators and revalidate to 304
+TEST_F(MarkdownHandlerTest, NotModified) {
+    Response first = handler_->handle_request(Request("GET /markdown/test.md HTTP/1.1\r\n\r\n"));
+    ASSERT_EQ(first.get_status_code(), 200);
+    std::string etag = first.get_header("ETag");
+    ASSERT_FALSE(etag.empty());
+    EXPECT_FALSE(first.get_header("Last-Modified").empty());
+
+    Response second = handler_->handle_request(
+        Request("GET /markdown/test.md HTTP/1.1\r\nIf-None-Match: " + etag + "\r\n\r\n"));
+    EXPECT_EQ(second.get_status_code(), 304);
+    std::string s = second.to_string();
+    EXPECT_EQ(s.substr(s.find("\r\n\r\n") + 4), "");
+}
@@ -0,0 +1,202 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include "open_file_cache.h"
+#include "real_filesystem.h"
+#include "temp_dir.h"
+
+namespace fs = std::filesystem;
+
+// ----------  OpenFileCacheTest Fixture  ---------------
+class OpenFileCacheTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+      dir_.Write("a.txt", "alpha");
+      dir_.Write("b.txt", "bravo");
+      dir_.Write("c.txt", "charlie");
+    }
+
+    std::string Path(const std::string& name) { return (dir_.path() / name).string(); }
+
+    // A cache on a clock the test advances by hand, in one shard so the
+    // size limit is exact
+    std::unique_ptr<OpenFileCache> MakeCache(std::size_t max_entries, unsigned inactive = 20,
+                                             unsigned valid = 60) {
+      OpenFileCacheOptions options;
+      options.max_entries = max_entries;
+      options.inactive_seconds = inactive;
+      options.valid_seconds = valid;
+      return std::make_unique<OpenFileCache>(options, 1, [this] { return now_; });
+    }
+
+    void Advance(int seconds) { now_ += std::chrono::seconds(seconds); }
+
+    TempDir dir_;
+    OpenFileCache::Clock::time_point now_{};
+};
+
+// ----------------- OpenFileCache unit tests -----------------
+TEST_F(OpenFileCacheTest, HitSharesDescriptor) {
+  auto cache = MakeCache(8);
+  auto first = cache->Open(Path("a.txt"));
+  ASSERT_NE(first, nullptr);
+  auto second = cache->Open(Path("a.txt"));
+  EXPECT_EQ(first, second);
+  EXPECT_EQ(second->Read(0, second->size()), "alpha");
+
+  auto stats = cache->GetStats();
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.entries, 1u);
+}
+
+TEST_F(OpenFileCacheTest, DisabledOpensEveryTime) {
+  auto cache = MakeCache(0);
+  auto first = cache->Open(Path("a.txt"));
+  ASSERT_NE(first, nullptr);
+  EXPECT_NE(first, cache->Open(Path("a.txt")));
+  EXPECT_EQ(cache->GetStats().entries, 0u);
+}
+
+TEST_F(OpenFileCacheTest, MissingFileNotCached) {
+  auto cache = MakeCache(8);
+  EXPECT_EQ(cache->Open(Path("nope.txt")), nullptr);
+  EXPECT_EQ(cache->Open(dir_.path().string()), nullptr);
+  EXPECT_EQ(cache->GetStats().entries, 0u);
+}
+
+TEST_F(OpenFileCacheTest, TrustedWithinValidity) {
+  auto cache = MakeCache(8, 20, 10);
+  auto first = cache->Open(Path("a.txt"));
+  fs::remove(Path("a.txt"));
+  dir_.Write("a.txt", "changed");
+
+  // Still inside the interval, the old file is served without a stat
+  Advance(5);
+  EXPECT_EQ(cache->Open(Path("a.txt")), first);
+  EXPECT_EQ(cache->GetStats().revalidations, 0u);
+
+  // After it, the change is noticed
+  Advance(6);
+  auto fresh = cache->Open(Path("a.txt"));
+  ASSERT_NE(fresh, nullptr);
+  EXPECT_NE(fresh, first);
+  EXPECT_EQ(fresh->Read(0, fresh->size()), "changed");
+  EXPECT_EQ(cache->GetStats().revalidations, 1u);
+}
+
+TEST_F(OpenFileCacheTest, RevalidatedUnchangedKeepsDescriptor) {
+  auto cache = MakeCache(8, 100, 10);
+  auto first = cache->Open(Path("a.txt"));
+  Advance(11);
+  EXPECT_EQ(cache->Open(Path("a.txt")), first);
+  auto stats = cache->GetStats();
+  EXPECT_EQ(stats.revalidations, 1u);
+  EXPECT_EQ(stats.misses, 1u);
+}
+
+TEST_F(OpenFileCacheTest, DeletedFileDropped) {
+  auto cache = MakeCache(8, 20, 0);
+  ASSERT_NE(cache->Open(Path("a.txt")), nullptr);
+  fs::remove(Path("a.txt"));
+  EXPECT_EQ(cache->Open(Path("a.txt")), nullptr);
+  EXPECT_EQ(cache->GetStats().entries, 0u);
+}
+
+TEST_F(OpenFileCacheTest, EvictsLeastRecentlyUsed) {
+  auto cache = MakeCache(2);
+  auto a = cache->Open(Path("a.txt"));
+  cache->Open(Path("b.txt"));
+  cache->Open(Path("a.txt"));
+  cache->Open(Path("c.txt"));
+
+  auto stats = cache->GetStats();
+  EXPECT_EQ(stats.entries, 2u);
+  EXPECT_EQ(stats.evictions, 1u);
+  // b was the least recently used
+  EXPECT_EQ(cache->Open(Path("a.txt")), a);
+  EXPECT_EQ(cache->GetStats().misses, 3u);
+}
+
+TEST_F(OpenFileCacheTest, InactiveFilesClosed) {
+  auto cache = MakeCache(8, 10, 60);
+  cache->Open(Path("a.txt"));
+  Advance(5);
+  cache->Open(Path("b.txt"));
+  Advance(6);
+  // a went unused for 11 seconds, b for 6
+  cache->Open(Path("c.txt"));
+  auto stats = cache->GetStats();
+  EXPECT_EQ(stats.entries, 2u);
+  EXPECT_EQ(stats.evictions, 1u);
+}
+
+TEST_F(OpenFileCacheTest, EvictedFileStaysReadableWhileInUse) {
+  auto cache = MakeCache(1);
+  auto a = cache->Open(Path("a.txt"));
+  cache->Open(Path("b.txt"));
+  EXPECT_EQ(cache->GetStats().evictions, 1u);
+  EXPECT_EQ(a->Read(0, a->size()), "alpha");
+}
+
+TEST_F(OpenFileCacheTest, InvalidateForcesReopen) {
+  auto cache = MakeCache(8);
+  auto first = cache->Open(Path("a.txt"));
+  cache->Invalidate(Path("a.txt"));
+  EXPECT_EQ(cache->GetStats().entries, 0u);
+  EXPECT_NE(cache->Open(Path("a.txt")), first);
+}
+
+// A write finishing between a miss's open and its insert (as
+// RealFileSystem::write_file does: truncate, write, Invalidate) keeps the
+// half-written file's stat out of the cache
+TEST_F(OpenFileCacheTest, InvalidateDuringOpenNotCached) {
+  OpenFileCacheOptions options;
+  options.max_entries = 8;
+  std::unique_ptr<OpenFileCache> cache;
+  int clock_reads = 0;
+  cache = std::make_unique<OpenFileCache>(options, 1, [&] {
+    // The second read comes after the file was opened
+    if (++clock_reads == 2) {
+      dir_.Write("a.txt", "alpha, written in full");
+      cache->Invalidate(Path("a.txt"));
+    }
+    return now_;
+  });
+
+  dir_.Write("a.txt", "");
+  auto truncated = cache->Open(Path("a.txt"));
+  ASSERT_NE(truncated, nullptr);
+  EXPECT_EQ(truncated->size(), 0u);
+  EXPECT_EQ(cache->GetStats().entries, 0u);
+
+  auto complete = cache->Open(Path("a.txt"));
+  ASSERT_NE(complete, nullptr);
+  EXPECT_EQ(complete->size(), 22u);
+  EXPECT_EQ(cache->GetStats().entries, 1u);
+}
+
+// ----------------- RealFileSystem with a cache -----------------
+TEST_F(OpenFileCacheTest, RealFileSystemWritesInvalidate) {
+  OpenFileCacheOptions options;
+  options.max_entries = 8;
+  auto cache = std::make_shared<OpenFileCache>(options);
+  RealFileSystem filesystem(cache);
+
+  EXPECT_EQ(filesystem.read_file(Path("a.txt")), "alpha");
+  EXPECT_EQ(filesystem.read_file(Path("a.txt")), "alpha");
+  EXPECT_EQ(cache->GetStats().hits, 1u);
+
+  // Rewritten in place, the stat kept with the descriptor would be stale
+  ASSERT_TRUE(filesystem.write_file(Path("a.txt"), std::string("a longer alpha")));
+  EXPECT_EQ(filesystem.read_file(Path("a.txt")), "a longer alpha");
+
+  FileStat st;
+  ASSERT_TRUE(filesystem.stat_file(Path("a.txt"), st));
+  EXPECT_EQ(st.size, 14u);
+  EXPECT_FALSE(filesystem.stat_file(dir_.path(), st));
+
+  ASSERT_TRUE(filesystem.remove(Path("a.txt")));
+  EXPECT_EQ(filesystem.open_file(Path("a.txt")), nullptr);
+  EXPECT_THROW(filesystem.read_file(Path("a.txt")), std::runtime_error);
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include <thread>
+#include "path_resolver.h"
+#include "temp_dir.h"
+
+namespace fs = std::filesystem;
+
+// ----------  PathResolverTest Fixture  ---------------
+class PathResolverTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+      dir_.Write("root/css/app.css", "body{}");
+      dir_.Write("outside/secret.txt", "secret");
+      root_ = fs::canonical(dir_.path() / "root").string();
+    }
+
+    TempDir dir_;
+    std::string root_;
+};
+
+// ----------------- PathResolver unit tests -----------------
+TEST_F(PathResolverTest, ResolvesCleanUrlsLexically) {
+  PathResolver resolver("/static", root_);
+  EXPECT_EQ(resolver.Resolve("/static/css/app.css"), root_ + "/css/app.css");
+  EXPECT_EQ(resolver.Resolve("/static/missing.txt"), root_ + "/missing.txt");
+  EXPECT_EQ(resolver.GetStats().lexical, 2u);
+  EXPECT_EQ(resolver.GetStats().misses, 0u);
+}
+
+TEST_F(PathResolverTest, RejectsOutsideMountAndTraversal) {
+  PathResolver resolver("/static", root_);
+  EXPECT_THROW(resolver.Resolve("/other/css/app.css"), std::runtime_error);
+  EXPECT_THROW(resolver.Resolve("/static/../outside/secret.txt"), std::runtime_error);
+  EXPECT_THROW(resolver.Resolve("/static/css/../../outside/secret.txt"), std::runtime_error);
+  // Dot segments that stay inside the root are fine
+  EXPECT_EQ(resolver.Resolve("/static/css/../css/app.css"), root_ + "/css/app.css");
+}
+
+// A sibling directory sharing the root's name as a prefix is still outside
+TEST_F(PathResolverTest, RejectsSiblingWithSamePrefix) {
+  fs::create_directories(dir_.path() / "rootkit");
+  PathResolver resolver("/static", root_);
+  EXPECT_THROW(resolver.Resolve("/static/../rootkit/x"), std::runtime_error);
+}
+
+TEST_F(PathResolverTest, CachesUncleanUrlsAndRejections) {
+  PathResolver resolver("/static", root_);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(resolver.Resolve("/static/css/./app.css"), root_ + "/css/app.css");
+    EXPECT_THROW(resolver.Resolve("/static/../outside/secret.txt"), std::runtime_error);
+  }
+  EXPECT_EQ(resolver.GetStats().misses, 2u);
+  EXPECT_EQ(resolver.GetStats().hits, 4u);
+}
+
+// Symlinks disable the lexical path and are followed by the slow one
+TEST_F(PathResolverTest, SymlinkEscapeRejected) {
+  fs::create_symlink(dir_.path() / "outside", dir_.path() / "root" / "link");
+  PathResolver resolver("/static", root_);
+  EXPECT_THROW(resolver.Resolve("/static/link/secret.txt"), std::runtime_error);
+  EXPECT_EQ(resolver.Resolve("/static/css/app.css"), root_ + "/css/app.css");
+  EXPECT_EQ(resolver.GetStats().lexical, 0u);
+}
+
+// A symlink created later is noticed through the watcher
+TEST_F(PathResolverTest, WatcherSeesNewSymlink) {
+  PathResolver resolver("/static", root_);
+  EXPECT_EQ(resolver.Resolve("/static/link/secret.txt"), root_ + "/link/secret.txt");
+
+  fs::create_symlink(dir_.path() / "outside", dir_.path() / "root" / "css" / "link");
+  bool rejected = false;
+  for (int i = 0; i < 200 && !rejected; ++i) {
+    try {
+      resolver.Resolve("/static/css/link/secret.txt");
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    } catch (const std::runtime_error&) {
+      rejected = true;
+    }
+  }
+  EXPECT_TRUE(rejected);
+}
+
+// Without a watcher nothing is cached, every URL is walked
+TEST_F(PathResolverTest, UnwatchedAlwaysWalks) {
+  PathResolver resolver("/static", root_, /*watch=*/false);
+  EXPECT_EQ(resolver.Resolve("/static/css/app.css"), root_ + "/css/app.css");
+  EXPECT_THROW(resolver.Resolve("/static/../outside/secret.txt"), std::runtime_error);
+  auto stats = resolver.GetStats();
+  EXPECT_EQ(stats.lexical + stats.hits + stats.misses, 0u);
+}
+
+// A root that doesn't exist fails per request rather than at startup
+TEST_F(PathResolverTest, MissingRoot) {
+  PathResolver resolver("/static", (dir_.path() / "nope").string());
+  EXPECT_THROW(resolver.Resolve("/static/a.txt"), std::runtime_error);
+}
@@ -0,0 +1,34 @@
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "perfect_hash.h"
+
+// ----------------- PerfectHash unit tests -----------------
+TEST(PerfectHashTest, FindsEveryKey) {
+  std::vector<std::string> owned;
+  for (int i = 0; i < 5000; ++i) owned.push_back("/static/asset" + std::to_string(i) + ".js");
+  std::vector<std::string_view> keys(owned.begin(), owned.end());
+  PerfectHash index(keys);
+
+  EXPECT_EQ(index.size(), owned.size());
+  for (std::size_t i = 0; i < owned.size(); ++i) EXPECT_EQ(index.Find(owned[i]), i);
+  EXPECT_EQ(index.Find("/static/asset5000.js"), PerfectHash::npos);
+  EXPECT_EQ(index.Find("/static/asset1.j"), PerfectHash::npos);
+  EXPECT_EQ(index.Find(""), PerfectHash::npos);
+}
+
+TEST(PerfectHashTest, EmptyAndSingleKey) {
+  PerfectHash empty({});
+  EXPECT_EQ(empty.size(), 0u);
+  EXPECT_EQ(empty.Find("/"), PerfectHash::npos);
+
+  PerfectHash one({"/index.html"});
+  EXPECT_EQ(one.Find("/index.html"), 0u);
+  EXPECT_EQ(one.Find("/index.htm"), PerfectHash::npos);
+}
+
+TEST(PerfectHashTest, DuplicateKeysThrow) {
+  EXPECT_THROW(PerfectHash({"/a", "/b", "/a"}), std::runtime_error);
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <filesystem>
+#include "precompressed_index.h"
+#include "temp_dir.h"
+
+namespace fs = std::filesystem;
+using content_encoding::Bit;
+
+// ----------  PrecompressedIndexTest Fixture  ---------------
+class PrecompressedIndexTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+      path_ = (dir_.path() / "app.css").string();
+      dir_.Write("app.css", "body{}");
+    }
+
+    FileStat Stat() {
+      FileStat st;
+      FileStat::Load(path_, st);
+      return st;
+    }
+
+    TempDir dir_;
+    std::string path_;
+    PrecompressedIndex index_;
+};
+
+// ----------------- PrecompressedIndex unit tests -----------------
+TEST_F(PrecompressedIndexTest, NoSiblings) {
+  EXPECT_EQ(index_.Lookup(path_, Stat()).available, 0u);
+}
+
+TEST_F(PrecompressedIndexTest, FindsSiblingsOnce) {
+  dir_.Write("app.css.br", "br");
+  dir_.Write("app.css.gz", "gz");
+  auto siblings = index_.Lookup(path_, Stat());
+  EXPECT_EQ(siblings.available, Bit(content_encoding::BROTLI) | Bit(content_encoding::GZIP));
+  EXPECT_EQ(siblings.stat[content_encoding::BROTLI].size, 2u);
+  EXPECT_EQ(index_.probes(), 1u);
+
+  // Unchanged file, answered from memory
+  index_.Lookup(path_, Stat());
+  EXPECT_EQ(index_.probes(), 1u);
+}
+
+TEST_F(PrecompressedIndexTest, ReprobedWhenFileChanges) {
+  index_.Lookup(path_, Stat());
+  dir_.Write("app.css", "body{color:red}");
+  dir_.Write("app.css.zst", "zst");
+  EXPECT_EQ(index_.Lookup(path_, Stat()).available, Bit(content_encoding::ZSTD));
+  EXPECT_EQ(index_.probes(), 2u);
+
+  index_.Invalidate(path_);
+  index_.Lookup(path_, Stat());
+  EXPECT_EQ(index_.probes(), 3u);
+}
+
+TEST_F(PrecompressedIndexTest, StaleSiblingIgnored) {
+  dir_.Write("app.css.gz", "gz");
+  fs::last_write_time(dir_.path() / "app.css.gz",
+                      fs::last_write_time(dir_.path() / "app.css") - std::chrono::hours(1));
+  EXPECT_EQ(index_.Lookup(path_, Stat()).available, 0u);
+}
@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <string>
+#include "preloaded_root.h"
+#include "temp_dir.h"
+
+namespace fs = std::filesystem;
+
+// ----------  PreloadedRootTest Fixture  ---------------
+class PreloadedRootTest : public ::testing::Test {
+  protected:
+    void SetUp() override {
+      dir_.Write("index.html", "<p>hi</p>");
+      dir_.Write("js/app.js", "console.log(1);");
+      dir_.Write("empty.txt", "");
+      outside_.Write("secret.txt", "secret");
+    }
+
+    static std::string ContentType(const std::string& path) {
+      return fs::path(path).extension() == ".html" ? "text/html" : "text/plain";
+    }
+
+    TempDir dir_;
+    TempDir outside_;
+};
+
+// ----------------- PreloadedRoot unit tests -----------------
+TEST_F(PreloadedRootTest, LoadsFilesWithPrebuiltHeads) {
+  auto root = PreloadedRoot::Load("/static/", dir_.path().string(), ContentType);
+  ASSERT_EQ(root->size(), 3u);
+  EXPECT_GE(root->bytes(), 9u + 15u);
+
+  const PreloadedRoot::File* index = root->Find("/static/index.html");
+  ASSERT_NE(index, nullptr);
+  EXPECT_EQ(index->url, "/static/index.html");
+  EXPECT_EQ(index->body, "<p>hi</p>");
+  EXPECT_EQ(index->head.rfind("HTTP/1.1 200 OK\r\nContent-Type: text/html\r\n"
+                              "Content-Length: 9\r\nETag: " + index->etag + "\r\n", 0), 0u);
+  EXPECT_EQ(index->head.substr(index->head.size() - 22), "Accept-Ranges: bytes\r\n");
+  EXPECT_GT(index->last_modified, 0);
+
+  const PreloadedRoot::File* app = root->Find("/static/js/app.js?v=3");
+  ASSERT_NE(app, nullptr);
+  EXPECT_EQ(app->body, "console.log(1);");
+  const PreloadedRoot::File* empty = root->Find("/static/empty.txt");
+  ASSERT_NE(empty, nullptr);
+  EXPECT_TRUE(empty->body.empty());
+
+  EXPECT_EQ(root->Find("/static/js"), nullptr);
+  EXPECT_EQ(root->Find("/static/missing.txt"), nullptr);
+  EXPECT_EQ(root->Find("/index.html"), nullptr);
+}
+
+TEST_F(PreloadedRootTest, SkipsLinksOutOfRoot) {
+  fs::create_symlink(outside_.path() / "secret.txt", dir_.path() / "secret.txt");
+  fs::create_symlink(dir_.path() / "index.html", dir_.path() / "home.html");
+  auto root = PreloadedRoot::Load("/", dir_.path().string(), ContentType);
+  EXPECT_EQ(root->Find("/secret.txt"), nullptr);
+  ASSERT_NE(root->Find("/home.html"), nullptr);
+  EXPECT_EQ(root->Find("/home.html")->body, "<p>hi</p>");
+}
+
+TEST_F(PreloadedRootTest, MissingRootThrows) {
+  EXPECT_THROW(PreloadedRoot::Load("/", (dir_.path() / "nope").string(), ContentType),
+               std::runtime_error);
+}
@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include "request_parser.h"
+
+// ----------  RequestParserTest Fixture  ---------------
+class RequestParserTest : public ::testing::Test {
+  protected:
+    // Returns the text of a span of the current request in buf
+    std::string Text(const std::string& buf, const RequestLayout::Span& span) {
+      return buf.substr(parser.request_begin() + span.offset, span.length);
+    }
+
+    RequestParser parser;
+};
+
+// ----------------- RequestParser unit tests -----------------
+TEST_F(RequestParserTest, CompleteRequest) {
+  std::string buf = "GET /foo HTTP/1.1\r\nHost: localhost\r\nAccept: */*\r\n\r\n";
+  ASSERT_EQ(parser.Parse(buf), RequestParser::COMPLETE);
+
+  const RequestLayout& layout = parser.layout();
+  EXPECT_TRUE(layout.request_line_ok);
+  EXPECT_TRUE(layout.headers_ok);
+  EXPECT_EQ(Text(buf, layout.method), "GET");
+  EXPECT_EQ(Text(buf, layout.url), "/foo");
+  EXPECT_EQ(Text(buf, layout.version), "HTTP/1.1");
+  ASSERT_EQ(layout.headers.size(), 2u);
+  EXPECT_EQ(Text(buf, layout.headers[0].name), "Host");
+  EXPECT_EQ(Text(buf, layout.headers[0].value), "localhost");
+  EXPECT_EQ(Text(buf, layout.headers[1].name), "Accept");
+  EXPECT_EQ(Text(buf, layout.headers[1].value), "*/*");
+  EXPECT_EQ(parser.request_length(), buf.size());
+}
+
+TEST_F(RequestParserTest, BareNewlines) {
+  std::string buf = "GET /foo HTTP/1.1\nHost: localhost\n\n";
+  ASSERT_EQ(parser.Parse(buf), RequestParser::COMPLETE);
+  EXPECT_EQ(Text(buf, parser.layout().version), "HTTP/1.1");
+  EXPECT_EQ(parser.request_length(), buf.size());
+}
+
+// Feeding one byte at a time resumes where the previous call stopped
+TEST_F(RequestParserTest, ByteAtATime) {
+  std::string full = "POST /api HTTP/1.1\r\nContent-Length: 5\r\nX: y\r\n\r\nhello";
+  std::string buf;
+  for (std::size_t i = 0; i + 1 < full.size(); ++i) {
+    buf.push_back(full[i]);
+    ASSERT_EQ(parser.Parse(buf), RequestParser::INCOMPLETE) << "at byte " << i;
+  }
+  buf.push_back(full.back());
+  ASSERT_EQ(parser.Parse(buf), RequestParser::COMPLETE);
+  EXPECT_EQ(parser.layout().content_length, 5u);
+  EXPECT_EQ(buf.substr(parser.layout().body_offset), "hello");
+  EXPECT_EQ(Text(buf, parser.layout().headers[1].value), "y");
+}
+
+TEST_F(RequestParserTest, WaitsForBody) {
+  std::string buf = "POST /api HTTP/1.1\r\nContent-Length: 10\r\n\r\nshort";
+  EXPECT_EQ(parser.Parse(buf), RequestParser::INCOMPLETE);
+  EXPECT_TRUE(parser.layout().headers_complete);
+  buf += "_body";
+  EXPECT_EQ(parser.Parse(buf), RequestParser::COMPLETE);
+}
+
+TEST_F(RequestParserTest, PipelinedRequests) {
+  std::string buf = "GET /a HTTP/1.1\r\n\r\nGET /b HTTP/1.1\r\nContent-Length: 2\r\n\r\nhiGET /c";
+  ASSERT_EQ(parser.Parse(buf), RequestParser::COMPLETE);
+  EXPECT_EQ(Text(buf, parser.layout().url), "/a");
+  parser.Next();
+
+  ASSERT_EQ(parser.Parse(buf), RequestParser::COMPLETE);
+  EXPECT_EQ(Text(buf, parser.layout().url), "/b");
+  parser.Next();
+
+  EXPECT_EQ(parser.Parse(buf), RequestParser::INCOMPLETE);
+
+  // Erase consumed bytes and finish the partial request
+  std::size_t consumed = parser.request_begin();
+  buf.erase(0, consumed);
+  parser.Rebase(consumed);
+  buf += " HTTP/1.1\r\n\r\n";
+  ASSERT_EQ(parser.Parse(buf), RequestParser::COMPLETE);
+  EXPECT_EQ(parser.request_begin(), 0u);
+  EXPECT_EQ(Text(buf, parser.layout().url), "/c");
+}
+
+TEST_F(RequestParserTest, ResetStartsOver) {
+  std::string buf = "GET /a HTTP/1.1\r\nHost: x\r\n\r\nGET /b";
+  ASSERT_EQ(parser.Parse(buf), RequestParser::COMPLETE);
+  parser.Next();
+  EXPECT_EQ(parser.Parse(buf), RequestParser::INCOMPLETE);
+
+  // A new connection's buffer
+  parser.Reset();
+  buf = "GET /c HTTP/1.1\r\n\r\n";
+  ASSERT_EQ(parser.Parse(buf), RequestParser::COMPLETE);
+  EXPECT_EQ(parser.request_begin(), 0u);
+  EXPECT_EQ(Text(buf, parser.layout().url), "/c");
+  EXPECT_TRUE(parser.layout().headers.empty());
+}
+
+TEST_F(RequestParserTest, BadRequestLine) {
+  std::string buf = "GET    /foo   HTTP/1.1\r\n\r\n";
+  ASSERT_EQ(parser.Parse(buf), RequestParser::COMPLETE);
+  EXPECT_FALSE(parser.layout().request_line_ok);
+}
+
+TEST_F(RequestParserTest, HeaderWithoutColon) {
+  std::string buf = "GET /foo HTTP/1.1\r\nAccept\r\n\r\n";
+  ASSERT_EQ(parser.Parse(buf), RequestParser::COMPLETE);
+  EXPECT_FALSE(parser.layout().headers_ok);
+}
+
+TEST_F(RequestParserTest, InvalidContentLength) {
+  std::string buf = "POST /api HTTP/1.1\r\nContent-Length: abc\r\n\r\n";
+  ASSERT_EQ(parser.Parse(buf), RequestParser::COMPLETE);
+  EXPECT_FALSE(parser.layout().headers_ok);
+  EXPECT_EQ(parser.layout().content_length, 0u);
+}
+
+TEST_F(RequestParserTest, ConflictingContentLength) {
+  std::string buf = "POST /api HTTP/1.1\r\nContent-Length: 3\r\nContent-Length: 5\r\n\r\nabcde";
+  ASSERT_EQ(parser.Parse(buf), RequestParser::COMPLETE);
+  EXPECT_FALSE(parser.layout().headers_ok);
+}
+
+TEST_F(RequestParserTest, TransferEncodingFramesNoBody) {
+  // Content-Length is ignored once Transfer-Encoding is sent
+  std::string head = "POST /api HTTP/1.1\r\ntransfer-encoding: chunked\r\nContent-Length: 100\r\n\r\n";
+  std::string buf = head + "5\r\nhello\r\n0\r\n\r\n";
+  ASSERT_EQ(parser.Parse(buf), RequestParser::COMPLETE);
+  EXPECT_TRUE(parser.layout().transfer_encoding);
+  EXPECT_EQ(parser.request_length(), head.size());
+
+  parser.Next();
+  EXPECT_FALSE(parser.layout().transfer_encoding);
+}
+
+TEST_F(RequestParserTest, LeadingEmptyLinesSkipped) {
+  std::string buf = "\r\n";
+  EXPECT_EQ(parser.Parse(buf), RequestParser::INCOMPLETE);
+  buf += "\nGET /foo HTTP/1.1\r\n\r\n";
+  ASSERT_EQ(parser.Parse(buf), RequestParser::COMPLETE);
+  EXPECT_EQ(parser.request_begin(), 3u);
+  EXPECT_TRUE(parser.layout().request_line_ok);
+  EXPECT_EQ(Text(buf, parser.layout().method), "GET");
+}
+
+// Headers past the limit are refused whether or not their end was seen
+TEST_F(RequestParserTest, HeadersTooLarge) {
+  std::string head = "GET /foo HTTP/1.1\r\nX-Fill: ";
+  std::string buf = head + std::string(RequestParser::kMaxHeaderBytes - head.size(), 'a');
+  EXPECT_EQ(parser.Parse(buf), RequestParser::INCOMPLETE);
+  buf += "a";
+  EXPECT_EQ(parser.Parse(buf), RequestParser::TOO_LARGE);
+  buf += "\r\n\r\n";
+  EXPECT_EQ(parser.Parse(buf), RequestParser::TOO_LARGE);
+
+  // Exactly at the limit, blank line included
+  parser.Reset();
+  std::string fits = head + std::string(RequestParser::kMaxHeaderBytes - head.size() - 4, 'a') +
+                     "\r\n\r\n";
+  EXPECT_EQ(parser.Parse(fits), RequestParser::COMPLETE);
+
+  // Whole in a single buffer
+  parser.Reset();
+  EXPECT_EQ(parser.Parse(fits.substr(0, fits.size() - 4) + "a\r\n\r\n"),
+            RequestParser::TOO_LARGE);
+}
@@ -171,3 +171,76 @@ TEST_F(RequestTest, BadRequestDuplicateHeader) {
   // Check fields
   ASSERT_FALSE(request->is_valid());
 }
+
+TEST_F(RequestTest, KeepAliveDefaults) {
+  EXPECT_TRUE(Request("GET /foo HTTP/1.1\r\n\r\n").keep_alive());
+  EXPECT_FALSE(Request("GET /foo HTTP/1.0\r\n\r\n").keep_alive());
+  EXPECT_FALSE(Request("bad\r\n\r\n").keep_alive());
+}
+
+TEST_F(RequestTest, KeepAliveConnectionHeader) {
+  EXPECT_FALSE(Request("GET /foo HTTP/1.1\r\nConnection: close\r\n\r\n").keep_alive());
+  EXPECT_FALSE(Request("GET /foo HTTP/1.1\r\nConnection: Close\r\n\r\n").keep_alive());
+  EXPECT_TRUE(Request("GET /foo HTTP/1.0\r\nConnection: keep-alive\r\n\r\n").keep_alive());
+  EXPECT_TRUE(Request("GET /foo HTTP/1.0\r\nConnection: Keep-Alive\r\n\r\n").keep_alive());
+  // Header names are case-insensitive
+  EXPECT_FALSE(Request("GET /foo HTTP/1.1\r\nconnection: close\r\n\r\n").keep_alive());
+  EXPECT_TRUE(Request("GET /foo HTTP/1.0\r\nCONNECTION: keep-alive\r\n\r\n").keep_alive());
+}
+
+TEST_F(RequestTest, HeaderNamesIgnoreCase) {
+  Request request("GET /foo HTTP/1.1\r\nhost: example.com\r\nIF-NONE-MATCH: \"x\"\r\n\r\n");
+  EXPECT_EQ(request.get_header("Host"), "example.com");
+  EXPECT_EQ(request.get_header("If-None-Match"), "\"x\"");
+  EXPECT_EQ(request.get_header("if-none-match"), "\"x\"");
+
+  // The same header twice, in any case, is still a duplicate
+  EXPECT_FALSE(Request("GET /foo HTTP/1.1\r\nHost: a\r\nhost: b\r\n\r\n").is_valid());
+}
+
+
+TEST_F(RequestTest, FramedRequestViewsBuffer) {
+  req = "POST /api HTTP/1.1\r\nContent-Length: 4\r\n\r\nbody";
+  RequestParser parser;
+  ASSERT_EQ(parser.Parse(req), RequestParser::COMPLETE);
+  Request framed(req, parser.layout());
+
+  // Fields point into the caller's buffer rather than copies of it
+  ASSERT_TRUE(framed.is_valid());
+  EXPECT_EQ(framed.get_body(), "body");
+  EXPECT_EQ(framed.get_body().data(), req.data() + req.size() - 4);
+  EXPECT_EQ(framed.get_url().data(), req.data() + 5);
+  EXPECT_EQ(framed.get_header("Content-Length"), "4");
+}
+
+TEST_F(RequestTest, StandaloneRequestOutlivesText) {
+  std::unique_ptr<Request> copy;
+  {
+    Request original(std::string("GET /foo HTTP/1.1\r\nHost: localhost\r\n\r\n"));
+    copy = std::make_unique<Request>(original);
+  }
+  ASSERT_TRUE(copy->is_valid());
+  EXPECT_EQ(copy->get_url(), "/foo");
+  EXPECT_EQ(copy->get_header("Host"), "localhost");
+}
+
+TEST_F(RequestTest, DetachedRequestOwnsText) {
+  req = "POST /api?x=1 HTTP/1.1\r\nHost: localhost\r\nContent-Length: 4\r\n\r\nbody";
+  RequestParser parser;
+  ASSERT_EQ(parser.Parse(req), RequestParser::COMPLETE);
+  std::unique_ptr<Request> detached;
+  {
+    Request framed(req, parser.layout());
+    detached = std::make_unique<Request>(framed.Detach());
+  }
+  // The session's buffer is reused once the request has been detached
+  req.assign(req.size(), 'x');
+
+  ASSERT_TRUE(detached->is_valid());
+  EXPECT_EQ(detached->get_method(), "POST");
+  EXPECT_EQ(detached->get_url(), "/api?x=1");
+  EXPECT_EQ(detached->get_version(), "HTTP/1.1");
+  EXPECT_EQ(detached->get_header("Host"), "localhost");
+  EXPECT_EQ(detached->get_body(), "body");
+  EXPECT_EQ(detached->to_string().substr(0, 4), "POST");
+}
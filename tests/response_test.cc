@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include "response.h"
+#include "temp_dir.h"
 #include <stdexcept>
 
 // Basic HTTP 200 OK response
@@ -64,4 +65,88 @@ TEST(ResponseTest, Correct400Response) {
     EXPECT_EQ(res.to_string(), expected);
     EXPECT_EQ(res.get_status_code(), 400);
     EXPECT_EQ(res.get_handler_type(), "N/A");
-}
\ No newline at end of file
+}
+
+// Session overrides the Connection header chosen by the handler
+TEST(ResponseTest, SetConnection) {
+    Response res("HTTP/1.1", 200, "text/plain", 2, "close", "OK");
+    res.set_connection("keep-alive");
+
+    std::string expected =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/plain\r\n"
+        "Content-Length: 2\r\n"
+        "Connection: keep-alive\r\n\r\n"
+        "OK";
+
+    EXPECT_EQ(res.get_connection(), "keep-alive");
+    EXPECT_EQ(res.to_string(), expected);
+}
+
+// A file body replaces the string body and sets Content-Length
+TEST(ResponseTest, FileBody) {
+    TempDir dir;
+    dir.Write("body.txt", "file contents");
+    Response res("HTTP/1.1", 200, "text/plain", 0, "close", "", "StaticHandler");
+    res.set_file_body(FileBody::Open((dir.path() / "body.txt").string()));
+
+    std::string headers =
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/plain\r\n"
+        "Content-Length: 13\r\n"
+        "Connection: close\r\n\r\n";
+    ASSERT_NE(res.get_file_body(), nullptr);
+    EXPECT_EQ(res.header_string(), headers);
+    EXPECT_EQ(res.to_string(), headers + "file contents");
+}
+
+// Added headers go after Content-Length; a 304 has neither body nor length
+TEST(ResponseTest, ExtraHeadersAndNotModified) {
+    Response ok("HTTP/1.1", 200, "text/plain", 2, "close", "hi");
+    ok.add_header("ETag", "\"abc\"");
+    EXPECT_EQ(ok.get_header("ETag"), "\"abc\"");
+    EXPECT_EQ(ok.get_header("Missing"), "");
+    EXPECT_EQ(ok.to_string(),
+        "HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/plain\r\n"
+        "Content-Length: 2\r\n"
+        "ETag: \"abc\"\r\n"
+        "Connection: close\r\n\r\n"
+        "hi");
+
+    Response not_modified("HTTP/1.1", 304, "text/plain", 2, "keep-alive", "hi");
+    not_modified.add_header("ETag", "\"abc\"");
+    EXPECT_EQ(not_modified.to_string(),
+        "HTTP/1.1 304 Not Modified\r\n"
+        "ETag: \"abc\"\r\n"
+        "Connection: keep-alive\r\n\r\n");
+}
+
+// A bodiless response with no content type, like a redirect, has no empty
+// Content-Type line
+TEST(ResponseTest, EmptyContentTypeOmitted) {
+    Response redirect("HTTP/1.1", 301, "", 0, "close", "");
+    redirect.add_header("Location", "/docs/");
+    EXPECT_EQ(redirect.to_string(),
+        "HTTP/1.1 301 Moved Permanently\r\n"
+        "Content-Length: 0\r\n"
+        "Location: /docs/\r\n"
+        "Connection: close\r\n\r\n");
+}
+
+// The append forms add to what the buffer already holds, so a session can
+// serialize into reused storage
+TEST(ResponseTest, AppendToReusedBuffer) {
+    Response response("HTTP/1.1", 200, "text/plain", 2, "close", "hi");
+    response.add_header("ETag", "\"abc\"");
+    std::string buffer;
+    response.append_to(buffer);
+    EXPECT_EQ(buffer, response.to_string());
+
+    std::string head = "x";
+    response.append_header_string(head);
+    EXPECT_EQ(head, "x" + response.header_string());
+    std::string tail = "y";
+    response.append_header_tail(tail);
+    EXPECT_EQ(tail, "yETag: \"abc\"\r\nConnection: close\r\n\r\n");
+}
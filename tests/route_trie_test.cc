@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "route_trie.h"
+
+// ----------  RouteTrieTest Fixture  ---------------
+class RouteTrieTest : public ::testing::Test {
+  protected:
+    // Value of the route matching url, or -1 if none does
+    long Lookup(const std::string& url) {
+      std::size_t value = 0;
+      return trie.Match(url, value) ? static_cast<long>(value) : -1;
+    }
+
+    RouteTrie trie;
+};
+
+// ----------------- RouteTrie unit tests -----------------
+TEST_F(RouteTrieTest, EmptyTrieMatchesNothing) {
+  EXPECT_EQ(Lookup("/"), -1);
+  EXPECT_EQ(Lookup("/foo"), -1);
+}
+
+TEST_F(RouteTrieTest, RootMatchesEverything) {
+  ASSERT_TRUE(trie.Insert("/", 7));
+  EXPECT_EQ(Lookup("/"), 7);
+  EXPECT_EQ(Lookup(""), 7);
+  EXPECT_EQ(Lookup("/anything/at/all"), 7);
+}
+
+TEST_F(RouteTrieTest, MatchesOnSegmentBoundary) {
+  ASSERT_TRUE(trie.Insert("/foo", 1));
+  EXPECT_EQ(Lookup("/foo"), 1);
+  EXPECT_EQ(Lookup("/foo/"), 1);
+  EXPECT_EQ(Lookup("/foo/bar"), 1);
+  EXPECT_EQ(Lookup("/foo?x=1"), 1);
+  EXPECT_EQ(Lookup("/foobar"), -1);
+  EXPECT_EQ(Lookup("/fo"), -1);
+}
+
+TEST_F(RouteTrieTest, LongestPrefixWins) {
+  ASSERT_TRUE(trie.Insert("/", 0));
+  ASSERT_TRUE(trie.Insert("/api", 1));
+  ASSERT_TRUE(trie.Insert("/api/v1", 2));
+  EXPECT_EQ(Lookup("/api/v1/users"), 2);
+  EXPECT_EQ(Lookup("/api/v2/users"), 1);
+  EXPECT_EQ(Lookup("/api/v1x"), 1);
+  EXPECT_EQ(Lookup("/apix"), 0);
+}
+
+TEST_F(RouteTrieTest, SplitsSharedEdges) {
+  // Inserting in this order splits "static" into "stat" + "ic" / "us"
+  ASSERT_TRUE(trie.Insert("/static", 1));
+  ASSERT_TRUE(trie.Insert("/status", 2));
+  ASSERT_TRUE(trie.Insert("/stat", 3));
+  EXPECT_EQ(Lookup("/static/a.png"), 1);
+  EXPECT_EQ(Lookup("/status"), 2);
+  EXPECT_EQ(Lookup("/stat/x"), 3);
+  EXPECT_EQ(Lookup("/stats"), -1);
+}
+
+TEST_F(RouteTrieTest, DuplicateKeepsFirstValue) {
+  ASSERT_TRUE(trie.Insert("/foo", 1));
+  EXPECT_FALSE(trie.Insert("/foo", 2));
+  EXPECT_EQ(Lookup("/foo"), 1);
+}
+
+TEST_F(RouteTrieTest, MissingLeadingSlashImplied) {
+  ASSERT_TRUE(trie.Insert("/foo", 1));
+  EXPECT_EQ(Lookup("foo/bar"), 1);
+}
+
+TEST_F(RouteTrieTest, ManyRoutes) {
+  for (std::size_t i = 0; i < 500; ++i) {
+    ASSERT_TRUE(trie.Insert("/svc" + std::to_string(i) + "/api", i));
+  }
+  for (std::size_t i = 0; i < 500; ++i) {
+    EXPECT_EQ(Lookup("/svc" + std::to_string(i) + "/api/items/3"), static_cast<long>(i));
+  }
+  EXPECT_EQ(Lookup("/svc1/ap"), -1);
+}
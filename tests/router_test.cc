@@ -1,11 +1,15 @@
 #include <gtest/gtest.h>
 #include <fstream>
+#include <atomic>
+#include <thread>
 
 #include "router.h"
 #include "handler_registry.h"
 #include "echo_handler.h"
 #include "static_handler.h"
+#include "markdown_handler.h"
 #include "not_found_handler.h"
+#include "sleep_handler.h"
 #include "request.h"
 #include "response.h"
 
@@ -180,6 +184,82 @@ TEST(RouterLifetimeTest, HandlersArePerRequest) {
   EXPECT_EQ(g_live_count, 0);
 }
 
+// -----------------------------------------------------------------------------
+// Lifetime test: SharedHandlerBuiltOnce
+//
+// A SHARED route builds its handler when the route is added, reuses it for
+// every request and releases it with the router.
+// -----------------------------------------------------------------------------
+TEST(RouterLifetimeTest, SharedHandlerBuiltOnce) {
+  int built = 0;
+  Router::Factory factory = [&built](const std::string&,
+                                     const std::unordered_map<std::string,std::string>&) {
+    ++built;
+    return new TrackingHandler();
+  };
+  Request req("GET / HTTP/1.1\r\nHost: x\r\n\r\n");
+  {
+    Router r;
+    r.add_route("/", factory, {}, HandlerRegistry::SHARED);
+    EXPECT_EQ(built, 1);
+    EXPECT_EQ(g_live_count, 1);
+
+    r.handle_request(req);
+    r.handle_request(req);
+    EXPECT_EQ(built, 1);
+  }
+  EXPECT_EQ(g_live_count, 0);
+}
+
+// -----------------------------------------------------------------------------
+// Lifetime test: PerThreadHandlerBuiltOncePerThread
+//
+// A PER_THREAD route builds one handler on the first request of each thread
+// and reuses it for that thread's later requests.
+// -----------------------------------------------------------------------------
+// Untracked, a thread's cached instance may outlive the router briefly
+struct OkHandler : RequestHandler {
+  Response handle_request(const Request& req) override {
+    return Response(req.get_version(), 200, "text/plain", 0, "close", "");
+  }
+};
+
+TEST(RouterLifetimeTest, PerThreadHandlerBuiltOncePerThread) {
+  std::atomic<int> built{0};
+  Router r;
+  r.add_route("/",
+              [&built](const std::string&,
+                       const std::unordered_map<std::string,std::string>&) {
+                ++built;
+                return new OkHandler();
+              },
+              {}, HandlerRegistry::PER_THREAD);
+  Request req("GET / HTTP/1.1\r\nHost: x\r\n\r\n");
+  EXPECT_EQ(built, 0);
+
+  r.handle_request(req);
+  r.handle_request(req);
+  EXPECT_EQ(built, 1);
+
+  std::thread other([&] {
+    r.handle_request(req);
+    r.handle_request(req);
+  });
+  other.join();
+  EXPECT_EQ(built, 2);
+}
+
+// -----------------------------------------------------------------------------
+// Test: SharedHandlerFactoryErrorAtStartup
+//
+// A misconfigured SHARED handler fails in add_route instead of on a request.
+// -----------------------------------------------------------------------------
+TEST_F(RouterTest, SharedHandlerFactoryErrorAtStartup) {
+  EXPECT_THROW(router_->add_route("/static", make_factory(StaticHandler::kName), {},
+                                  HandlerRegistry::SHARED),
+               std::runtime_error);
+}
+
 // -----------------------------------------------------------------------------
 // Test: LongestPrefixMatching
 //
@@ -228,4 +308,144 @@ TEST_F(RouterTest, LongestPrefixMatching) {
     auto     body = resp.to_string().substr(resp.to_string().find("\r\n\r\n") + 4);
     EXPECT_EQ(body, "/");
   }
-}
\ No newline at end of file
+}
+// -----------------------------------------------------------------------------
+// Test: PrefixMatchesWholeSegments
+//
+// "/foo" must not capture "/foobar"; that request falls back to "/".
+// -----------------------------------------------------------------------------
+TEST_F(RouterTest, PrefixMatchesWholeSegments) {
+  router_->add_route("/", make_factory(NotFoundHandler::kName), {});
+  router_->add_route("/echo", make_factory(EchoHandler::kName), {});
+
+  EXPECT_EQ(router_->handle_request(Request("GET /echo HTTP/1.1\r\n\r\n")).get_status_code(), 200);
+  EXPECT_EQ(router_->handle_request(Request("GET /echo/x HTTP/1.1\r\n\r\n")).get_status_code(), 200);
+  EXPECT_EQ(router_->handle_request(Request("GET /echoes HTTP/1.1\r\n\r\n")).get_status_code(), 404);
+}
+
+// -----------------------------------------------------------------------------
+// Test: CompressionFilterPerLocation
+//
+// compress_level in a location's params compresses that route's responses
+// only, and a bad value fails in add_route.
+// -----------------------------------------------------------------------------
+TEST_F(RouterTest, CompressionFilterPerLocation) {
+  router_->add_route("/echo", make_factory(EchoHandler::kName),
+                     {{"compress_level", "6"}, {"compress_min_length", "16"}});
+  router_->add_route("/plain", make_factory(EchoHandler::kName), {});
+
+  std::string headers = "Accept-Encoding: gzip\r\nX-Padding: " + std::string(200, 'a') + "\r\n\r\n";
+  Response echo = router_->handle_request(Request("GET /echo HTTP/1.1\r\n" + headers));
+  EXPECT_EQ(echo.get_header("Content-Encoding"), "gzip");
+  EXPECT_EQ(echo.get_header("Vary"), "Accept-Encoding");
+  ASSERT_NE(echo.get_shared_body(), nullptr);
+  EXPECT_LT(echo.get_shared_body()->size(), 200u);
+
+  Response plain = router_->handle_request(Request("GET /plain HTTP/1.1\r\n" + headers));
+  EXPECT_EQ(plain.get_header("Content-Encoding"), "");
+
+  EXPECT_THROW(router_->add_route("/bad", make_factory(EchoHandler::kName),
+                                  {{"compress_level", "high"}}),
+               std::runtime_error);
+}
+
+// -----------------------------------------------------------------------------
+// Test: CompressedConditionalGet
+//
+// Revalidating a page on a compressing route gets a 304 with the ETag and
+// Vary the compressed 200 was sent with.
+// -----------------------------------------------------------------------------
+TEST_F(RouterTest, CompressedConditionalGet) {
+  create_test_file("page.md", "# Title\n\n" + std::string(400, 'a') + "\n");
+  router_->add_route("/md", make_factory(MarkdownHandler::kName),
+                     {{"root", temp_dir_.string()}, {"compress_level", "6"}});
+
+  Response ok = router_->handle_request(
+      Request("GET /md/page.md HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n"));
+  ASSERT_EQ(ok.get_status_code(), 200);
+  EXPECT_EQ(ok.get_header("Content-Encoding"), "gzip");
+  std::string etag = ok.get_header("ETag");
+  ASSERT_EQ(etag.substr(0, 3), "W/\"");
+
+  Response not_modified = router_->handle_request(
+      Request("GET /md/page.md HTTP/1.1\r\nAccept-Encoding: gzip\r\nIf-None-Match: " +
+              etag + "\r\n\r\n"));
+  ASSERT_EQ(not_modified.get_status_code(), 304);
+  EXPECT_EQ(not_modified.get_header("ETag"), etag);
+  EXPECT_EQ(not_modified.get_header("Vary"), "Accept-Encoding");
+  std::string head = not_modified.to_string();
+  EXPECT_NE(head.find("ETag: " + etag + "\r\n"), std::string::npos);
+  EXPECT_NE(head.find("Vary: Accept-Encoding\r\n"), std::string::npos);
+  EXPECT_EQ(head.find("Content-Type"), std::string::npos);
+}
+
+// -----------------------------------------------------------------------------
+// Test: BlockingRoutes
+//
+// Routes take the blocking declared for their handler unless the location
+// overrides it.
+// -----------------------------------------------------------------------------
+TEST_F(RouterTest, BlockingRoutes) {
+  router_->add_route("/slow", make_factory(EchoHandler::kName), {},
+                     HandlerRegistry::SHARED, HandlerRegistry::BLOCKING);
+  router_->add_route("/fast", make_factory(EchoHandler::kName), {{"blocking", "off"}},
+                     HandlerRegistry::SHARED, HandlerRegistry::BLOCKING);
+  router_->add_route("/forced", make_factory(EchoHandler::kName), {{"blocking", "on"}});
+  router_->add_route("/", make_factory(EchoHandler::kName), {});
+
+  router_->add_route("/timer", make_factory(SleepHandler::kName), {{"blocking", "off"}},
+                     HandlerRegistry::SHARED, HandlerRegistry::ASYNC);
+
+  EXPECT_EQ(router_->blocking(Request("GET /slow/x HTTP/1.1\r\n\r\n")),
+            HandlerRegistry::BLOCKING);
+  EXPECT_EQ(router_->blocking(Request("GET /fast HTTP/1.1\r\n\r\n")),
+            HandlerRegistry::NON_BLOCKING);
+  EXPECT_EQ(router_->blocking(Request("GET /forced HTTP/1.1\r\n\r\n")),
+            HandlerRegistry::BLOCKING);
+  EXPECT_EQ(router_->blocking(Request("GET /other HTTP/1.1\r\n\r\n")),
+            HandlerRegistry::NON_BLOCKING);
+  EXPECT_EQ(router_->blocking(Request("GET /timer HTTP/1.1\r\n\r\n")),
+            HandlerRegistry::ASYNC);
+
+  EXPECT_THROW(router_->add_route("/bad", make_factory(EchoHandler::kName),
+                                  {{"blocking", "maybe"}}),
+               std::runtime_error);
+}
+
+// -----------------------------------------------------------------------------
+// Test: AsyncRoutes
+//
+// Async handlers answer from the io_service and synchronous ones straight
+// away.
+// -----------------------------------------------------------------------------
+TEST_F(RouterTest, AsyncRoutes) {
+  router_->add_route("/sleep", make_factory(SleepHandler::kName),
+                     {{"sleep_duration", "0"}}, HandlerRegistry::SHARED, HandlerRegistry::ASYNC);
+  router_->add_route("/", make_factory(EchoHandler::kName), {});
+
+  boost::asio::io_service io;
+  std::string headers = "Host: x\r\n\r\n";
+  Request sleep("GET /sleep HTTP/1.1\r\n" + headers);
+  std::unique_ptr<Response> slept;
+  router_->async_handle_request(sleep, io, [&slept](Response r) {
+    slept = std::make_unique<Response>(std::move(r));
+  });
+  EXPECT_EQ(slept, nullptr) << "answered before the timer expired";
+  io.run();
+  ASSERT_NE(slept, nullptr);
+  EXPECT_EQ(slept->get_status_code(), 200);
+  EXPECT_EQ(slept->get_handler_type(), SleepHandler::kName);
+
+  Request echo("GET /echo HTTP/1.1\r\n" + headers);
+  std::unique_ptr<Response> echoed;
+  router_->async_handle_request(echo, io, [&echoed](Response r) {
+    echoed = std::make_unique<Response>(std::move(r));
+  });
+  ASSERT_NE(echoed, nullptr);
+  EXPECT_EQ(echoed->get_handler_type(), EchoHandler::kName);
+
+  // Only AsyncRequestHandlers can be declared async
+  EXPECT_THROW(router_->add_route("/bad", make_factory(EchoHandler::kName), {},
+                                  HandlerRegistry::SHARED, HandlerRegistry::ASYNC),
+               std::runtime_error);
+}
@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include <boost/asio.hpp>
+#include <atomic>
 #include <thread>
 #include <fstream>
 #include <gmock/gmock.h>
@@ -85,3 +86,43 @@ TEST_F(ServerTest, ServerPortInUse) {
   EXPECT_THROW(server s(io_service, port, router, MockSession::MakeMockSession), boost::system::system_error);
   occupied_acceptor.close();
 }
+
+TEST_F(ServerTest, ReusePortSharesPort) {
+  port = GetOpenPort(io_service);
+  Router router;
+
+  // Two servers on their own io_services bound to the same port, counting
+  // the sessions each one builds (one is always waiting for the next
+  // connection)
+  boost::asio::io_service other_io_service;
+  std::atomic<int> built[2] = {{0}, {0}};
+  auto counting = [&built](int i) {
+    return [&built, i](boost::asio::io_service& io, Router& r) {
+      ++built[i];
+      return session::MakeSession(io, r);
+    };
+  };
+  server first(io_service, port, router, counting(0), true);
+  server second(other_io_service, port, router, counting(1), true);
+  std::thread first_thread([this] { io_service.run(); });
+  std::thread second_thread([&other_io_service] { other_io_service.run(); });
+
+  const int connections = 32;
+  boost::asio::io_service client_io;
+  std::vector<tcp::socket> clients;
+  for (int i = 0; i < connections; ++i) {
+    clients.emplace_back(client_io);
+    clients.back().connect(tcp::endpoint(boost::asio::ip::address_v4::loopback(), port));
+  }
+  for (int i = 0; i < 200 && built[0] + built[1] - 2 < connections; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(built[0] + built[1] - 2, connections);
+  EXPECT_GT(built[0], 1) << "the kernel sent no connection to the first server";
+  EXPECT_GT(built[1], 1) << "the kernel sent no connection to the second server";
+
+  io_service.stop();
+  other_io_service.stop();
+  first_thread.join();
+  second_thread.join();
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+#include <boost/asio.hpp>
+#include "router.h"
+#include "session_pool.h"
+
+// ----------  SessionPoolTest Fixture  ---------------
+class SessionPoolTest : public ::testing::Test {
+  protected:
+    boost::asio::io_service io_service_;
+    Router router_;
+    SessionOptions options_;
+};
+
+TEST_F(SessionPoolTest, ReusesReleasedSessions) {
+  SessionPool& pool = SessionPool::Of(io_service_);
+  EXPECT_EQ(&pool, &SessionPool::Of(io_service_));
+
+  std::shared_ptr<session> first = pool.Acquire(router_, options_);
+  session* raw = first.get();
+  first.reset();
+  EXPECT_EQ(pool.GetStats().idle, 1u);
+
+  std::shared_ptr<session> second = pool.Acquire(router_, options_);
+  EXPECT_EQ(second.get(), raw);
+  EXPECT_FALSE(second->socket().is_open());
+  SessionPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(stats.created, 1u);
+  EXPECT_EQ(stats.reused, 1u);
+  EXPECT_EQ(stats.idle, 0u);
+}
+
+TEST_F(SessionPoolTest, KeepsAtMostLimit) {
+  options_.session_pool = 2;
+  SessionPool& pool = SessionPool::Of(io_service_);
+  std::vector<std::shared_ptr<session>> sessions;
+  for (int i = 0; i < 5; ++i) sessions.push_back(pool.Acquire(router_, options_));
+  sessions.clear();
+  EXPECT_EQ(pool.GetStats().idle, 2u);
+}
+
+TEST_F(SessionPoolTest, SessionsStayWithTheirRouter) {
+  SessionPool& pool = SessionPool::Of(io_service_);
+  Router other;
+  pool.Acquire(router_, options_).reset();
+
+  std::shared_ptr<session> s = pool.Acquire(other, options_);
+  SessionPool::Stats stats = pool.GetStats();
+  EXPECT_EQ(stats.created, 2u);
+  EXPECT_EQ(stats.reused, 0u);
+  EXPECT_EQ(stats.idle, 1u);
+}
+
+TEST_F(SessionPoolTest, FactoryWithoutPool) {
+  options_.session_pool = 0;
+  session::MakeSessionFactory(options_)(io_service_, router_).reset();
+  EXPECT_EQ(SessionPool::Of(io_service_).GetStats().created, 0u);
+
+  options_.session_pool = 8;
+  session::MakeSessionFactory(options_)(io_service_, router_).reset();
+  EXPECT_EQ(SessionPool::Of(io_service_).GetStats().created, 1u);
+  EXPECT_EQ(SessionPool::Of(io_service_).GetStats().idle, 1u);
+}
+
+// Sessions released while the io_service is being destroyed aren't pooled
+TEST_F(SessionPoolTest, ReleasedDuringShutdown) {
+  auto io_service = std::make_unique<boost::asio::io_service>();
+  std::shared_ptr<session> s = SessionPool::Of(*io_service).Acquire(router_, options_);
+  SessionPool::Of(*io_service).Acquire(router_, options_).reset();
+  // Held only by a handler that never runs
+  boost::asio::post(*io_service, [s]() {});
+  s.reset();
+  io_service.reset();
+}
@@ -5,9 +5,12 @@
 
 #include "server.h"
 #include "session.h"
+#include "async_file_io.h"
 #include "router.h"
 #include "echo_handler.h"
 #include "static_handler.h"
+#include "session_pool.h"
+#include "sleep_handler.h"
 
 using boost::asio::ip::tcp;
 namespace fs = std::filesystem;
@@ -54,10 +57,62 @@ protected:
       {{"root", temp_dir_.string()}}
     );
 
+    // Static with an in-memory cache on "/cached_test"
+    router_->add_route(
+      "/cached_test",
+      [](const std::string& loc,
+         const std::unordered_map<std::string,std::string>& p) {
+        return HandlerRegistry::CreateHandler(StaticHandler::kName, loc, p);
+      },
+      {{"root", temp_dir_.string()}, {"cache_size_mb", "1"}}
+    );
+
+    // Static serving from memory mappings on "/mapped_test"
+    router_->add_route(
+      "/mapped_test",
+      [](const std::string& loc,
+         const std::unordered_map<std::string,std::string>& p) {
+        return HandlerRegistry::CreateHandler(StaticHandler::kName, loc, p);
+      },
+      {{"root", temp_dir_.string()}, {"mmap", "on"}}
+    );
+
+    // One second sleep on "/sleep_test", run on the handler pool when the
+    // session has one
+    router_->add_route(
+      "/sleep_test",
+      [](const std::string& loc,
+         const std::unordered_map<std::string,std::string>& p) {
+        return HandlerRegistry::CreateHandler(SleepHandler::kName, loc, p);
+      },
+      {{"sleep_duration", "1"}, {"blocking", "on"}}
+    );
+
+    // The same sleep on "/async_sleep_test", waiting on an io_service timer
+    router_->add_route(
+      "/async_sleep_test",
+      [](const std::string& loc,
+         const std::unordered_map<std::string,std::string>& p) {
+        return HandlerRegistry::CreateHandler(SleepHandler::kName, loc, p);
+      },
+      {{"sleep_duration", "1"}},
+      HandlerRegistry::SHARED, HandlerRegistry::ASYNC
+    );
+
     // Create sample files
     create_test_file("test.txt", "this is a test");
     create_test_file("test.html", "<!doctype html><html><head><title>x</title></head><body></body></html>");
 
+    // Static preloaded at startup on "/preloaded_test", after the files exist
+    router_->add_route(
+      "/preloaded_test",
+      [](const std::string& loc,
+         const std::unordered_map<std::string,std::string>& p) {
+        return HandlerRegistry::CreateHandler(StaticHandler::kName, loc, p);
+      },
+      {{"root", temp_dir_.string()}, {"preload", "on"}}
+    );
+
     // Launch the server in a separate thread
     server_ = std::make_unique<server>(io_service_, port_, *router_, session::MakeSession);
     io_thread_ = std::thread([this]{ io_service_.run(); });
@@ -81,16 +136,80 @@ protected:
     return sock;
   }
 
-  // Read until EOF (server closes connection) and return response as string
+  // Read a single response: headers, then Content-Length bytes of body.
+  // Connections are kept alive by default, so EOF doesn't mark the end.
+  // Bytes of any following pipelined response are left in buf.
   std::string ReadResponse(tcp::socket& sock, boost::asio::streambuf& buf, boost::system::error_code& ec) {
-    boost::asio::read(sock, buf, ec);
-    return {buffers_begin(buf.data()), buffers_end(buf.data())};
+    std::size_t header_len = boost::asio::read_until(sock, buf, "\r\n\r\n", ec);
+    if (ec) return {buffers_begin(buf.data()), buffers_end(buf.data())};
+    std::string head(buffers_begin(buf.data()), buffers_begin(buf.data()) + header_len);
+    std::size_t content_length = 0;
+    auto cl_pos = head.find("Content-Length: ");
+    if (cl_pos != std::string::npos) content_length = std::stoul(head.substr(cl_pos + 16));
+    std::size_t total = header_len + content_length;
+    if (buf.size() < total) {
+      boost::asio::read(sock, buf, boost::asio::transfer_exactly(total - buf.size()), ec);
+    }
+    std::string resp(buffers_begin(buf.data()),
+                     buffers_begin(buf.data()) + std::min(total, buf.size()));
+    buf.consume(resp.size());
+    return resp;
+  }
+
+  // Serves options on a fresh port with io_service_ run on three threads
+  // besides io_thread_, while several clients each pipeline path between
+  // two echoed requests over and over, expecting every answer in order.
+  // Stops the io_service before returning.
+  void ExpectPipelinedAcrossThreads(const std::string& path, SessionOptions options) {
+    options.keepalive_requests = 1000;
+    tcp::acceptor probe(io_service_, {tcp::v4(), 0});
+    unsigned short pool_port = probe.local_endpoint().port();
+    probe.close();
+    limited_server_ = std::make_unique<server>(
+        io_service_, pool_port, *router_, session::MakeSessionFactory(options));
+
+    std::vector<std::thread> io_threads;
+    for (int i = 0; i < 3; ++i) io_threads.emplace_back([this]{ io_service_.run(); });
+
+    std::vector<std::thread> clients;
+    for (int c = 0; c < 4; ++c) {
+      clients.emplace_back([this, c, &path, pool_port] {
+        boost::asio::io_service client_io;
+        tcp::socket sock(client_io);
+        sock.connect({tcp::v4(), pool_port});
+        boost::asio::streambuf buf;
+        boost::system::error_code ec;
+        for (int round = 0; round < 50; ++round) {
+          std::string tag = std::to_string(c) + "_" + std::to_string(round);
+          std::string before = "GET /before_" + tag + " HTTP/1.1\r\n\r\n";
+          std::string after = "GET /after_" + tag + " HTTP/1.1\r\n\r\n";
+          boost::asio::write(sock, boost::asio::buffer(
+              before + "GET " + path + " HTTP/1.1\r\n\r\n" + after));
+          std::string r1 = ReadResponse(sock, buf, ec);
+          ASSERT_FALSE(ec);
+          EXPECT_EQ(r1.substr(r1.find("\r\n\r\n") + 4), before);
+          std::string r2 = ReadResponse(sock, buf, ec);
+          ASSERT_FALSE(ec);
+          EXPECT_NE(r2.find("Slept for 0 seconds"), std::string::npos);
+          std::string r3 = ReadResponse(sock, buf, ec);
+          ASSERT_FALSE(ec);
+          EXPECT_EQ(r3.substr(r3.find("\r\n\r\n") + 4), after);
+        }
+      });
+    }
+    for (auto& t : clients) t.join();
+
+    // Sessions must be gone before the caller's pool
+    io_service_.stop();
+    for (auto& t : io_threads) t.join();
+    if (io_thread_.joinable()) io_thread_.join();
   }
 
   boost::asio::io_service io_service_;
   tcp::acceptor acceptor_{io_service_};
   unsigned short port_;
   std::unique_ptr<server> server_;
+  std::unique_ptr<server> limited_server_;  // Extra server with custom session options
   std::thread io_thread_;
   std::shared_ptr<Router> router_;
   fs::path temp_dir_;
@@ -250,9 +369,7 @@ TEST_F(SessionTest, LargeChunkedWriteRequest) {
   }
 
   boost::asio::streambuf resp_buf; boost::system::error_code ec;
-  boost::asio::read(sock, resp_buf, ec);
-  std::string resp_str((std::istreambuf_iterator<char>(&resp_buf)),
-                        std::istreambuf_iterator<char>());
+  std::string resp_str = ReadResponse(sock, resp_buf, ec);
 
   // Check 200 OK
   EXPECT_NE(resp_str.find("HTTP/1.1 200 OK"), std::string::npos);
@@ -416,4 +533,660 @@ TEST_F(SessionTest, LargeBodyRequestLargerLength) {
   // Wait for 2 seconds (session times out with severity level warning after 5)
   io_service_.run_for(std::chrono::seconds(2));
   EXPECT_FALSE(got_response);
-}
\ No newline at end of file
+}
+
+// -----------------------------------------------------------------------------
+// KeepAliveReusesConnection
+//
+// HTTP/1.1 requests keep the connection open and can be sent back to back.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, KeepAliveReusesConnection) {
+  tcp::socket sock = SendRequest("GET /static_test/test.txt HTTP/1.1\r\n\r\n");
+  boost::asio::streambuf buf; boost::system::error_code ec;
+  std::string first = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_NE(first.find("Connection: keep-alive\r\n"), std::string::npos);
+  EXPECT_EQ(first.substr(first.find("\r\n\r\n") + 4), "this is a test");
+
+  boost::asio::write(sock, boost::asio::buffer(std::string("GET /static_test/test.txt HTTP/1.1\r\n\r\n")));
+  boost::asio::streambuf buf2;
+  std::string second = ReadResponse(sock, buf2, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_EQ(second, first);
+}
+
+// -----------------------------------------------------------------------------
+// ConnectionCloseHonored & Http10DefaultsToClose
+//
+// The server closes after responding when asked to, or for HTTP/1.0 without
+// an explicit keep-alive.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, ConnectionCloseHonored) {
+  tcp::socket sock = SendRequest("GET /static_test/test.txt HTTP/1.1\r\nConnection: close\r\n\r\n");
+  boost::asio::streambuf buf; boost::system::error_code ec;
+  boost::asio::read(sock, buf, ec);
+  EXPECT_EQ(ec, boost::asio::error::eof);
+  std::string resp(buffers_begin(buf.data()), buffers_end(buf.data()));
+  EXPECT_NE(resp.find("Connection: close\r\n"), std::string::npos);
+}
+
+TEST_F(SessionTest, Http10DefaultsToClose) {
+  tcp::socket sock = SendRequest("GET /static_test/test.txt HTTP/1.0\r\n\r\n");
+  boost::asio::streambuf buf; boost::system::error_code ec;
+  boost::asio::read(sock, buf, ec);
+  EXPECT_EQ(ec, boost::asio::error::eof);
+  std::string resp(buffers_begin(buf.data()), buffers_end(buf.data()));
+  EXPECT_NE(resp.find("Connection: close\r\n"), std::string::npos);
+}
+
+TEST_F(SessionTest, Http10KeepAlive) {
+  tcp::socket sock = SendRequest("GET /static_test/test.txt HTTP/1.0\r\nConnection: keep-alive\r\n\r\n");
+  boost::asio::streambuf buf; boost::system::error_code ec;
+  std::string resp = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_NE(resp.find("Connection: keep-alive\r\n"), std::string::npos);
+}
+
+// -----------------------------------------------------------------------------
+// MaxRequestsClosesConnection
+//
+// Once keepalive_requests responses have been sent the connection is closed.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, MaxRequestsClosesConnection) {
+  tcp::acceptor probe(io_service_, {tcp::v4(), 0});
+  unsigned short limited_port = probe.local_endpoint().port();
+  probe.close();
+
+  SessionOptions options;
+  options.keepalive_requests = 2;
+  limited_server_ = std::make_unique<server>(
+      io_service_, limited_port, *router_, session::MakeSessionFactory(options));
+
+  tcp::socket sock(io_service_);
+  sock.connect({tcp::v4(), limited_port});
+  const std::string req = "GET /static_test/test.txt HTTP/1.1\r\n\r\n";
+
+  boost::asio::write(sock, boost::asio::buffer(req));
+  boost::asio::streambuf buf; boost::system::error_code ec;
+  std::string first = ReadResponse(sock, buf, ec);
+  EXPECT_NE(first.find("Connection: keep-alive\r\n"), std::string::npos);
+
+  boost::asio::write(sock, boost::asio::buffer(req));
+  boost::asio::streambuf buf2;
+  boost::asio::read(sock, buf2, ec);
+  EXPECT_EQ(ec, boost::asio::error::eof);
+  std::string second(buffers_begin(buf2.data()), buffers_end(buf2.data()));
+  EXPECT_NE(second.find("Connection: close\r\n"), std::string::npos);
+}
+
+// -----------------------------------------------------------------------------
+// PipelinedRequests
+//
+// Several requests sent in one write are all answered, in request order.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, PipelinedRequests) {
+  std::string first = "GET /first HTTP/1.1\r\n\r\n";
+  std::string second = "GET /static_test/test.txt HTTP/1.1\r\n\r\n";
+  std::string third = "GET /third HTTP/1.1\r\nContent-Length: 4\r\n\r\nbody";
+  tcp::socket sock = SendRequest(first + second + third);
+
+  boost::asio::streambuf buf; boost::system::error_code ec;
+  std::string r1 = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_EQ(r1.substr(r1.find("\r\n\r\n") + 4), first);
+
+  std::string r2 = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_EQ(r2.substr(r2.find("\r\n\r\n") + 4), "this is a test");
+
+  std::string r3 = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_EQ(r3.substr(r3.find("\r\n\r\n") + 4), third);
+}
+
+// -----------------------------------------------------------------------------
+// LargeStaticFileStreamed
+//
+// A file much larger than the socket buffers is streamed in full, and a
+// response pipelined behind it follows only after its last byte.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, LargeStaticFileStreamed) {
+  std::string content;
+  for (int i = 0; content.size() < 4 * 1024 * 1024; ++i) content += std::to_string(i) + "\n";
+  create_test_file("large.txt", content);
+
+  std::string echo = "GET /after HTTP/1.1\r\n\r\n";
+  tcp::socket sock = SendRequest("GET /static_test/large.txt HTTP/1.1\r\n\r\n" + echo);
+
+  boost::asio::streambuf buf; boost::system::error_code ec;
+  std::string r1 = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_NE(r1.find("Content-Length: " + std::to_string(content.size()) + "\r\n"), std::string::npos);
+  EXPECT_TRUE(r1.substr(r1.find("\r\n\r\n") + 4) == content);
+
+  std::string r2 = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_EQ(r2.substr(r2.find("\r\n\r\n") + 4), echo);
+}
+
+// -----------------------------------------------------------------------------
+// MultipartRangesStreamed
+//
+// A multipart/byteranges body interleaves part headers with slices of the
+// file, and a pipelined response still follows it intact.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, MultipartRangesStreamed) {
+  std::string content;
+  for (int i = 0; content.size() < 1024 * 1024; ++i) content += std::to_string(i) + "\n";
+  create_test_file("ranges.txt", content);
+
+  std::string echo = "GET /after HTTP/1.1\r\n\r\n";
+  tcp::socket sock = SendRequest(
+      "GET /static_test/ranges.txt HTTP/1.1\r\nRange: bytes=10-19,-300000\r\n\r\n" + echo);
+
+  boost::asio::streambuf buf; boost::system::error_code ec;
+  std::string r1 = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  ASSERT_NE(r1.find("HTTP/1.1 206 Partial Content"), std::string::npos);
+  std::string body = r1.substr(r1.find("\r\n\r\n") + 4);
+  EXPECT_NE(body.find("Content-Range: bytes 10-19/" + std::to_string(content.size()) +
+                      "\r\n\r\n" + content.substr(10, 10) + "\r\n"),
+            std::string::npos);
+  EXPECT_NE(body.find("\r\n\r\n" + content.substr(content.size() - 300000) + "\r\n--"),
+            std::string::npos);
+  EXPECT_EQ(body.substr(body.size() - 4), "--\r\n");
+
+  std::string r2 = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_EQ(r2.substr(r2.find("\r\n\r\n") + 4), echo);
+}
+
+// -----------------------------------------------------------------------------
+// MappedRangesGathered
+//
+// Mapped files, whole or as multipart ranges, go out in the same gathered
+// write as their headers and the pipelined responses around them.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, MappedRangesGathered) {
+  std::string content;
+  for (int i = 0; content.size() < 1024 * 1024; ++i) content += std::to_string(i) + "\n";
+  create_test_file("mapped.txt", content);
+
+  std::string echo = "GET /after HTTP/1.1\r\n\r\n";
+  tcp::socket sock = SendRequest(
+      "GET /mapped_test/mapped.txt HTTP/1.1\r\n\r\n"
+      "GET /mapped_test/mapped.txt HTTP/1.1\r\nRange: bytes=10-19,-300000\r\n\r\n" + echo);
+
+  boost::asio::streambuf buf; boost::system::error_code ec;
+  std::string whole = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_EQ(whole.substr(whole.find("\r\n\r\n") + 4), content);
+
+  std::string ranged = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  ASSERT_NE(ranged.find("HTTP/1.1 206 Partial Content"), std::string::npos);
+  std::string body = ranged.substr(ranged.find("\r\n\r\n") + 4);
+  EXPECT_NE(body.find("\r\n\r\n" + content.substr(10, 10) + "\r\n"), std::string::npos);
+  EXPECT_NE(body.find("\r\n\r\n" + content.substr(content.size() - 300000) + "\r\n--"),
+            std::string::npos);
+
+  std::string r3 = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_EQ(r3.substr(r3.find("\r\n\r\n") + 4), echo);
+}
+
+// -----------------------------------------------------------------------------
+// PreloadedGathered
+//
+// Prebuilt heads and bodies of a preloaded root go out in one gathered
+// write with the pipelined responses around them, with the session's own
+// Connection header after the prebuilt ones. A range gets headers of its
+// own ahead of the arena bytes.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, PreloadedGathered) {
+  std::string echo = "GET /after HTTP/1.1\r\n\r\n";
+  tcp::socket sock = SendRequest(
+      "GET /preloaded_test/test.txt HTTP/1.1\r\n\r\n"
+      "GET /preloaded_test/test.html?v=2 HTTP/1.1\r\n\r\n"
+      "GET /preloaded_test/test.txt HTTP/1.1\r\nRange: bytes=5-6\r\n\r\n" + echo);
+
+  boost::asio::streambuf buf; boost::system::error_code ec;
+  std::string r1 = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_EQ(r1.rfind("HTTP/1.1 200 OK\r\nContent-Type: text/plain; charset=utf-8\r\n", 0), 0u);
+  EXPECT_NE(r1.find("Accept-Ranges: bytes\r\nConnection: keep-alive\r\n\r\nthis is a test"),
+            std::string::npos);
+
+  std::string r2 = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_NE(r2.find("Content-Type: text/html; charset=utf-8\r\n"), std::string::npos);
+  EXPECT_EQ(r2.substr(r2.find("\r\n\r\n") + 4),
+            "<!doctype html><html><head><title>x</title></head><body></body></html>");
+
+  std::string range = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_EQ(range.rfind("HTTP/1.1 206 Partial Content\r\n", 0), 0u);
+  EXPECT_NE(range.find("Content-Range: bytes 5-6/14\r\n"), std::string::npos);
+  EXPECT_EQ(range.substr(range.find("\r\n\r\n") + 4), "is");
+
+  std::string r3 = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_EQ(r3.substr(r3.find("\r\n\r\n") + 4), echo);
+}
+
+// -----------------------------------------------------------------------------
+// BlockingHandlerOffloaded
+//
+// A blocking handler runs on the handler pool: other connections on the
+// single io_service thread are served meanwhile, and requests pipelined
+// behind it are answered after it, in order.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, BlockingHandlerOffloaded) {
+  tcp::acceptor probe(io_service_, {tcp::v4(), 0});
+  unsigned short pool_port = probe.local_endpoint().port();
+  probe.close();
+
+  boost::asio::thread_pool pool(2);
+  SessionOptions options;
+  options.handler_pool = &pool;
+  limited_server_ = std::make_unique<server>(
+      io_service_, pool_port, *router_, session::MakeSessionFactory(options));
+
+  auto start = std::chrono::steady_clock::now();
+  tcp::socket slow(io_service_);
+  slow.connect({tcp::v4(), pool_port});
+  std::string before = "GET /before HTTP/1.1\r\n\r\n";
+  std::string after = "GET /after HTTP/1.1\r\n\r\n";
+  boost::asio::write(slow, boost::asio::buffer(before + "GET /sleep_test HTTP/1.1\r\n\r\n" + after));
+
+  tcp::socket quick(io_service_);
+  quick.connect({tcp::v4(), pool_port});
+  boost::asio::write(quick, boost::asio::buffer(std::string("GET /quick HTTP/1.1\r\n\r\n")));
+  boost::asio::streambuf quick_buf; boost::system::error_code ec;
+  std::string q = ReadResponse(quick, quick_buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_NE(q.find("GET /quick"), std::string::npos);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(900));
+
+  boost::asio::streambuf buf;
+  std::string r1 = ReadResponse(slow, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_EQ(r1.substr(r1.find("\r\n\r\n") + 4), before);
+  std::string r2 = ReadResponse(slow, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_NE(r2.find("Slept for 1 seconds"), std::string::npos);
+  EXPECT_NE(r2.find("Connection: keep-alive"), std::string::npos);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+  std::string r3 = ReadResponse(slow, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_EQ(r3.substr(r3.find("\r\n\r\n") + 4), after);
+
+  // Sessions must be gone before the pool
+  io_service_.stop();
+  if (io_thread_.joinable()) io_thread_.join();
+}
+
+// -----------------------------------------------------------------------------
+// BlockingHandlerAcrossIoThreads
+//
+// With several threads running the io_service, a blocking handler's
+// response comes back on the session's strand: pipelined requests around
+// it are still answered whole and in order.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, BlockingHandlerAcrossIoThreads) {
+  router_->add_route(
+    "/blocking_now",
+    [](const std::string& loc,
+       const std::unordered_map<std::string,std::string>& p) {
+      return HandlerRegistry::CreateHandler(SleepHandler::kName, loc, p);
+    },
+    {{"sleep_duration", "0"}, {"blocking", "on"}}
+  );
+  boost::asio::thread_pool pool(2);
+  SessionOptions options;
+  options.handler_pool = &pool;
+  ExpectPipelinedAcrossThreads("/blocking_now", options);
+}
+
+// -----------------------------------------------------------------------------
+// AsyncHandlerAcrossIoThreads
+//
+// With several threads running the io_service, an async handler's timer
+// may fire on any of them, yet its response is queued on the session's
+// strand: pipelined requests around it are answered whole and in order.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, AsyncHandlerAcrossIoThreads) {
+  router_->add_route(
+    "/async_now",
+    [](const std::string& loc,
+       const std::unordered_map<std::string,std::string>& p) {
+      return HandlerRegistry::CreateHandler(SleepHandler::kName, loc, p);
+    },
+    {{"sleep_duration", "0"}},
+    HandlerRegistry::SHARED, HandlerRegistry::ASYNC
+  );
+  ExpectPipelinedAcrossThreads("/async_now", SessionOptions());
+}
+
+// -----------------------------------------------------------------------------
+// AsyncHandlersShareThread
+//
+// Async handlers wait on timers rather than threads: many concurrent sleeps
+// on the single io_service thread all finish after about one second, and
+// requests pipelined behind one are answered after it, in order.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, AsyncHandlersShareThread) {
+  auto start = std::chrono::steady_clock::now();
+  std::vector<tcp::socket> sleepers;
+  for (int i = 0; i < 50; ++i) {
+    sleepers.push_back(SendRequest("GET /async_sleep_test HTTP/1.1\r\n\r\n"));
+  }
+  std::string after = "GET /after HTTP/1.1\r\n\r\n";
+  tcp::socket pipelined = SendRequest("GET /async_sleep_test HTTP/1.1\r\n\r\n" + after);
+
+  tcp::socket quick = SendRequest("GET /quick HTTP/1.1\r\n\r\n");
+  boost::asio::streambuf quick_buf; boost::system::error_code ec;
+  std::string q = ReadResponse(quick, quick_buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_NE(q.find("GET /quick"), std::string::npos);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(900));
+
+  for (auto& sock : sleepers) {
+    boost::asio::streambuf buf;
+    std::string r = ReadResponse(sock, buf, ec);
+    ASSERT_FALSE(ec);
+    EXPECT_NE(r.find("Slept for 1 seconds"), std::string::npos);
+  }
+  boost::asio::streambuf buf;
+  std::string r1 = ReadResponse(pipelined, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_NE(r1.find("Slept for 1 seconds"), std::string::npos);
+  EXPECT_NE(r1.find("Connection: keep-alive"), std::string::npos);
+  std::string r2 = ReadResponse(pipelined, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_EQ(r2.substr(r2.find("\r\n\r\n") + 4), after);
+
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  EXPECT_GE(elapsed, std::chrono::seconds(1));
+  EXPECT_LT(elapsed, std::chrono::seconds(3));
+}
+
+// -----------------------------------------------------------------------------
+// AsyncFileIOStreams
+//
+// With a file I/O backend, file slices are read off the io_service threads
+// in chunks and written like any other buffer.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, AsyncFileIOStreams) {
+  std::string content;
+  for (int i = 0; content.size() < 1024 * 1024; ++i) content += std::to_string(i) + "\n";
+  create_test_file("aio.txt", content);
+
+  tcp::acceptor probe(io_service_, {tcp::v4(), 0});
+  unsigned short aio_port = probe.local_endpoint().port();
+  probe.close();
+
+  std::unique_ptr<AsyncFileIO> file_io = AsyncFileIO::Create(io_service_, false, 2);
+  SessionOptions options;
+  options.file_io = file_io.get();
+  limited_server_ = std::make_unique<server>(
+      io_service_, aio_port, *router_, session::MakeSessionFactory(options));
+
+  tcp::socket sock(io_service_);
+  sock.connect({tcp::v4(), aio_port});
+  std::string echo = "GET /after HTTP/1.1\r\n\r\n";
+  boost::asio::write(sock, boost::asio::buffer(
+      "GET /static_test/aio.txt HTTP/1.1\r\n\r\n"
+      "GET /static_test/aio.txt HTTP/1.1\r\nRange: bytes=10-19,-300000\r\n\r\n" + echo));
+
+  boost::asio::streambuf buf; boost::system::error_code ec;
+  std::string whole = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_EQ(whole.substr(whole.find("\r\n\r\n") + 4), content);
+
+  std::string ranged = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  std::string body = ranged.substr(ranged.find("\r\n\r\n") + 4);
+  EXPECT_NE(body.find("\r\n\r\n" + content.substr(10, 10) + "\r\n"), std::string::npos);
+  EXPECT_NE(body.find("\r\n\r\n" + content.substr(content.size() - 300000) + "\r\n--"),
+            std::string::npos);
+
+  std::string r3 = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_EQ(r3.substr(r3.find("\r\n\r\n") + 4), echo);
+
+  // Sessions must be gone before the backend
+  io_service_.stop();
+  if (io_thread_.joinable()) io_thread_.join();
+}
+
+// -----------------------------------------------------------------------------
+// CachedStaticFile
+//
+// Responses whose body is shared with the cache are written intact, also
+// when pipelined.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, CachedStaticFile) {
+  std::string req = "GET /cached_test/test.txt HTTP/1.1\r\n\r\n";
+  tcp::socket sock = SendRequest(req + req);
+
+  boost::asio::streambuf buf; boost::system::error_code ec;
+  for (int i = 0; i < 2; ++i) {
+    std::string resp = ReadResponse(sock, buf, ec);
+    ASSERT_FALSE(ec) << "response " << i;
+    EXPECT_NE(resp.find("Content-Length: 14\r\n"), std::string::npos);
+    EXPECT_EQ(resp.substr(resp.find("\r\n\r\n") + 4), "this is a test");
+  }
+}
+
+// -----------------------------------------------------------------------------
+// PipelineDepthLimit
+//
+// More pipelined requests than the queue depth are still all answered once
+// earlier writes drain.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, PipelineDepthLimit) {
+  tcp::acceptor probe(io_service_, {tcp::v4(), 0});
+  unsigned short limited_port = probe.local_endpoint().port();
+  probe.close();
+
+  SessionOptions options;
+  options.pipeline_depth = 2;
+  limited_server_ = std::make_unique<server>(
+      io_service_, limited_port, *router_, session::MakeSessionFactory(options));
+
+  tcp::socket sock(io_service_);
+  sock.connect({tcp::v4(), limited_port});
+  std::string req = "GET /static_test/test.txt HTTP/1.1\r\n\r\n";
+  std::string all;
+  for (int i = 0; i < 5; ++i) all += req;
+  boost::asio::write(sock, boost::asio::buffer(all));
+
+  boost::asio::streambuf buf; boost::system::error_code ec;
+  for (int i = 0; i < 5; ++i) {
+    std::string resp = ReadResponse(sock, buf, ec);
+    ASSERT_FALSE(ec) << "response " << i;
+    EXPECT_EQ(resp.substr(resp.find("\r\n\r\n") + 4), "this is a test");
+  }
+}
+
+// -----------------------------------------------------------------------------
+// SessionPoolReuse
+//
+// A session freed by a closed connection is reused, buffers and all, by the
+// next one, which is served as if it were new.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, SessionPoolReuse) {
+  tcp::acceptor probe(io_service_, {tcp::v4(), 0});
+  unsigned short pooled_port = probe.local_endpoint().port();
+  probe.close();
+
+  SessionOptions options;
+  options.session_pool = 4;
+  limited_server_ = std::make_unique<server>(
+      io_service_, pooled_port, *router_, session::MakeSessionFactory(options));
+
+  for (int i = 0; i < 3; ++i) {
+    tcp::socket sock(io_service_);
+    sock.connect({tcp::v4(), pooled_port});
+    std::string req = "GET /static_test/test.txt HTTP/1.1\r\nConnection: close\r\n\r\n";
+    boost::asio::write(sock, boost::asio::buffer(req));
+    boost::asio::streambuf buf; boost::system::error_code ec;
+    boost::asio::read(sock, buf, ec);
+    EXPECT_EQ(ec, boost::asio::error::eof);
+    std::string resp(buffers_begin(buf.data()), buffers_end(buf.data()));
+    EXPECT_EQ(resp.substr(resp.find("\r\n\r\n") + 4), "this is a test") << "connection " << i;
+  }
+
+  // The last session is released once its completion handlers are done
+  SessionPool::Stats stats;
+  for (int i = 0; i < 100; ++i) {
+    stats = SessionPool::Of(io_service_).GetStats();
+    if (stats.idle >= 1) break;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  // One session per connection plus the one waiting for the next
+  EXPECT_EQ(stats.created + stats.reused, 4u);
+  EXPECT_GE(stats.reused, 1u);
+  EXPECT_GE(stats.idle, 1u);
+}
+
+// -----------------------------------------------------------------------------
+// HeadHasNoBody
+//
+// HEAD responses keep GET's Content-Length but carry no body, whether the
+// body would come from a string, the file cache, a mapping or a preloaded
+// root, so the pipelined response behind each one starts where it should.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, HeadHasNoBody) {
+  std::string get = "GET /static_test/test.txt HTTP/1.1\r\n\r\n";
+  std::string all;
+  for (const char* url : {"/echo", "/static_test/test.txt", "/cached_test/test.txt",
+                          "/mapped_test/test.txt", "/preloaded_test/test.txt"}) {
+    all += std::string("HEAD ") + url + " HTTP/1.1\r\n\r\n" + get;
+  }
+  tcp::socket sock = SendRequest(all);
+
+  boost::asio::streambuf buf; boost::system::error_code ec;
+  for (int i = 0; i < 5; ++i) {
+    std::size_t header_len = boost::asio::read_until(sock, buf, "\r\n\r\n", ec);
+    ASSERT_FALSE(ec) << "HEAD " << i;
+    std::string head(buffers_begin(buf.data()), buffers_begin(buf.data()) + header_len);
+    buf.consume(header_len);
+    EXPECT_EQ(head.find("HTTP/1.1 200 OK"), 0u) << head;
+    EXPECT_NE(head.find("Content-Length: "), std::string::npos) << head;
+    EXPECT_EQ(head.find("Content-Length: 0\r\n"), std::string::npos) << head;
+
+    std::string resp = ReadResponse(sock, buf, ec);
+    ASSERT_FALSE(ec) << "GET " << i;
+    EXPECT_EQ(resp.find("HTTP/1.1 200 OK"), 0u) << resp;
+    EXPECT_EQ(resp.substr(resp.find("\r\n\r\n") + 4), "this is a test");
+  }
+}
+
+// -----------------------------------------------------------------------------
+// PipelineStopsAtClose
+//
+// Requests pipelined after "Connection: close" are not answered.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, PipelineStopsAtClose) {
+  std::string first = "GET /first HTTP/1.1\r\nConnection: close\r\n\r\n";
+  std::string second = "GET /second HTTP/1.1\r\n\r\n";
+  tcp::socket sock = SendRequest(first + second);
+
+  boost::asio::streambuf buf; boost::system::error_code ec;
+  boost::asio::read(sock, buf, ec);
+  EXPECT_EQ(ec, boost::asio::error::eof);
+  std::string resp(buffers_begin(buf.data()), buffers_end(buf.data()));
+  EXPECT_EQ(resp.substr(resp.find("\r\n\r\n") + 4), first);
+}
+
+
+// -----------------------------------------------------------------------------
+// InvalidContentLength
+//
+// A non-numeric Content-Length can't be framed and gets a 400.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, InvalidContentLength) {
+  tcp::socket sock = SendRequest("POST / HTTP/1.1\r\nContent-Length: abc\r\n\r\n");
+  boost::asio::streambuf buf; boost::system::error_code ec;
+  std::string resp = ReadResponse(sock, buf, ec);
+  EXPECT_EQ(resp.find("HTTP/1.1 400 Bad Request"), 0u);
+  EXPECT_NE(resp.find("Connection: close\r\n"), std::string::npos);
+}
+
+// -----------------------------------------------------------------------------
+// TransferEncodingRefused
+//
+// Chunked bodies aren't supported, so the body can't be framed: the request
+// gets a 501 and nothing after it on the connection is read.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, TransferEncodingRefused) {
+  tcp::socket sock = SendRequest("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                                 "1c\r\nGET /smuggled HTTP/1.1\r\n\r\n\r\n0\r\n\r\n");
+  boost::asio::streambuf buf; boost::system::error_code ec;
+  boost::asio::read(sock, buf, ec);
+  EXPECT_EQ(ec, boost::asio::error::eof);
+  std::string resp(buffers_begin(buf.data()), buffers_end(buf.data()));
+  EXPECT_EQ(resp.find("HTTP/1.1 501 Not Implemented"), 0u);
+  EXPECT_NE(resp.find("Connection: close\r\n"), std::string::npos);
+  EXPECT_EQ(resp.find("HTTP/1.1", 1), std::string::npos);
+}
+
+// -----------------------------------------------------------------------------
+// ConflictingContentLength
+//
+// Two Content-Length values that disagree leave the body unframed and get a
+// 400 that closes the connection.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, ConflictingContentLength) {
+  tcp::socket sock = SendRequest("POST / HTTP/1.1\r\nContent-Length: 0\r\n"
+                                 "Content-Length: 26\r\n\r\nGET /smuggled HTTP/1.1\r\n\r\n");
+  boost::asio::streambuf buf; boost::system::error_code ec;
+  boost::asio::read(sock, buf, ec);
+  EXPECT_EQ(ec, boost::asio::error::eof);
+  std::string resp(buffers_begin(buf.data()), buffers_end(buf.data()));
+  EXPECT_EQ(resp.find("HTTP/1.1 400 Bad Request"), 0u);
+  EXPECT_EQ(resp.find("HTTP/1.1", 1), std::string::npos);
+}
+
+// -----------------------------------------------------------------------------
+// StrayCrlfBetweenRequests
+//
+// A CRLF sent after a request body is skipped rather than taken for a
+// malformed request line.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, StrayCrlfBetweenRequests) {
+  std::string first = "GET /first HTTP/1.1\r\nContent-Length: 4\r\n\r\nbody";
+  std::string second = "GET /second HTTP/1.1\r\n\r\n";
+  tcp::socket sock = SendRequest(first + "\r\n" + second);
+
+  boost::asio::streambuf buf; boost::system::error_code ec;
+  std::string r1 = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_EQ(r1.substr(r1.find("\r\n\r\n") + 4), first);
+
+  std::string r2 = ReadResponse(sock, buf, ec);
+  ASSERT_FALSE(ec);
+  EXPECT_EQ(r2.find("HTTP/1.1 200 OK"), 0u);
+  EXPECT_EQ(r2.substr(r2.find("\r\n\r\n") + 4), second);
+}
+
+// -----------------------------------------------------------------------------
+// HeadersTooLarge
+//
+// A request whose headers outgrow RequestParser::kMaxHeaderBytes before
+// they end gets a 431 and the connection is closed, instead of the session
+// buffering them for as long as the client keeps sending.
+// -----------------------------------------------------------------------------
+TEST_F(SessionTest, HeadersTooLarge) {
+  std::string head = "GET / HTTP/1.1\r\nX-Fill: ";
+  tcp::socket sock = SendRequest(
+      head + std::string(RequestParser::kMaxHeaderBytes + 1 - head.size(), 'a'));
+  boost::asio::streambuf buf; boost::system::error_code ec;
+  boost::asio::read(sock, buf, ec);
+  EXPECT_EQ(ec, boost::asio::error::eof);
+  std::string resp(buffers_begin(buf.data()), buffers_end(buf.data()));
+  EXPECT_EQ(resp.find("HTTP/1.1 431 Request Header Fields Too Large"), 0u);
+  EXPECT_NE(resp.find("Connection: close\r\n"), std::string::npos);
+}
@@ -160,4 +160,29 @@ TEST_F(SleepHandlerTest, NegativeSleepDuration) {
    
    EXPECT_EQ(response.get_status_code(), 200);
    EXPECT_LT(duration.count(), 50);
-}
\ No newline at end of file
+}
+
+// Concurrent sleeps share one thread, each waiting on its own timer: one
+// run() of the io_service answers them all
+TEST_F(SleepHandlerTest, AsyncSleepsShareAThread) {
+  const std::string req = "GET /sleep HTTP/1.1\r\nHost: localhost\r\n\r\n";
+  Request request(req);
+  boost::asio::io_service io;
+  int answered = 0;
+
+  auto start_time = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < 1000; ++i) {
+    fast_handler_->async_handle_request(request, io, [&answered](Response response) {
+      EXPECT_EQ(response.get_status_code(), 200);
+      ++answered;
+    });
+  }
+  EXPECT_EQ(answered, 0);
+  io.run();
+  auto end_time = std::chrono::high_resolution_clock::now();
+
+  auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+  EXPECT_EQ(answered, 1000);
+  // Timers never fire early; how late they are depends on the machine
+  EXPECT_GE(duration.count(), 900);
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "static_file_cache.h"
+
+// ----------  StaticFileCacheTest Fixture  ---------------
+class StaticFileCacheTest : public ::testing::Test {
+  protected:
+    // An entry with a body of size bytes, from a file with the given mtime
+    std::shared_ptr<const StaticFileCache::Entry> MakeEntry(std::size_t size, std::int64_t mtime = 1) {
+      auto entry = std::make_shared<StaticFileCache::Entry>();
+      entry->body = std::make_shared<const std::string>(size, 'x');
+      entry->mime_type = "text/plain";
+      entry->headers = std::make_shared<const std::string>("Content-Type: text/plain\r\n");
+      entry->stat = StatFor(size, mtime);
+      return entry;
+    }
+
+    FileStat StatFor(std::size_t size, std::int64_t mtime = 1) {
+      FileStat st;
+      st.size = size;
+      st.mtime_ns = mtime;
+      st.inode = 42;
+      st.regular = true;
+      return st;
+    }
+};
+
+// ----------------- StaticFileCache unit tests -----------------
+TEST_F(StaticFileCacheTest, MissThenHit) {
+  StaticFileCache cache(1024 * 1024);
+  EXPECT_EQ(cache.Lookup("/a", StatFor(10)), nullptr);
+  ASSERT_TRUE(cache.Insert("/a", MakeEntry(10)));
+  auto hit = cache.Lookup("/a", StatFor(10));
+  ASSERT_NE(hit, nullptr);
+  EXPECT_EQ(hit->body->size(), 10u);
+
+  StaticFileCache::Stats stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 1u);
+  EXPECT_EQ(stats.misses, 1u);
+  EXPECT_EQ(stats.entries, 1u);
+}
+
+TEST_F(StaticFileCacheTest, ChangedFileIsStale) {
+  StaticFileCache cache(1024 * 1024);
+  ASSERT_TRUE(cache.Insert("/a", MakeEntry(10, 1)));
+  EXPECT_EQ(cache.Lookup("/a", StatFor(10, 2)), nullptr);
+  // The stale entry was dropped
+  EXPECT_EQ(cache.GetStats().entries, 0u);
+  EXPECT_EQ(cache.GetStats().bytes, 0u);
+}
+
+TEST_F(StaticFileCacheTest, EvictsLeastRecentlyUsed) {
+  // One shard so every entry competes for the same budget
+  StaticFileCache cache(1000, 1);
+  ASSERT_TRUE(cache.Insert("/a", MakeEntry(300)));
+  ASSERT_TRUE(cache.Insert("/b", MakeEntry(300)));
+  ASSERT_NE(cache.Lookup("/a", StatFor(300)), nullptr);  // "/b" is now oldest
+  ASSERT_TRUE(cache.Insert("/c", MakeEntry(300)));
+
+  EXPECT_NE(cache.Lookup("/a", StatFor(300)), nullptr);
+  EXPECT_EQ(cache.Lookup("/b", StatFor(300)), nullptr);
+  EXPECT_NE(cache.Lookup("/c", StatFor(300)), nullptr);
+  EXPECT_EQ(cache.GetStats().evictions, 1u);
+  EXPECT_LE(cache.GetStats().bytes, 1000u);
+}
+
+TEST_F(StaticFileCacheTest, RejectsOversizedEntries) {
+  StaticFileCache cache(1000, 1);
+  EXPECT_FALSE(cache.Insert("/big", MakeEntry(2000)));
+  EXPECT_EQ(cache.GetStats().entries, 0u);
+}
+
+TEST_F(StaticFileCacheTest, ReinsertReplaces) {
+  StaticFileCache cache(1024 * 1024);
+  ASSERT_TRUE(cache.Insert("/a", MakeEntry(10, 1)));
+  ASSERT_TRUE(cache.Insert("/a", MakeEntry(20, 2)));
+  EXPECT_EQ(cache.GetStats().entries, 1u);
+  auto hit = cache.Lookup("/a", StatFor(20, 2));
+  ASSERT_NE(hit, nullptr);
+  EXPECT_EQ(hit->body->size(), 20u);
+}
+
+TEST_F(StaticFileCacheTest, ShardsSplitBudget) {
+  StaticFileCache cache(16 * 1024, 16);
+  EXPECT_EQ(cache.max_entry_bytes(), 1024u);
+  for (int i = 0; i < 200; ++i) cache.Insert("/f" + std::to_string(i), MakeEntry(100));
+  EXPECT_LE(cache.GetStats().bytes, 16u * 1024);
+  EXPECT_GT(cache.GetStats().evictions, 0u);
+}
@@ -70,4 +70,492 @@ TEST_F(StaticHandlerTest, PathTraversalBlocked) {
     std::string resp_str = response.to_string();
 
     EXPECT_NE(resp_str.find("HTTP/1.1 404 Not Found"), std::string::npos);
-}
\ No newline at end of file
+}
+// ----------------- cache_size_mb -----------------
+
+// A cached handler serves from memory until the file changes on disk
+TEST_F(StaticHandlerTest, CachedFileRevalidated) {
+    std::unique_ptr<StaticHandler> cached(static_cast<StaticHandler*>(StaticHandler::Init(
+        "/static", {{"root", temp_dir_.string()}, {"cache_size_mb", "1"}})));
+    ASSERT_NE(cached->cache(), nullptr);
+    Request request("GET /static/test.txt HTTP/1.1\r\n\r\n");
+
+    Response first = cached->handle_request(request);
+    Response second = cached->handle_request(request);
+    EXPECT_NE(second.get_shared_body(), nullptr);
+    EXPECT_EQ(first.to_string(), second.to_string());
+    EXPECT_NE(second.to_string().find("Content-Type: text/plain; charset=utf-8\r\n"), std::string::npos);
+    EXPECT_EQ(cached->cache()->GetStats().misses, 1u);
+    EXPECT_EQ(cached->cache()->GetStats().hits, 1u);
+
+    create_test_file("test.txt", "Changed sample text");
+    std::string resp = cached->handle_request(request).to_string();
+    EXPECT_EQ(resp.substr(resp.find("\r\n\r\n") + 4), "Changed sample text");
+    EXPECT_EQ(cached->cache()->GetStats().misses, 2u);
+}
+
+// Without cache_size_mb the handler has no cache and streams files
+TEST_F(StaticHandlerTest, CacheDisabledByDefault) {
+    EXPECT_EQ(handler_->cache(), nullptr);
+    Response resp = handler_->handle_request(Request("GET /static/test.txt HTTP/1.1\r\n\r\n"));
+    EXPECT_NE(resp.get_file_body(), nullptr);
+}
+
+// Missing files are still 404 with the cache on
+TEST_F(StaticHandlerTest, CachedMissingFile) {
+    std::unique_ptr<RequestHandler> cached(StaticHandler::Init(
+        "/static", {{"root", temp_dir_.string()}, {"cache_size_mb", "1"}}));
+    Response resp = cached->handle_request(Request("GET /static/missing.txt HTTP/1.1\r\n\r\n"));
+    EXPECT_EQ(resp.get_status_code(), 404);
+}
+
+// A malformed cache size is a configuration error
+TEST_F(StaticHandlerTest, InvalidCacheSizeThrows) {
+    EXPECT_THROW(StaticHandler::Init("/static", {{"root", temp_dir_.string()}, {"cache_size_mb", "lots"}}),
+                 std::runtime_error);
+}
+
+// ----------------- Conditional GET -----------------
+
+// Extracts the value of a header from a serialized response
+static std::string headerValue(const std::string& resp, const std::string& name) {
+    auto pos = resp.find("\r\n" + name + ": ");
+    if (pos == std::string::npos) return "";
+    pos += name.size() + 4;
+    return resp.substr(pos, resp.find("\r\n", pos) - pos);
+}
+
+// Responses carry validators, and sending them back yields a bodiless 304
+TEST_F(StaticHandlerTest, NotModifiedWithValidators) {
+    std::string resp = handler_->handle_request(Request("GET /static/test.txt HTTP/1.1\r\n\r\n")).to_string();
+    std::string etag = headerValue(resp, "ETag");
+    std::string last_modified = headerValue(resp, "Last-Modified");
+    ASSERT_FALSE(etag.empty());
+    ASSERT_FALSE(last_modified.empty());
+
+    Response by_etag = handler_->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nIf-None-Match: " + etag + "\r\n\r\n"));
+    EXPECT_EQ(by_etag.get_status_code(), 304);
+    std::string s = by_etag.to_string();
+    EXPECT_EQ(s.substr(s.find("\r\n\r\n") + 4), "");
+    EXPECT_EQ(s.find("Content-Length"), std::string::npos);
+    EXPECT_EQ(headerValue(s, "ETag"), etag);
+
+    Response by_date = handler_->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nIf-Modified-Since: " + last_modified + "\r\n\r\n"));
+    EXPECT_EQ(by_date.get_status_code(), 304);
+}
+
+// A modified file no longer matches the old ETag
+TEST_F(StaticHandlerTest, ModifiedFileSentInFull) {
+    std::string resp = handler_->handle_request(Request("GET /static/test.txt HTTP/1.1\r\n\r\n")).to_string();
+    std::string etag = headerValue(resp, "ETag");
+
+    create_test_file("test.txt", "Different sample text");
+    Response after = handler_->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nIf-None-Match: " + etag + "\r\n\r\n"));
+    EXPECT_EQ(after.get_status_code(), 200);
+    EXPECT_NE(headerValue(after.to_string(), "ETag"), etag);
+}
+
+// Cached entries carry the same validators in their prebuilt headers
+TEST_F(StaticHandlerTest, CachedNotModified) {
+    std::unique_ptr<RequestHandler> cached(StaticHandler::Init(
+        "/static", {{"root", temp_dir_.string()}, {"cache_size_mb", "1"}}));
+    std::string resp = cached->handle_request(Request("GET /static/test.txt HTTP/1.1\r\n\r\n")).to_string();
+    std::string etag = headerValue(resp, "ETag");
+    ASSERT_FALSE(etag.empty());
+    EXPECT_EQ(headerValue(handler_->handle_request(Request("GET /static/test.txt HTTP/1.1\r\n\r\n")).to_string(), "ETag"), etag);
+
+    Response not_modified = cached->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nIf-None-Match: " + etag + "\r\n\r\n"));
+    EXPECT_EQ(not_modified.get_status_code(), 304);
+}
+
+// A single range is a 206 of just those bytes
+TEST_F(StaticHandlerTest, SingleRange) {
+    Response response = handler_->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nRange: bytes=2-5\r\n\r\n"));
+    EXPECT_EQ(response.get_status_code(), 206);
+    std::string s = response.to_string();
+    EXPECT_EQ(headerValue(s, "Content-Range"), "bytes 2-5/11");
+    EXPECT_EQ(headerValue(s, "Content-Length"), "4");
+    EXPECT_EQ(s.substr(s.find("\r\n\r\n") + 4), "mple");
+    ASSERT_EQ(response.get_file_slices().size(), 1u);
+    EXPECT_EQ(response.get_file_slices()[0].offset, 2u);
+}
+
+// Header names are case-insensitive, lowercase ones work the same
+TEST_F(StaticHandlerTest, LowercaseRangeHeaders) {
+    Response response = handler_->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nrange: bytes=2-5\r\n\r\n"));
+    EXPECT_EQ(response.get_status_code(), 206);
+    std::string etag = headerValue(response.to_string(), "ETag");
+    ASSERT_FALSE(etag.empty());
+
+    Response conditional = handler_->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nrange: bytes=2-5\r\nif-range: " + etag +
+                "\r\n\r\n"));
+    EXPECT_EQ(conditional.get_status_code(), 206);
+    Response stale = handler_->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nrange: bytes=2-5\r\nif-range: \"old\"\r\n\r\n"));
+    EXPECT_EQ(stale.get_status_code(), 200);
+}
+
+// Several ranges become parts of a multipart/byteranges body
+TEST_F(StaticHandlerTest, MultipleRanges) {
+    Response response = handler_->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nRange: bytes=0-1,-4\r\n\r\n"));
+    EXPECT_EQ(response.get_status_code(), 206);
+    std::string s = response.to_string();
+    std::string type = headerValue(s, "Content-Type");
+    ASSERT_EQ(type.rfind("multipart/byteranges; boundary=", 0), 0u);
+    std::string boundary = type.substr(type.find('=') + 1);
+
+    std::string body = s.substr(s.find("\r\n\r\n") + 4);
+    EXPECT_EQ(body,
+              "--" + boundary + "\r\nContent-Type: text/plain; charset=utf-8\r\n"
+              "Content-Range: bytes 0-1/11\r\n\r\nSa\r\n"
+              "--" + boundary + "\r\nContent-Type: text/plain; charset=utf-8\r\n"
+              "Content-Range: bytes 7-10/11\r\n\r\ntext\r\n"
+              "--" + boundary + "--\r\n");
+    EXPECT_EQ(headerValue(s, "Content-Length"), std::to_string(body.size()));
+}
+
+TEST_F(StaticHandlerTest, UnsatisfiableRange) {
+    Response response = handler_->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nRange: bytes=50-\r\n\r\n"));
+    EXPECT_EQ(response.get_status_code(), 416);
+    EXPECT_EQ(response.get_header("Content-Range"), "bytes */11");
+}
+
+// A stale If-Range, a malformed Range or a cached file all still work
+TEST_F(StaticHandlerTest, RangeFallsBackToWholeFile) {
+    Response stale = handler_->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nRange: bytes=0-1\r\nIf-Range: \"old\"\r\n\r\n"));
+    EXPECT_EQ(stale.get_status_code(), 200);
+    EXPECT_NE(stale.to_string().find("Sample text"), std::string::npos);
+
+    Response malformed = handler_->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nRange: lines=1-2\r\n\r\n"));
+    EXPECT_EQ(malformed.get_status_code(), 200);
+
+    std::string etag = headerValue(stale.to_string(), "ETag");
+    std::unique_ptr<RequestHandler> cached(StaticHandler::Init(
+        "/static", {{"root", temp_dir_.string()}, {"cache_size_mb", "1"}}));
+    Response current = cached->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nRange: bytes=0-1\r\nIf-Range: " + etag + "\r\n\r\n"));
+    EXPECT_EQ(current.get_status_code(), 206);
+    EXPECT_EQ(current.get_header("Accept-Ranges"), "bytes");
+}
+
+// With precompressed on, an accepted sibling is sent in place of the file
+TEST_F(StaticHandlerTest, ServesPrecompressedSibling) {
+    create_test_file("test.txt.br", "BROTLI");
+    create_test_file("test.txt.gz", "GZIP");
+    std::unique_ptr<StaticHandler> pre(static_cast<StaticHandler*>(StaticHandler::Init(
+        "/static", {{"root", temp_dir_.string()}, {"precompressed", "on"}})));
+
+    Response br = pre->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nAccept-Encoding: gzip, br\r\n\r\n"));
+    std::string s = br.to_string();
+    EXPECT_EQ(s.substr(s.find("\r\n\r\n") + 4), "BROTLI");
+    EXPECT_EQ(headerValue(s, "Content-Type"), "text/plain; charset=utf-8");
+    EXPECT_EQ(br.get_header("Content-Encoding"), "br");
+    EXPECT_EQ(br.get_header("Vary"), "Accept-Encoding");
+
+    Response gz = pre->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n"));
+    EXPECT_EQ(gz.get_header("Content-Encoding"), "gzip");
+    EXPECT_NE(gz.get_header("ETag"), br.get_header("ETag"));
+
+    // Identity still varies, but isn't encoded
+    Response plain = pre->handle_request(Request("GET /static/test.txt HTTP/1.1\r\n\r\n"));
+    s = plain.to_string();
+    EXPECT_EQ(s.substr(s.find("\r\n\r\n") + 4), "Sample text");
+    EXPECT_EQ(plain.get_header("Content-Encoding"), "");
+    EXPECT_EQ(plain.get_header("Vary"), "Accept-Encoding");
+
+    // Sibling lookups were done once, for the first request
+    EXPECT_EQ(pre->precompressed()->probes(), 1u);
+}
+
+// Without siblings or with the option off nothing changes
+TEST_F(StaticHandlerTest, PrecompressedOffByDefault) {
+    create_test_file("test.txt.gz", "GZIP");
+    Response response = handler_->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n"));
+    EXPECT_EQ(response.get_header("Content-Encoding"), "");
+    EXPECT_EQ(response.get_header("Vary"), "");
+    EXPECT_EQ(handler_->precompressed(), nullptr);
+
+    EXPECT_THROW(StaticHandler::Init("/static", {{"root", temp_dir_.string()},
+                                                 {"precompressed", "yes"}}),
+                 std::runtime_error);
+}
+
+// Cached siblings keep their own entries and headers
+TEST_F(StaticHandlerTest, CachedPrecompressedSibling) {
+    create_test_file("test.txt.gz", "GZIP");
+    std::unique_ptr<RequestHandler> pre(StaticHandler::Init(
+        "/static", {{"root", temp_dir_.string()}, {"precompressed", "on"},
+                    {"cache_size_mb", "1"}}));
+    for (int i = 0; i < 2; ++i) {
+        Response gz = pre->handle_request(
+            Request("GET /static/test.txt HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n"));
+        std::string s = gz.to_string();
+        EXPECT_EQ(s.substr(s.find("\r\n\r\n") + 4), "GZIP");
+        EXPECT_EQ(headerValue(s, "Content-Encoding"), "gzip");
+        EXPECT_EQ(headerValue(s, "Content-Type"), "text/plain; charset=utf-8");
+    }
+    Response plain = pre->handle_request(Request("GET /static/test.txt HTTP/1.1\r\n\r\n"));
+    std::string s = plain.to_string();
+    EXPECT_EQ(s.substr(s.find("\r\n\r\n") + 4), "Sample text");
+}
+
+// ----------------- mmap -----------------
+
+// Mapped files are served without being opened again until they change
+TEST_F(StaticHandlerTest, MappedFileRemappedOnChange) {
+    std::unique_ptr<StaticHandler> mapped(static_cast<StaticHandler*>(StaticHandler::Init(
+        "/static", {{"root", temp_dir_.string()}, {"mmap", "on"}, {"mmap_advice", "sequential"}})));
+    ASSERT_NE(mapped->mapped(), nullptr);
+
+    for (int i = 0; i < 2; ++i) {
+        Response response = mapped->handle_request(Request("GET /static/test.txt HTTP/1.1\r\n\r\n"));
+        ASSERT_EQ(response.get_file_slices().size(), 1u);
+        EXPECT_NE(response.get_file_slices()[0].mapping, nullptr);
+        EXPECT_EQ(response.get_file_body(), nullptr);
+        std::string s = response.to_string();
+        EXPECT_EQ(s.substr(s.find("\r\n\r\n") + 4), "Sample text");
+    }
+    EXPECT_EQ(mapped->mapped()->GetStats().hits, 1u);
+
+    // Replaced by rename, as a deploy would: a new inode gets a new mapping
+    create_test_file("test.txt.new", "Replaced text!");
+    fs::rename(temp_dir_ / "test.txt.new", temp_dir_ / "test.txt");
+    Response response = mapped->handle_request(Request("GET /static/test.txt HTTP/1.1\r\n\r\n"));
+    std::string s = response.to_string();
+    EXPECT_EQ(s.substr(s.find("\r\n\r\n") + 4), "Replaced text!");
+    auto stats = mapped->mapped()->GetStats();
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.entries, 1u);
+    EXPECT_EQ(stats.bytes, 14u);
+}
+
+// Ranges and empty files work from a mapping too
+TEST_F(StaticHandlerTest, MappedRangesAndEmptyFile) {
+    std::unique_ptr<RequestHandler> mapped(StaticHandler::Init(
+        "/static", {{"root", temp_dir_.string()}, {"mmap", "on"}}));
+    Response range = mapped->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nRange: bytes=0-1,-4\r\n\r\n"));
+    EXPECT_EQ(range.get_status_code(), 206);
+    ASSERT_EQ(range.get_file_slices().size(), 2u);
+    std::string s = range.to_string();
+    EXPECT_NE(s.find("Content-Range: bytes 0-1/11\r\n\r\nSa\r\n"), std::string::npos);
+    EXPECT_NE(s.find("Content-Range: bytes 7-10/11\r\n\r\ntext\r\n"), std::string::npos);
+
+    create_test_file("empty.txt", "");
+    Response empty = mapped->handle_request(Request("GET /static/empty.txt HTTP/1.1\r\n\r\n"));
+    EXPECT_EQ(empty.get_status_code(), 200);
+    EXPECT_EQ(headerValue(empty.to_string(), "Content-Length"), "0");
+}
+
+TEST_F(StaticHandlerTest, InvalidMmapParamsThrow) {
+    EXPECT_EQ(handler_->mapped(), nullptr);
+    EXPECT_THROW(StaticHandler::Init("/static", {{"root", temp_dir_.string()}, {"mmap", "yes"}}),
+                 std::runtime_error);
+    EXPECT_THROW(StaticHandler::Init("/static", {{"root", temp_dir_.string()},
+                                                 {"mmap_advice", "hugepage"}}),
+                 std::runtime_error);
+    EXPECT_THROW(StaticHandler::Init("/static", {{"root", temp_dir_.string()}, {"mmap", "on"},
+                                                 {"cache_size_mb", "1"}}),
+                 std::runtime_error);
+}
+
+// ----------------- preload -----------------
+
+// The whole root is read at startup and served with prebuilt headers
+TEST_F(StaticHandlerTest, PreloadedServesPrebuilt) {
+    fs::create_directories(temp_dir_ / "css");
+    create_test_file("css/app.css", "body{}");
+    std::unique_ptr<StaticHandler> preloaded(static_cast<StaticHandler*>(StaticHandler::Init(
+        "/static", {{"root", temp_dir_.string()}, {"preload", "on"}})));
+    ASSERT_NE(preloaded->preloaded(), nullptr);
+    EXPECT_EQ(preloaded->preloaded()->size(), 3u);
+
+    Response response = preloaded->handle_request(Request("GET /static/css/app.css HTTP/1.1\r\n\r\n"));
+    EXPECT_EQ(response.get_status_code(), 200);
+    ASSERT_NE(response.get_prebuilt_owner(), nullptr);
+    std::string s = response.to_string();
+    EXPECT_EQ(headerValue(s, "Content-Type"), "text/css");
+    EXPECT_EQ(headerValue(s, "Content-Length"), "6");
+    EXPECT_EQ(s.substr(s.find("\r\n\r\n") + 4), "body{}");
+
+    // Changes on disk aren't seen until a restart
+    create_test_file("css/app.css", "body{color:red}");
+    response = preloaded->handle_request(Request("GET /static/css/app.css?v=1 HTTP/1.1\r\n\r\n"));
+    s = response.to_string();
+    EXPECT_EQ(s.substr(s.find("\r\n\r\n") + 4), "body{}");
+}
+
+// Validators are answered from the preloaded copy
+TEST_F(StaticHandlerTest, PreloadedNotModified) {
+    std::unique_ptr<RequestHandler> preloaded(StaticHandler::Init(
+        "/static", {{"root", temp_dir_.string()}, {"preload", "on"}}));
+    std::string etag = headerValue(
+        preloaded->handle_request(Request("GET /static/test.txt HTTP/1.1\r\n\r\n")).to_string(),
+        "ETag");
+    Response response = preloaded->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nIf-None-Match: " + etag + "\r\n\r\n"));
+    EXPECT_EQ(response.get_status_code(), 304);
+    EXPECT_EQ(response.get_prebuilt_owner(), nullptr);
+    EXPECT_EQ(headerValue(response.to_string(), "ETag"), etag);
+}
+
+// HEAD, HTTP/1.0 and ranges are answered from the preloaded copy too, so
+// they agree with GET after the file changes on disk
+TEST_F(StaticHandlerTest, PreloadedServesEveryForm) {
+    std::unique_ptr<RequestHandler> preloaded(StaticHandler::Init(
+        "/static", {{"root", temp_dir_.string()}, {"preload", "on"}}));
+    std::string get = preloaded->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\n\r\n")).to_string();
+    create_test_file("test.txt", "changed on disk after startup");
+
+    Response head = preloaded->handle_request(Request("HEAD /static/test.txt HTTP/1.1\r\n\r\n"));
+    EXPECT_EQ(head.get_status_code(), 200);
+    std::string h = head.header_string();
+    EXPECT_EQ(headerValue(h, "ETag"), headerValue(get, "ETag"));
+    EXPECT_EQ(headerValue(h, "Content-Length"), "11");
+
+    Response old = preloaded->handle_request(Request("GET /static/test.txt HTTP/1.0\r\n\r\n"));
+    EXPECT_EQ(old.get_status_code(), 200);
+    EXPECT_NE(old.get_prebuilt_owner(), nullptr);
+    std::string o = old.to_string();
+    EXPECT_EQ(o.rfind("HTTP/1.0 200", 0), 0u);
+    EXPECT_EQ(headerValue(o, "Content-Type"), "text/plain; charset=utf-8");
+    EXPECT_EQ(headerValue(o, "ETag"), headerValue(get, "ETag"));
+    EXPECT_EQ(o.substr(o.find("\r\n\r\n") + 4), "Sample text");
+
+    Response range = preloaded->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nRange: bytes=0-3\r\n\r\n"));
+    EXPECT_EQ(range.get_status_code(), 206);
+    EXPECT_NE(range.get_prebuilt_owner(), nullptr);
+    std::string r = range.to_string();
+    EXPECT_EQ(headerValue(r, "Content-Range"), "bytes 0-3/11");
+    EXPECT_EQ(headerValue(r, "Content-Length"), "4");
+    EXPECT_EQ(r.substr(r.find("\r\n\r\n") + 4), "Samp");
+
+    Response multi = preloaded->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nRange: bytes=0-3,7-\r\n\r\n"));
+    EXPECT_EQ(multi.get_status_code(), 206);
+    std::string m = multi.to_string();
+    std::string boundary = headerValue(m, "Content-Type").substr(strlen("multipart/byteranges; boundary="));
+    std::string body = m.substr(m.find("\r\n\r\n") + 4);
+    EXPECT_EQ(headerValue(m, "Content-Length"), std::to_string(body.size()));
+    EXPECT_NE(body.find("Content-Range: bytes 0-3/11\r\n\r\nSamp\r\n"), std::string::npos);
+    EXPECT_NE(body.find("Content-Range: bytes 7-10/11\r\n\r\ntext\r\n--" + boundary + "--\r\n"),
+              std::string::npos);
+
+    Response unsatisfiable = preloaded->handle_request(
+        Request("GET /static/test.txt HTTP/1.1\r\nRange: bytes=100-\r\n\r\n"));
+    EXPECT_EQ(unsatisfiable.get_status_code(), 416);
+    EXPECT_EQ(unsatisfiable.get_header("Content-Range"), "bytes */11");
+}
+
+// Files that weren't preloaded take the regular path
+TEST_F(StaticHandlerTest, PreloadedFallsBack) {
+    std::unique_ptr<RequestHandler> preloaded(StaticHandler::Init(
+        "/static", {{"root", temp_dir_.string()}, {"preload", "on"}}));
+    create_test_file("later.txt", "added later");
+
+    Response later = preloaded->handle_request(Request("GET /static/later.txt HTTP/1.1\r\n\r\n"));
+    EXPECT_EQ(later.get_status_code(), 200);
+    EXPECT_EQ(later.get_prebuilt_owner(), nullptr);
+    Response range = preloaded->handle_request(
+        Request("GET /static/later.txt HTTP/1.1\r\nRange: bytes=0-1\r\n\r\n"));
+    EXPECT_EQ(range.get_status_code(), 206);
+    EXPECT_EQ(range.get_prebuilt_owner(), nullptr);
+    Response missing = preloaded->handle_request(Request("GET /static/nope.txt HTTP/1.1\r\n\r\n"));
+    EXPECT_EQ(missing.get_status_code(), 404);
+}
+
+TEST_F(StaticHandlerTest, InvalidPreloadParamsThrow) {
+    EXPECT_EQ(handler_->preloaded(), nullptr);
+    EXPECT_THROW(StaticHandler::Init("/static", {{"root", temp_dir_.string()}, {"preload", "1"}}),
+                 std::runtime_error);
+    EXPECT_THROW(StaticHandler::Init("/static", {{"root", temp_dir_.string()}, {"preload", "on"},
+                                                 {"precompressed", "on"}}),
+                 std::runtime_error);
+}
+
+// ----------------- directories -----------------
+
+// Directory URLs get the index file, after a redirect to the trailing slash
+TEST_F(StaticHandlerTest, DirectoryIndex) {
+    fs::create_directories(temp_dir_ / "docs");
+    create_test_file("docs/index.html", "<p>docs</p>");
+
+    Response redirect = handler_->handle_request(Request("GET /static/docs?x=1 HTTP/1.1\r\n\r\n"));
+    EXPECT_EQ(redirect.get_status_code(), 301);
+    EXPECT_EQ(headerValue(redirect.to_string(), "Location"), "/static/docs/?x=1");
+    EXPECT_EQ(redirect.to_string().find("Content-Type"), std::string::npos);
+
+    Response index = handler_->handle_request(Request("GET /static/docs/ HTTP/1.1\r\n\r\n"));
+    EXPECT_EQ(index.get_status_code(), 200);
+    std::string s = index.to_string();
+    EXPECT_EQ(headerValue(s, "Content-Type"), "text/html; charset=utf-8");
+    EXPECT_EQ(s.substr(s.find("\r\n\r\n") + 4), "<p>docs</p>");
+
+    // The root itself, and no listing without autoindex
+    EXPECT_EQ(handler_->handle_request(Request("GET /static HTTP/1.1\r\n\r\n")).get_status_code(), 301);
+    EXPECT_EQ(handler_->handle_request(Request("GET /static/ HTTP/1.1\r\n\r\n")).get_status_code(), 404);
+    EXPECT_EQ(handler_->listings(), nullptr);
+}
+
+TEST_F(StaticHandlerTest, CustomAndDisabledIndex) {
+    create_test_file("home.htm", "home");
+    std::unique_ptr<RequestHandler> custom(StaticHandler::Init(
+        "/static", {{"root", temp_dir_.string()}, {"index", "home.htm"}}));
+    std::string s = custom->handle_request(Request("GET /static/ HTTP/1.1\r\n\r\n")).to_string();
+    EXPECT_EQ(s.substr(s.find("\r\n\r\n") + 4), "home");
+
+    create_test_file("index.html", "index");
+    std::unique_ptr<RequestHandler> off(StaticHandler::Init(
+        "/static", {{"root", temp_dir_.string()}, {"index", "off"}}));
+    EXPECT_EQ(off->handle_request(Request("GET /static/ HTTP/1.1\r\n\r\n")).get_status_code(), 404);
+
+    EXPECT_THROW(StaticHandler::Init("/static", {{"root", temp_dir_.string()}, {"index", "../x"}}),
+                 std::runtime_error);
+    EXPECT_THROW(StaticHandler::Init("/static", {{"root", temp_dir_.string()}, {"autoindex", "yes"}}),
+                 std::runtime_error);
+}
+
+// Listings are built once and rebuilt only after the directory changes
+TEST_F(StaticHandlerTest, AutoindexCachedUntilChanged) {
+    std::unique_ptr<StaticHandler> listing(static_cast<StaticHandler*>(StaticHandler::Init(
+        "/static", {{"root", temp_dir_.string()}, {"autoindex", "on"}})));
+    fs::create_directories(temp_dir_ / "sub");
+
+    Response first = listing->handle_request(Request("GET /static/ HTTP/1.1\r\n\r\n"));
+    EXPECT_EQ(first.get_status_code(), 200);
+    ASSERT_NE(first.get_shared_body(), nullptr);
+    const std::string& html = *first.get_shared_body();
+    EXPECT_NE(html.find("<title>Index of /static/</title>"), std::string::npos);
+    EXPECT_LT(html.find("<a href=\"sub/\">sub/</a>"), html.find("<a href=\"image.jpg\">"));
+    EXPECT_NE(html.find("<a href=\"test.txt\">test.txt</a>"), std::string::npos);
+
+    Response second = listing->handle_request(Request("GET /static/ HTTP/1.1\r\n\r\n"));
+    EXPECT_EQ(second.get_shared_body(), first.get_shared_body());
+    EXPECT_EQ(listing->listings()->GetStats().hits, 1u);
+
+    // A new entry changes the directory's mtime
+    struct timespec pause = {0, 10 * 1000 * 1000};
+    nanosleep(&pause, nullptr);
+    create_test_file("a <b>.txt", "x");
+    Response third = listing->handle_request(Request("GET /static/ HTTP/1.1\r\n\r\n"));
+    EXPECT_NE(third.get_shared_body(), first.get_shared_body());
+    EXPECT_NE(third.get_shared_body()->find("<a href=\"a%20%3Cb%3E.txt\">a &lt;b&gt;.txt</a>"),
+              std::string::npos);
+    EXPECT_EQ(listing->listings()->GetStats().misses, 2u);
+}
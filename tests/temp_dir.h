@@ -0,0 +1,58 @@
+#ifndef TEMP_DIR_H
+#define TEMP_DIR_H
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+// A fresh directory under the system temp directory for the running test,
+// removed with everything in it on destruction. The name starts with the
+// test's name and is made unique by mkdtemp, so tests running in parallel
+// (or a leftover from a crashed run) never share files. Fixtures hold one
+// as a member.
+class TempDir {
+  public:
+    TempDir() {
+      const ::testing::TestInfo* info = ::testing::UnitTest::GetInstance()->current_test_info();
+      std::string name = info ? std::string(info->test_suite_name()) + "." + info->name()
+                              : "test";
+      // Parameterized tests have slashes in their names
+      std::replace(name.begin(), name.end(), '/', '_');
+      std::string templ = (std::filesystem::temp_directory_path() / (name + ".XXXXXX")).string();
+      std::vector<char> buffer(templ.begin(), templ.end());
+      buffer.push_back('\0');
+      if (::mkdtemp(buffer.data()) == nullptr) {
+        ADD_FAILURE() << "mkdtemp failed for " << templ;
+        return;
+      }
+      path_ = buffer.data();
+    }
+
+    ~TempDir() {
+      std::error_code ec;
+      if (!path_.empty()) std::filesystem::remove_all(path_, ec);
+    }
+
+    TempDir(const TempDir&) = delete;
+    TempDir& operator=(const TempDir&) = delete;
+
+    const std::filesystem::path& path() const { return path_; }
+
+    // Creates or replaces the file at name, relative to the directory,
+    // along with any missing parent directories
+    void Write(const std::filesystem::path& name, const std::string& content) const {
+      std::filesystem::path file = path_ / name;
+      std::filesystem::create_directories(file.parent_path());
+      std::ofstream(file.c_str(), std::ios::binary) << content;
+    }
+
+  private:
+    std::filesystem::path path_;
+};
+
+#endif  // TEMP_DIR_H
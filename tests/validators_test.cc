@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include "validators.h"
+
+// Metadata of an imaginary file
+static FileStat testStat() {
+  FileStat st;
+  st.size = 1234;
+  st.mtime_ns = 784111777LL * 1000000000 + 500;  // Sun, 06 Nov 1994 08:49:37 GMT
+  st.inode = 0xabc;
+  st.regular = true;
+  return st;
+}
+
+// ----------------- validators unit tests -----------------
+TEST(ValidatorsTest, ETagIsQuotedAndChangesWithFile) {
+  FileStat st = testStat();
+  std::string etag = validators::ETag(st);
+  EXPECT_EQ(etag.front(), '"');
+  EXPECT_EQ(etag.back(), '"');
+  EXPECT_EQ(etag, validators::ETag(testStat()));
+
+  st.mtime_ns += 1;
+  EXPECT_NE(validators::ETag(st), etag);
+  st = testStat();
+  st.size += 1;
+  EXPECT_NE(validators::ETag(st), etag);
+}
+
+TEST(ValidatorsTest, FormatsHttpDate) {
+  EXPECT_EQ(validators::HttpDate(784111777), "Sun, 06 Nov 1994 08:49:37 GMT");
+  EXPECT_EQ(validators::LastModified(testStat()), 784111777);
+}
+
+TEST(ValidatorsTest, ParsesHttpDate) {
+  std::int64_t seconds = 0;
+  ASSERT_TRUE(validators::ParseHttpDate("Sun, 06 Nov 1994 08:49:37 GMT", seconds));
+  EXPECT_EQ(seconds, 784111777);
+  EXPECT_FALSE(validators::ParseHttpDate("Sunday, 06-Nov-94 08:49:37 GMT", seconds));
+  EXPECT_FALSE(validators::ParseHttpDate("Sun, 06 Foo 1994 08:49:37 GMT", seconds));
+  EXPECT_FALSE(validators::ParseHttpDate("garbage", seconds));
+}
+
+TEST(ValidatorsTest, IfNoneMatch) {
+  std::string etag = validators::ETag(testStat());
+  std::int64_t lm = validators::LastModified(testStat());
+  EXPECT_TRUE(validators::IsNotModified(
+      Request("GET / HTTP/1.1\r\nIf-None-Match: " + etag + "\r\n\r\n"), etag, lm));
+  EXPECT_TRUE(validators::IsNotModified(
+      Request("GET / HTTP/1.1\r\nIf-None-Match: \"x\", W/" + etag + "\r\n\r\n"), etag, lm));
+  EXPECT_TRUE(validators::IsNotModified(
+      Request("HEAD / HTTP/1.1\r\nIf-None-Match: *\r\n\r\n"), etag, lm));
+  EXPECT_FALSE(validators::IsNotModified(
+      Request("GET / HTTP/1.1\r\nIf-None-Match: \"other\"\r\n\r\n"), etag, lm));
+  EXPECT_TRUE(validators::IsNotModified(
+      Request("GET / HTTP/1.1\r\nif-none-match: " + etag + "\r\n\r\n"), etag, lm));
+  // Only safe methods get a 304
+  EXPECT_FALSE(validators::IsNotModified(
+      Request("POST / HTTP/1.1\r\nIf-None-Match: " + etag + "\r\n\r\n"), etag, lm));
+}
+
+TEST(ValidatorsTest, IfModifiedSince) {
+  std::string etag = validators::ETag(testStat());
+  std::int64_t lm = validators::LastModified(testStat());
+  EXPECT_TRUE(validators::IsNotModified(
+      Request("GET / HTTP/1.1\r\nIf-Modified-Since: Sun, 06 Nov 1994 08:49:37 GMT\r\n\r\n"), etag, lm));
+  EXPECT_FALSE(validators::IsNotModified(
+      Request("GET / HTTP/1.1\r\nIf-Modified-Since: Sun, 06 Nov 1994 08:49:36 GMT\r\n\r\n"), etag, lm));
+  // An unparseable date is ignored
+  EXPECT_FALSE(validators::IsNotModified(
+      Request("GET / HTTP/1.1\r\nIf-Modified-Since: yesterday\r\n\r\n"), etag, lm));
+  // If-None-Match takes precedence over If-Modified-Since
+  EXPECT_FALSE(validators::IsNotModified(
+      Request("GET / HTTP/1.1\r\nIf-None-Match: \"other\"\r\n"
+              "If-Modified-Since: Sun, 06 Nov 1994 08:49:37 GMT\r\n\r\n"), etag, lm));
+}
+
+TEST(ValidatorsTest, IfRange) {
+  std::string etag = validators::ETag(testStat());
+  std::int64_t lm = validators::LastModified(testStat());
+  EXPECT_TRUE(validators::IfRangeMatches(Request("GET / HTTP/1.1\r\n\r\n"), etag, lm));
+  EXPECT_TRUE(validators::IfRangeMatches(
+      Request("GET / HTTP/1.1\r\nIf-Range: " + etag + "\r\n\r\n"), etag, lm));
+  EXPECT_TRUE(validators::IfRangeMatches(
+      Request("GET / HTTP/1.1\r\nIf-Range: Sun, 06 Nov 1994 08:49:37 GMT\r\n\r\n"), etag, lm));
+  // Strong comparison and exact dates only
+  EXPECT_FALSE(validators::IfRangeMatches(
+      Request("GET / HTTP/1.1\r\nIf-Range: W/" + etag + "\r\n\r\n"), etag, lm));
+  EXPECT_FALSE(validators::IfRangeMatches(
+      Request("GET / HTTP/1.1\r\nIf-Range: \"other\"\r\n\r\n"), etag, lm));
+  EXPECT_FALSE(validators::IfRangeMatches(
+      Request("GET / HTTP/1.1\r\nIf-Range: Mon, 07 Nov 1994 08:49:37 GMT\r\n\r\n"), etag, lm));
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <pthread.h>
+#include <thread>
+#include "worker_cpus.h"
+#include "temp_dir.h"
+
+namespace fs = std::filesystem;
+
+// ----------  WorkerCpusTest Fixture  ---------------
+class WorkerCpusTest : public ::testing::Test {
+  protected:
+    void SetUp() override { fs::create_directories(root_.path() / "cpu"); }
+
+    TempDir root_;
+};
+
+TEST_F(WorkerCpusTest, CgroupV2Quota) {
+  root_.Write("cpu.max", "150000 100000\n");
+  EXPECT_DOUBLE_EQ(worker_cpus::CgroupQuota(root_.path().string()), 1.5);
+
+  root_.Write("cpu.max", "max 100000\n");
+  EXPECT_EQ(worker_cpus::CgroupQuota(root_.path().string()), 0);
+}
+
+TEST_F(WorkerCpusTest, CgroupV1Quota) {
+  root_.Write("cpu/cpu.cfs_quota_us", "200000\n");
+  root_.Write("cpu/cpu.cfs_period_us", "100000\n");
+  EXPECT_DOUBLE_EQ(worker_cpus::CgroupQuota(root_.path().string()), 2);
+
+  root_.Write("cpu/cpu.cfs_quota_us", "-1\n");
+  EXPECT_EQ(worker_cpus::CgroupQuota(root_.path().string()), 0);
+}
+
+TEST_F(WorkerCpusTest, NoCgroup) {
+  EXPECT_EQ(worker_cpus::CgroupQuota((root_.path() / "missing").string()), 0);
+}
+
+TEST_F(WorkerCpusTest, AvailableIsWithinAllowed) {
+  std::vector<unsigned int> allowed = worker_cpus::Allowed();
+  ASSERT_FALSE(allowed.empty());
+  EXPECT_GE(worker_cpus::Available(), 1u);
+  EXPECT_LE(worker_cpus::Available(), allowed.size());
+}
+
+TEST_F(WorkerCpusTest, FromMask) {
+  EXPECT_EQ(worker_cpus::FromMask("0101"), (std::vector<unsigned int>{0, 2}));
+  EXPECT_EQ(worker_cpus::FromMask("1000"), std::vector<unsigned int>{3});
+  EXPECT_TRUE(worker_cpus::FromMask("0000").empty());
+  EXPECT_TRUE(worker_cpus::FromMask("01x1").empty());
+}
+
+// Pins and names a fresh thread, leaving the test thread as it was
+TEST_F(WorkerCpusTest, PinsAndNamesThread) {
+  unsigned int cpu = worker_cpus::Allowed().front();
+  bool pinned = false;
+  std::vector<unsigned int> after;
+  char name[16] = {};
+  std::thread worker([&] {
+    pinned = worker_cpus::PinCurrentThread({cpu});
+    after = worker_cpus::Allowed();
+    worker_cpus::NameCurrentThread("worker-with-a-long-name");
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+  });
+  worker.join();
+  EXPECT_TRUE(pinned);
+  EXPECT_EQ(after, std::vector<unsigned int>{cpu});
+  EXPECT_EQ(std::string(name), "worker-with-a-l");
+  EXPECT_FALSE(worker_cpus::PinCurrentThread({}));
+}
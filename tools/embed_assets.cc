@@ -0,0 +1,144 @@
+// Compiles a directory into a C++ source file for EmbeddedStaticHandler.
+//
+// Every regular file under dir becomes a read-only array, listed in a table
+// sorted by path together with its Content-Type, an ETag hashed from its
+// bytes, its mtime and the prebuilt status line and headers, so nothing is
+// computed when the server starts. The table is returned by a function
+// named symbol (EmbeddedAssets by default, see include/embedded_assets.h).
+//
+//   ./bin/embed_assets dir output.cc [symbol]
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "file_body.h"
+#include "mime_types.h"
+#include "validators.h"
+
+namespace fs = std::filesystem;
+
+// String literal for text, every byte that isn't plain printable ASCII
+// written as an octal escape
+static std::string literal(const std::string& text) {
+  std::string out = "\"";
+  for (unsigned char c : text) {
+    if (c >= 0x20 && c < 0x7f && c != '"' && c != '\\' && c != '?') {
+      out += static_cast<char>(c);
+    } else {
+      char buf[8];
+      std::snprintf(buf, sizeof(buf), "\\%03o", c);
+      out += buf;
+    }
+  }
+  return out + "\"";
+}
+
+// std::string_view of text with its exact length, so embedded NULs and
+// trailing bytes survive
+static std::string view(const std::string& text) {
+  return "std::string_view(" + literal(text) + ", " + std::to_string(text.size()) + ")";
+}
+
+// Strong ETag from the bytes, so rebuilding unchanged assets (or building
+// them on another machine) keeps client caches valid
+static std::string contentETag(const std::string& body) {
+  // FNV-1a
+  std::uint64_t h = 0xcbf29ce484222325ULL;
+  for (unsigned char c : body) {
+    h ^= c;
+    h *= 0x100000001b3ULL;
+  }
+  char buf[32];
+  std::snprintf(buf, sizeof(buf), "\"%016llx-%zx\"", static_cast<unsigned long long>(h),
+                body.size());
+  return buf;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 3 || argc > 4) {
+    std::cerr << "Usage: embed_assets dir output.cc [symbol]\n";
+    return 1;
+  }
+  std::string symbol = argc == 4 ? argv[3] : "EmbeddedAssets";
+
+  std::vector<fs::path> paths;
+  fs::path base;
+  try {
+    base = fs::canonical(argv[1]);
+    for (const auto& entry : fs::recursive_directory_iterator(base)) {
+      if (entry.is_regular_file()) paths.push_back(entry.path());
+    }
+  } catch (const fs::filesystem_error& e) {
+    std::cerr << "embed_assets: " << e.what() << "\n";
+    return 1;
+  }
+  std::sort(paths.begin(), paths.end());
+
+  std::ostringstream out;
+  out << "// Generated by embed_assets from " << base.string() << ", do not edit\n"
+      << "#include \"embedded_assets.h\"\n\n"
+      << "namespace {\n\n";
+
+  std::ostringstream table;
+  for (std::size_t i = 0; i < paths.size(); ++i) {
+    auto file = FileBody::Open(paths[i].string());
+    if (!file) {
+      std::cerr << "embed_assets: can't read " << paths[i] << "\n";
+      return 1;
+    }
+    std::string body = file->Read(0, file->size());
+    std::string path = "/" + paths[i].lexically_relative(base).generic_string();
+    std::string content_type = mime_types::ContentType(path);
+    std::string etag = contentETag(body);
+    std::int64_t last_modified = validators::LastModified(file->stat());
+    std::string head = "HTTP/1.1 200 OK\r\n"
+                       "Content-Type: " + content_type + "\r\n"
+                       "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                       "ETag: " + etag + "\r\n"
+                       "Last-Modified: " + validators::HttpDate(last_modified) + "\r\n";
+
+    // Arrays of octal char literals rather than string literals, which
+    // compilers limit in length
+    out << "// " << path << "\n"
+        << "const char kBody" << i << "[" << std::max<std::size_t>(body.size(), 1) << "] = {";
+    for (std::size_t b = 0; b < body.size(); ++b) {
+      if (b % 12 == 0) out << "\n ";
+      char buf[12];
+      std::snprintf(buf, sizeof(buf), " '\\%03o',", static_cast<unsigned char>(body[b]));
+      out << buf;
+    }
+    out << (body.empty() ? "0};\n\n" : "\n};\n\n");
+
+    table << "  {" << view(path) << ",\n"
+          << "   " << view(head) << ",\n"
+          << "   std::string_view(kBody" << i << ", " << body.size() << "),\n"
+          << "   " << view(content_type) << ", " << view(etag) << ", "
+          << last_modified << "},\n";
+  }
+
+  if (paths.empty()) {
+    out << "}  // namespace\n\n"
+        << "EmbeddedAssetTable " << symbol << "() { return {nullptr, 0}; }\n";
+  } else {
+    out << "const EmbeddedAsset kAssets[] = {\n" << table.str() << "};\n\n"
+        << "}  // namespace\n\n"
+        << "EmbeddedAssetTable " << symbol << "() { return {kAssets, " << paths.size()
+        << "}; }\n";
+  }
+
+  std::ofstream output(argv[2], std::ios::binary | std::ios::trunc);
+  output << out.str();
+  if (!output.flush()) {
+    std::cerr << "embed_assets: can't write " << argv[2] << "\n";
+    return 1;
+  }
+  std::cout << "Embedded " << paths.size() << " files from " << base.string() << "\n";
+  return 0;
+}